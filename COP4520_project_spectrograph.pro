@@ -8,6 +8,9 @@ TARGET = COP4520_project_spectrograph
 INCLUDEPATH += ./include
 QMAKE_CXXFLAGS += -g
 
+# FixedFFT builds its twiddle tables with C++14 constexpr functions
+CONFIG += c++14
+
 # You can make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # Please consult the documentation of the deprecated API in order to know
@@ -27,7 +30,33 @@ HEADERS += include/AudioFileStream.h \
            include/Constants.h \
            include/FTController.h \
            include/DFTWorkerThread.h \
-           include/DistributedDFTWorkerThread.h
+           include/DistributedDFTWorkerThread.h \
+           include/FFTPlan.h \
+           include/FFTKernels.h \
+           include/FourStepFFT.h \
+           include/ZoomFFT.h \
+           include/ZoomFFTWorkerThread.h \
+           include/FixedFFT.h \
+           include/CancellationToken.h \
+           include/BinDFT.h \
+           include/GoertzelFilterBank.h \
+           include/GoertzelWorkerThread.h \
+           include/STFT.h \
+           include/STFTWorkerThread.h \
+           include/WelchPSD.h \
+           include/WelchWorkerThread.h \
+           include/StreamingWelchWorkerThread.h \
+           include/SampleRingBuffer.h \
+           include/LiveSpectrumWorkerThread.h \
+           include/SlidingDFT.h \
+           include/ConstantQ.h \
+           include/ConstantQWorkerThread.h \
+           include/Decimator.h \
+           include/DecimatorWorkerThread.h \
+           include/WavFile.h \
+           include/SampleStore.h \
+           include/SampleConverter.h \
+           include/ChannelWelchWorkerThread.h
 
 SOURCES += src/main.cpp \
            src/AudioFileStream.cpp \
@@ -40,6 +69,31 @@ SOURCES += src/main.cpp \
            src/Spectrograph.cpp \
            src/FTController.cpp \
            src/DFTWorkerThread.cpp \
-           src/DistributedDFTWorkerThread.cpp
+           src/DistributedDFTWorkerThread.cpp \
+           src/FFTPlan.cpp \
+           src/FFTKernels.cpp \
+           src/FourStepFFT.cpp \
+           src/ZoomFFT.cpp \
+           src/ZoomFFTWorkerThread.cpp \
+           src/CancellationToken.cpp \
+           src/BinDFT.cpp \
+           src/GoertzelFilterBank.cpp \
+           src/GoertzelWorkerThread.cpp \
+           src/STFT.cpp \
+           src/STFTWorkerThread.cpp \
+           src/WelchPSD.cpp \
+           src/WelchWorkerThread.cpp \
+           src/StreamingWelchWorkerThread.cpp \
+           src/SampleRingBuffer.cpp \
+           src/LiveSpectrumWorkerThread.cpp \
+           src/SlidingDFT.cpp \
+           src/ConstantQ.cpp \
+           src/ConstantQWorkerThread.cpp \
+           src/Decimator.cpp \
+           src/DecimatorWorkerThread.cpp \
+           src/WavFile.cpp \
+           src/SampleStore.cpp \
+           src/SampleConverter.cpp \
+           src/ChannelWelchWorkerThread.cpp
 
 RESOURCES = Resource.qrc
@@ -0,0 +1,192 @@
+#include "FFTEngineBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+static const size_t MIN_SIZE = size_t(1) << 12;
+static const size_t MAX_SIZE = size_t(1) << 22;
+
+// Roughly the same amount of work for every length
+static const size_t POINTS_PER_SIZE = size_t(1) << 25;
+
+namespace
+{
+    // One hardware cache counter of the calling thread, -1 when it cannot be read
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter(unsigned int type, unsigned long long config)
+            : m_fd(-1)
+        {
+#ifdef Q_OS_LINUX
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+            Q_UNUSED(type);
+            Q_UNUSED(config);
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#ifdef Q_OS_LINUX
+            if (m_fd >= 0)
+                close(m_fd);
+#endif
+        }
+
+        void start()
+        {
+#ifdef Q_OS_LINUX
+            if (m_fd >= 0)
+            {
+                ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        void stop()
+        {
+#ifdef Q_OS_LINUX
+            if (m_fd >= 0)
+                ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+        }
+
+        long long value() const
+        {
+#ifdef Q_OS_LINUX
+            long long count = 0;
+            if (m_fd >= 0 && read(m_fd, &count, sizeof(count)) == sizeof(count))
+                return count;
+#endif
+            return -1;
+        }
+
+    private:
+        int m_fd;
+    };
+
+#ifdef Q_OS_LINUX
+    const unsigned int CACHE_TYPE = PERF_TYPE_HARDWARE;
+    const unsigned long long CACHE_CONFIG = PERF_COUNT_HW_CACHE_MISSES;
+    const unsigned int L1_TYPE = PERF_TYPE_HW_CACHE;
+    const unsigned long long L1_CONFIG = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#else
+    const unsigned int CACHE_TYPE = 0;
+    const unsigned long long CACHE_CONFIG = 0;
+    const unsigned int L1_TYPE = 0;
+    const unsigned long long L1_CONFIG = 0;
+#endif
+
+    void printMisses(long long misses)
+    {
+        if (misses < 0)
+            std::cout << std::setw(14) << "n/a";
+        else
+            std::cout << std::setw(14) << misses;
+    }
+}
+
+FFTEngineBenchmark::Measurement FFTEngineBenchmark::measure(FFTPlan::Radix2Engine engine,
+                                                            const std::vector<double>& real,
+                                                            const std::vector<double>& imag, int trials)
+{
+    FFTPlan::setRadix2Engine(engine);
+    std::shared_ptr<const FFTPlan> plan = FFTPlan::forSize(real.size());
+
+    std::vector<double> workReal = real;
+    std::vector<double> workImag = imag;
+
+    // Warm up: first touch of the scratch buffers and the twiddle tables
+    plan->transform(workReal, workImag);
+
+    CacheMissCounter cacheMisses(CACHE_TYPE, CACHE_CONFIG);
+    CacheMissCounter l1Misses(L1_TYPE, L1_CONFIG);
+
+    Measurement total = { 0.0, 0, 0 };
+    for (int i = 0; i < trials; ++i)
+    {
+        workReal = real;
+        workImag = imag;
+
+        cacheMisses.start();
+        l1Misses.start();
+        auto timeStart = std::chrono::high_resolution_clock::now();
+
+        plan->transform(workReal, workImag);
+
+        auto timeEnd = std::chrono::high_resolution_clock::now();
+        l1Misses.stop();
+        cacheMisses.stop();
+
+        total.seconds += std::chrono::duration<double>(timeEnd - timeStart).count();
+        total.cacheMisses = cacheMisses.value() < 0 ? -1 : total.cacheMisses + cacheMisses.value();
+        total.l1Misses = l1Misses.value() < 0 ? -1 : total.l1Misses + l1Misses.value();
+    }
+
+    total.seconds /= trials;
+    if (total.cacheMisses >= 0)
+        total.cacheMisses /= trials;
+    if (total.l1Misses >= 0)
+        total.l1Misses /= trials;
+
+    return total;
+}
+
+void FFTEngineBenchmark::run()
+{
+    const FFTPlan::Radix2Engine previousEngine = FFTPlan::radix2Engine();
+
+    std::cout << "Comparing radix-2 FFT engines, averages per transform" << std::endl;
+    std::cout << std::setw(10) << "Size" << std::setw(12) << "Engine" << std::setw(14) << "Time (ms)"
+              << std::setw(14) << "LLC misses" << std::setw(14) << "L1D misses" << std::endl;
+
+    for (size_t n = MIN_SIZE; n <= MAX_SIZE; n *= 2)
+    {
+        std::vector<double> real(n);
+        std::vector<double> imag(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            real[i] = std::sin(2 * 3.141592653589793 * 440.0 * i / 44100.0);
+            imag[i] = 0.0;
+        }
+
+        const int trials = static_cast<int>(std::max<size_t>(POINTS_PER_SIZE / n, 3));
+        for (FFTPlan::Radix2Engine engine : { FFTPlan::Radix2Engine::InPlace, FFTPlan::Radix2Engine::Stockham })
+        {
+            Measurement result = measure(engine, real, imag, trials);
+
+            std::cout << std::setw(10) << n << std::setw(12) << FFTPlan::radix2EngineName(engine)
+                      << std::setw(14) << std::fixed << std::setprecision(3) << result.seconds * 1e3;
+            printMisses(result.cacheMisses);
+            printMisses(result.l1Misses);
+            std::cout << std::endl;
+        }
+    }
+
+    FFTPlan::setRadix2Engine(previousEngine);
+    FFTPlan::clearCache();
+}
@@ -0,0 +1,38 @@
+#ifndef FFTENGINEBENCHMARK_H
+#define FFTENGINEBENCHMARK_H
+
+#include "FFTPlan.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   Compares the radix-2 engines of FFTPlan (in-place with a bit-reversal pass against
+*   Stockham autosort) on power of 2 lengths from 4K to 4M points (Stockham uses the
+*   compile-time FixedFFT transforms up to FFTPlan::MAX_FIXED_SIZE). Reports the average time
+*   per transform and, on Linux, the last-level cache and L1 data cache misses per transform
+*   read from the hardware counters through perf_event_open. The counters are reported as
+*   unavailable elsewhere, or when the kernel does not allow access (see perf_event_paranoid).
+*/
+class FFTEngineBenchmark
+{
+public:
+    void run();
+
+private:
+    struct Measurement
+    {
+        double seconds;
+        long long cacheMisses;
+        long long l1Misses;
+    };
+
+    /*
+    * Runs `trials` transforms of the given input with the selected engine and returns the
+    * averages per transform. The copy of the input into the work buffers is not measured.
+    */
+    Measurement measure(FFTPlan::Radix2Engine engine, const std::vector<double>& real,
+                        const std::vector<double>& imag, int trials);
+};
+
+#endif // FFTENGINEBENCHMARK_H
@@ -0,0 +1,322 @@
+#define _USE_MATH_DEFINES
+
+#include "FFTReferenceCheck.h"
+#include "FFTPlan.h"
+#include "FourStepFFT.h"
+#include "GoertzelFilterBank.h"
+#include "ZoomFFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+static const double SAMPLE_RATE = 44100.0;
+
+static const double FFT_TOLERANCE = 1e-13;
+static const double FFT_TOLERANCE_FLOAT = 1e-5;
+static const double FOUR_STEP_TOLERANCE = 1e-13;
+static const double BAND_TOLERANCE = 1e-10;
+
+// Samples of the real signals: FourStepFFT packs even lengths and transforms odd ones as they are
+static const size_t FOUR_STEP_SIZES[] = { 6000, 4097 };
+static const int FOUR_STEP_WORKERS[] = { 1, 2, 3, 4, 7 };
+
+// Longer than GoertzelFilterBank::BLOCK_SIZE and than several ZoomFFT blocks
+static const size_t BAND_SAMPLES = 20011;
+
+namespace
+{
+    std::mt19937 generator(4520);
+
+    typedef std::complex<double> Complex;
+
+    std::vector<double> randomValues(size_t count)
+    {
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        std::vector<double> values(count);
+        for (double& value : values)
+        {
+            value = distribution(generator);
+        }
+
+        return values;
+    }
+
+    // Two tones, one of them between bins, and noise, at about half of full scale
+    std::vector<short> randomSamples(size_t count)
+    {
+        std::uniform_real_distribution<double> distribution(-2000.0, 2000.0);
+        std::vector<short> samples(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const double t = i / SAMPLE_RATE;
+            samples[i] = static_cast<short>(std::lround(8000.0 * std::sin(2 * M_PI * 440.0 * t)
+                                                        + 4000.0 * std::sin(2 * M_PI * 1234.5 * t)
+                                                        + distribution(generator)));
+        }
+
+        return samples;
+    }
+
+    // X[k] = sum x[j] * exp(-2*pi*i*k*j/n) for k < numBins, the angles taken from a table of n
+    std::vector<Complex> naiveDFT(const std::vector<double>& real, const std::vector<double>& imag, size_t numBins)
+    {
+        const size_t n = real.size();
+        std::vector<long double> tableCos(n);
+        std::vector<long double> tableSin(n);
+        for (size_t m = 0; m < n; m++)
+        {
+            const long double angle = 2 * 3.14159265358979323846264338327950288L * m / n;
+            tableCos[m] = std::cos(angle);
+            tableSin[m] = std::sin(angle);
+        }
+
+        std::vector<Complex> spectrum(numBins);
+        for (size_t k = 0; k < numBins; k++)
+        {
+            long double sumReal = 0.0L;
+            long double sumImag = 0.0L;
+            size_t m = 0;
+            for (size_t j = 0; j < n; j++)
+            {
+                sumReal += real[j] * tableCos[m] + imag[j] * tableSin[m];
+                sumImag += imag[j] * tableCos[m] - real[j] * tableSin[m];
+
+                // m = (k * j) mod n without overflowing
+                m += k;
+                if (m >= n)
+                    m -= n;
+            }
+            spectrum[k] = Complex(static_cast<double>(sumReal), static_cast<double>(sumImag));
+        }
+
+        return spectrum;
+    }
+
+    // DFT of the samples at any frequency, the phase f*j/fs reduced to one cycle before the sine
+    std::vector<Complex> naiveDFT(const std::vector<short>& samples, const std::vector<double>& frequencies)
+    {
+        std::vector<Complex> spectrum;
+        for (double frequency : frequencies)
+        {
+            long double sumReal = 0.0L;
+            long double sumImag = 0.0L;
+            for (size_t j = 0; j < samples.size(); j++)
+            {
+                long double cycles = static_cast<long double>(frequency) * j / SAMPLE_RATE;
+                cycles -= std::floor(cycles);
+                const long double angle = 2 * 3.14159265358979323846264338327950288L * cycles;
+                sumReal += samples[j] * std::cos(angle);
+                sumImag -= samples[j] * std::sin(angle);
+            }
+            spectrum.push_back(Complex(static_cast<double>(sumReal), static_cast<double>(sumImag)));
+        }
+
+        return spectrum;
+    }
+
+    template <typename T>
+    std::vector<Complex> toComplex(const std::vector<T>& real, const std::vector<T>& imag, size_t count)
+    {
+        std::vector<Complex> values(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values[i] = Complex(real[i], imag[i]);
+        }
+
+        return values;
+    }
+}
+
+void FFTReferenceCheck::report(const char* name, const char* detail, size_t size, double tolerance,
+                               const std::vector<Complex>& expected, const std::vector<Complex>& actual)
+{
+    double maxValue = 0.0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < expected.size() && i < actual.size(); i++)
+    {
+        maxValue = std::max(maxValue, std::abs(expected[i]));
+        maxError = std::max(maxError, std::abs(actual[i] - expected[i]));
+    }
+
+    const double error = maxValue > 0.0 ? maxError / maxValue : maxError;
+    const bool passed = actual.size() == expected.size() && error <= tolerance;
+    m_passed = m_passed && passed;
+
+    std::cout << std::setw(22) << name << std::setw(14) << detail << std::setw(8) << size
+              << std::scientific << std::setprecision(2)
+              << std::setw(12) << error << std::setw(12) << tolerance
+              << std::setw(8) << (passed ? "ok" : "FAILED") << std::endl;
+}
+
+void FFTReferenceCheck::checkPlans()
+{
+    using Engine = FFTPlan::Radix2Engine;
+
+    const struct { const char* name; std::vector<size_t> sizes; } groups[] = {
+        // Below, inside and above the FixedFFT range of the Stockham engine
+        { "Radix-2", { 1, 2, 4, 8, 64, 256, 1024, 8192, 16384 } },
+        { "Mixed-radix", { 3, 15, 35, 105, 210, 315, 1575, 6720 } },
+        { "Bluestein", { 11, 17, 97, 257, 1009, 4099 } },
+    };
+
+    const Engine initialEngine = FFTPlan::radix2Engine();
+    for (const auto& group : groups)
+    {
+        for (size_t n : group.sizes)
+        {
+            const std::vector<double> real = randomValues(n);
+            const std::vector<double> imag = randomValues(n);
+            const std::vector<Complex> expected = naiveDFT(real, imag, n);
+            const std::shared_ptr<const FFTPlan> plan = FFTPlan::forSize(n);
+
+            // Only the radix-2 plans depend on the engine
+            const bool radix2 = plan->algorithm() == FFTPlan::Algorithm::Radix2;
+            for (Engine engine : { Engine::Stockham, Engine::InPlace })
+            {
+                if (engine == Engine::InPlace && !radix2)
+                    continue;
+                FFTPlan::setRadix2Engine(engine);
+
+                std::vector<double> re = real, im = imag;
+                plan->transform(re, im);
+                report(group.name, radix2 ? FFTPlan::radix2EngineName(engine) : "double", n, FFT_TOLERANCE,
+                       expected, toComplex(re, im, n));
+            }
+            FFTPlan::setRadix2Engine(initialEngine);
+
+            std::vector<float> reFloat(real.begin(), real.end()), imFloat(imag.begin(), imag.end());
+            plan->transform(reFloat, imFloat);
+            report(group.name, "float", n, FFT_TOLERANCE_FLOAT, expected, toComplex(reFloat, imFloat, n));
+
+            // Real input: the first n/2 + 1 bins of the transform of the real part alone
+            const size_t numBins = n / 2 + 1;
+            std::vector<double> samples = real, samplesImag;
+            plan->transformReal(samples, samplesImag);
+            report(group.name, "real", n, FFT_TOLERANCE, naiveDFT(real, std::vector<double>(n, 0.0), numBins),
+                   toComplex(samples, samplesImag, std::min(numBins, samplesImag.size())));
+        }
+    }
+}
+
+void FFTReferenceCheck::checkFourStepFFT()
+{
+    for (size_t n : FOUR_STEP_SIZES)
+    {
+        const std::vector<short> samples = randomSamples(n);
+        const std::vector<double> real(samples.begin(), samples.end());
+        const std::vector<Complex> dft = naiveDFT(real, std::vector<double>(n, 0.0), n / 2 + 1);
+
+        // FourStepFFT only returns the magnitudes
+        std::vector<Complex> expected(dft.size());
+        for (size_t k = 0; k < dft.size(); k++)
+        {
+            expected[k] = std::abs(dft[k]);
+        }
+
+        for (int numWorkers : FOUR_STEP_WORKERS)
+        {
+            FourStepFFT fourStepFFT(numWorkers);
+            fourStepFFT.reset();
+
+            // Every worker owns a range of bins, put back together in order
+            std::vector<Complex> actual(expected.size());
+            std::vector<std::thread> workers;
+            for (int workerID = 0; workerID < numWorkers; workerID++)
+            {
+                workers.emplace_back([&, workerID]() {
+                    size_t firstBin = 0;
+                    std::vector<double> magnitudes;
+                    double maxMagnitude = 0.0;
+                    if (!fourStepFFT.run(workerID, samples.data(), n, firstBin, magnitudes, maxMagnitude))
+                        return;
+
+                    for (size_t i = 0; i < magnitudes.size() && firstBin + i < actual.size(); i++)
+                    {
+                        actual[firstBin + i] = magnitudes[i];
+                    }
+                });
+            }
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+
+            const std::string detail = std::to_string(numWorkers) + (numWorkers == 1 ? " worker" : " workers");
+            report("FourStepFFT", detail.c_str(), n, FOUR_STEP_TOLERANCE, expected, actual);
+        }
+    }
+}
+
+void FFTReferenceCheck::checkZoomFFT()
+{
+    const std::vector<short> samples = randomSamples(BAND_SAMPLES);
+
+    // A resolution far finer than the FFT grid, and one band reaching the Nyquist frequency
+    const struct { double start; double resolution; size_t numBins; } bands[] = {
+        { 100.0, 0.37, 200 },
+        { 430.0, 0.05, 400 },
+        { 21000.0, 10.0, 105 },
+    };
+
+    for (const auto& band : bands)
+    {
+        const ZoomFFT zoomFFT(SAMPLE_RATE, band.start, band.resolution, band.numBins);
+
+        std::vector<double> frequencies(band.numBins);
+        for (size_t k = 0; k < band.numBins; k++)
+        {
+            frequencies[k] = zoomFFT.frequency(k);
+        }
+
+        std::vector<double> real(band.numBins, 0.0), imag(band.numBins, 0.0);
+        zoomFFT.accumulate(samples.data(), samples.size(), 0, zoomFFT.numBlocks(samples.size()), real, imag);
+
+        const std::string detail = std::to_string(band.numBins) + " bins";
+        report("ZoomFFT", detail.c_str(), samples.size(), BAND_TOLERANCE, naiveDFT(samples, frequencies),
+               toComplex(real, imag, band.numBins));
+    }
+}
+
+void FFTReferenceCheck::checkGoertzel()
+{
+    const std::vector<short> samples = randomSamples(BAND_SAMPLES);
+
+    // The tones of the signal, frequencies between bins, and both ends of the spectrum
+    const std::vector<double> frequencies = { 0.0, 3.7, 440.0, 441.7, 1234.5, 997.3, 12345.6, 22050.0 };
+    const GoertzelFilterBank goertzel(SAMPLE_RATE, frequencies);
+    const std::vector<Complex> expected = naiveDFT(samples, frequencies);
+
+    std::vector<double> real(frequencies.size(), 0.0), imag(frequencies.size(), 0.0);
+    goertzel.accumulate(samples.data(), 0, samples.size(), real, imag);
+    report("GoertzelFilterBank", "whole", samples.size(), BAND_TOLERANCE, expected, toComplex(real, imag, frequencies.size()));
+
+    // Two ranges not aligned on the blocks, as split between workers
+    const size_t split = 7001;
+    std::fill(real.begin(), real.end(), 0.0);
+    std::fill(imag.begin(), imag.end(), 0.0);
+    goertzel.accumulate(samples.data(), 0, split, real, imag);
+    goertzel.accumulate(samples.data(), split, samples.size(), real, imag);
+    report("GoertzelFilterBank", "split", samples.size(), BAND_TOLERANCE, expected, toComplex(real, imag, frequencies.size()));
+}
+
+bool FFTReferenceCheck::run()
+{
+    m_passed = true;
+
+    std::cout << "Transforms against a naive DFT in long double" << std::endl;
+    std::cout << std::setw(22) << "Transform" << std::setw(14) << "" << std::setw(8) << "Size"
+              << std::setw(12) << "Max error" << std::setw(12) << "Tolerance" << std::setw(8) << "Result" << std::endl;
+
+    checkPlans();
+    checkFourStepFFT();
+    checkZoomFFT();
+    checkGoertzel();
+
+    std::cout << (m_passed ? "All transforms within tolerance" : "Some transforms are OUT OF TOLERANCE") << std::endl;
+    return m_passed;
+}
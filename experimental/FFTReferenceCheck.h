@@ -0,0 +1,47 @@
+#ifndef FFTREFERENCECHECK_H
+#define FFTREFERENCECHECK_H
+
+#include <complex>
+#include <vector>
+
+/**
+*   Checks the transforms against a naive DFT: every output is compared with the sum
+*   x[j] * exp(-2*pi*i*f*j/fs) computed in long double, with the angles reduced exactly
+*   ((k * j) mod n for the bins of the FFT grid), and the largest difference relative to the
+*   largest reference output is compared with the tolerance of the transform.
+*
+*   Covered: FFTPlan::transform() on powers of 2 with both radix-2 engines, on products of
+*   3, 5 and 7 (mixed-radix) and on primes (Bluestein), in double and single precision, and
+*   FFTPlan::transformReal() on the same sizes; FourStepFFT with several worker counts;
+*   ZoomFFT and GoertzelFilterBank at frequencies off the FFT grid.
+*
+*   Tolerances, relative to the largest output:
+*   - The FFTs add about one rounding per stage, log2(n) of them: 1e-13 in double and 1e-5 in
+*     single precision. Bluestein runs two FFTs of twice the size on top of its chirps, which
+*     stays within the same bounds for the sizes checked.
+*   - FourStepFFT is FFTPlan's transforms plus a twiddle recurrence resynchronized every 64
+*     columns: 1e-13 as well.
+*   - ZoomFFT rotates each block by the phase of its position and GoertzelFilterBank runs a
+*     recurrence over blocks of BLOCK_SIZE samples, both lose a few digits near 0 and the
+*     Nyquist frequency: 1e-10.
+*/
+class FFTReferenceCheck
+{
+public:
+    // Prints one line per transform and size, returns false if any is out of tolerance.
+    bool run();
+
+private:
+    bool m_passed;
+
+    // Prints the largest difference of actual from expected, relative to the largest expected value.
+    void report(const char* name, const char* detail, size_t size, double tolerance,
+                const std::vector<std::complex<double>>& expected, const std::vector<std::complex<double>>& actual);
+
+    void checkPlans();
+    void checkFourStepFFT();
+    void checkZoomFFT();
+    void checkGoertzel();
+};
+
+#endif // FFTREFERENCECHECK_H
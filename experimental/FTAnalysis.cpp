@@ -5,17 +5,21 @@ static const QString SAMPLE_FILE_3s = ":/audio/440Hz-3s.wav";
 static const QString SAMPLE_FILE_30s = ":/audio/440Hz-30s.wav";
 static const int NUM_TRIALS = 50;
 
+// The tone of the sample files and its first harmonics
+static const QVector<double> GOERTZEL_FREQUENCIES = { 440.0, 880.0, 1320.0 };
+
 FTAnalysis::FTAnalysis(QObject *parent)
     : QObject(parent),
       m_avgTime(0.0)
 {
     connect(&m_ftController, &FTController::spectrumDataReady, this, &FTAnalysis::receiveFTResults);
+    connect(&m_ftController, &FTController::spectrogramReady, this, &FTAnalysis::receiveSpectrogram);
     connect(&m_decoder, &QAudioDecoder::bufferReady, this, &FTAnalysis::writeAudioDataToBuffer);
 }
 
 void FTAnalysis::startPerformanceAnalysis()
 {
-    std::cout << "Conducting performance analysis on parallel/sequential FFT for " << NUM_TRIALS << " trials each." << std::endl;
+    std::cout << "Conducting performance analysis on parallel/sequential FFT, zoom FFT, Goertzel, STFT, Welch PSD and constant-Q for " << NUM_TRIALS << " trials each." << std::endl;
 
     std::cout << "Starting Single-Threaded FFT on 440Hz-1s.wav" << std::endl;
     startTrials(SAMPLE_FILE_1s, SLOT(calcFFT()));
@@ -41,6 +45,66 @@ void FTAnalysis::startPerformanceAnalysis()
     startTrials(SAMPLE_FILE_30s, SLOT(calcDistributedFFT()));
     std::cout << std::endl;
 
+    std::cout << "Starting Multi-Threaded Zoom FFT on 440Hz-1s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_1s, SLOT(calcZoomFFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Zoom FFT on 440Hz-3s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_3s, SLOT(calcZoomFFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Zoom FFT on 440Hz-30s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_30s, SLOT(calcZoomFFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Goertzel on 440Hz-1s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_1s, SLOT(calcGoertzel()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Goertzel on 440Hz-3s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_3s, SLOT(calcGoertzel()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Goertzel on 440Hz-30s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_30s, SLOT(calcGoertzel()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded STFT on 440Hz-1s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_1s, SLOT(calcSTFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded STFT on 440Hz-3s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_3s, SLOT(calcSTFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded STFT on 440Hz-30s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_30s, SLOT(calcSTFT()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Welch PSD on 440Hz-1s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_1s, SLOT(calcWelch()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Welch PSD on 440Hz-3s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_3s, SLOT(calcWelch()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Welch PSD on 440Hz-30s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_30s, SLOT(calcWelch()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Constant-Q on 440Hz-1s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_1s, SLOT(calcConstantQ()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Constant-Q on 440Hz-3s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_3s, SLOT(calcConstantQ()));
+    std::cout << std::endl;
+
+    std::cout << "Starting Multi-Threaded Constant-Q on 440Hz-30s.wav" << std::endl;
+    startTrials(SAMPLE_FILE_30s, SLOT(calcConstantQ()));
+    std::cout << std::endl;
+
     emit finished();
 }
 
@@ -69,6 +133,13 @@ void FTAnalysis::receiveFTResults(const QVector<QPointF> points, const double el
     //std::cout << "Elapsed time: " << elapsedSeconds << "s" << std::endl;
 }
 
+void FTAnalysis::receiveSpectrogram(const std::shared_ptr<const Spectrogram> spectrogram, const double elapsedSeconds)
+{
+    Q_UNUSED(spectrogram);
+
+    m_avgTime += elapsedSeconds;
+}
+
 void FTAnalysis::writeAudioDataToBuffer()
 {
     const QAudioBuffer& buffer = m_decoder.read();
@@ -96,6 +167,46 @@ void FTAnalysis::calcDistributedFFT()
     spy.wait();
 }
 
+void FTAnalysis::calcZoomFFT()
+{
+    m_ftController.startZoomFFT(m_format);
+
+    QSignalSpy spy(&m_ftController, &FTController::spectrumDataReady);
+    spy.wait();
+}
+
+void FTAnalysis::calcGoertzel()
+{
+    m_ftController.startGoertzel(m_format, GOERTZEL_FREQUENCIES);
+
+    QSignalSpy spy(&m_ftController, &FTController::spectrumDataReady);
+    spy.wait();
+}
+
+void FTAnalysis::calcSTFT()
+{
+    m_ftController.startSTFT(m_format);
+
+    QSignalSpy spy(&m_ftController, &FTController::spectrogramReady);
+    spy.wait();
+}
+
+void FTAnalysis::calcWelch()
+{
+    m_ftController.startWelch(m_format);
+
+    QSignalSpy spy(&m_ftController, &FTController::spectrumDataReady);
+    spy.wait();
+}
+
+void FTAnalysis::calcConstantQ()
+{
+    m_ftController.startConstantQ(m_format);
+
+    QSignalSpy spy(&m_ftController, &FTController::spectrumDataReady);
+    spy.wait();
+}
+
 void FTAnalysis::startDecoder(const QString& filePath)
 {
     m_ftController.clear();
@@ -37,9 +37,15 @@ private:
 
 private slots:
     void receiveFTResults(const QVector<QPointF> points, const double elapsedSeconds);
+    void receiveSpectrogram(const std::shared_ptr<const Spectrogram> spectrogram, const double elapsedSeconds);
     void writeAudioDataToBuffer();
     void calcFFT();
     void calcDistributedFFT();
+    void calcZoomFFT();
+    void calcGoertzel();
+    void calcSTFT();
+    void calcWelch();
+    void calcConstantQ();
 };
 
 #endif // FTANALYSIS_H
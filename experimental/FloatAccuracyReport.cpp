@@ -0,0 +1,176 @@
+#define _USE_MATH_DEFINES
+
+#include "FloatAccuracyReport.h"
+#include "Constants.h"
+#include "FFTKernels.h"
+#include "FFTPlan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+static const double SAMPLE_RATE = 44100.0;
+
+// Bins quieter than this relative to the peak are left out of the dB comparison
+static const double DB_FLOOR = -80.0;
+
+// Number of loudest bins of the band that must match between both engines
+static const size_t NUM_PEAKS = 5;
+
+namespace
+{
+    struct Tone
+    {
+        double frequency;
+        double level;
+    };
+
+    // Levels in dB relative to full scale, including tones between two bins
+    const Tone TONES[] = {
+        { 110.0, -6.0 },
+        { 261.63, -12.0 },
+        { 440.0, -20.0 },
+        { 445.5, -40.0 },
+        { 733.3, -60.0 },
+        { 997.0, -80.0 },
+    };
+
+    struct Length
+    {
+        size_t n;
+        const char* description;
+    };
+
+    // 2^20 (radix-2), 30 s (mixed-radix, 2^3 3^3 5^3 7^2) and a prime just above 10 s (Bluestein)
+    const Length LENGTHS[] = {
+        { size_t(1) << 20, "Radix-2" },
+        { 1323000, "Mixed-radix" },
+        { 441011, "Bluestein" },
+    };
+
+    // Indices of the `count` largest values of magnitudes[first, last), in decreasing order
+    std::vector<size_t> peaks(const std::vector<double>& magnitudes, size_t first, size_t last, size_t count)
+    {
+        std::vector<size_t> indices;
+        for (size_t k = first; k < last; k++)
+        {
+            // Local maxima only, so the skirt of a loud tone does not count as several peaks
+            if (magnitudes[k] >= magnitudes[k - 1] && magnitudes[k] >= magnitudes[k + 1])
+                indices.push_back(k);
+        }
+
+        count = std::min(count, indices.size());
+        std::partial_sort(indices.begin(), indices.begin() + count, indices.end(),
+                          [&magnitudes](size_t a, size_t b) { return magnitudes[a] > magnitudes[b]; });
+        indices.resize(count);
+        return indices;
+    }
+}
+
+std::vector<short> FloatAccuracyReport::testSignal(size_t n)
+{
+    std::mt19937 generator(4520);
+    std::uniform_real_distribution<double> dither(-0.5, 0.5);
+
+    std::vector<short> samples(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double value = 0.0;
+        for (const Tone& tone : TONES)
+        {
+            const double amplitude = 32767.0 * std::pow(10.0, tone.level / 20.0);
+            value += amplitude * std::sin(2 * M_PI * tone.frequency * i / SAMPLE_RATE);
+        }
+
+        value = std::round(0.5 * value + dither(generator) + dither(generator));
+        samples[i] = static_cast<short>(std::max(-32768.0, std::min(32767.0, value)));
+    }
+
+    return samples;
+}
+
+template <typename T>
+FloatAccuracyReport::Spectrum FloatAccuracyReport::transform(const std::vector<short>& samples)
+{
+    std::shared_ptr<const FFTPlan> plan = FFTPlan::forSize(samples.size());
+
+    // Warm up the plan and the scratch buffers, then time a second run
+    std::vector<T> real(samples.begin(), samples.end());
+    std::vector<T> imag;
+    plan->transformReal(real, imag);
+
+    real.assign(samples.begin(), samples.end());
+    auto timeStart = std::chrono::high_resolution_clock::now();
+
+    plan->transformReal(real, imag);
+    const T maxMagnitude = FFTKernels::magnitude(real.data(), imag.data(), real.data(), real.size());
+
+    auto timeEnd = std::chrono::high_resolution_clock::now();
+
+    // Normalized like the worker threads do before plotting
+    Spectrum spectrum;
+    spectrum.seconds = std::chrono::duration<double>(timeEnd - timeStart).count();
+    spectrum.magnitudes.resize(real.size());
+    for (size_t k = 0; k < real.size(); k++)
+    {
+        spectrum.magnitudes[k] = maxMagnitude > 0 ? static_cast<double>(real[k]) / maxMagnitude : 0.0;
+    }
+
+    return spectrum;
+}
+
+void FloatAccuracyReport::run()
+{
+    std::cout << "Single precision FFT accuracy over " << Constants::MIN_FREQUENCY << "-"
+              << Constants::MAX_FREQUENCY << " Hz against the double precision reference ("
+              << FFTKernels::instructionSetName(FFTKernels::instructionSet()) << " kernels)" << std::endl;
+    std::cout << std::setw(12) << "Algorithm" << std::setw(10) << "Size" << std::setw(8) << "Bins"
+              << std::setw(12) << "Max error" << std::setw(12) << "RMS error" << std::setw(14) << "Max dB error"
+              << std::setw(8) << "Peaks" << std::setw(14) << "Double (ms)" << std::setw(14) << "Float (ms)" << std::endl;
+
+    for (const Length& length : LENGTHS)
+    {
+        const size_t n = length.n;
+        const std::vector<short> samples = testSignal(n);
+
+        const Spectrum reference = transform<double>(samples);
+        const Spectrum single = transform<float>(samples);
+
+        // Bins inside the displayed band
+        const size_t first = static_cast<size_t>(std::ceil(Constants::MIN_FREQUENCY * n / SAMPLE_RATE));
+        const size_t last = static_cast<size_t>(std::floor(Constants::MAX_FREQUENCY * n / SAMPLE_RATE)) + 1;
+
+        double maxError = 0.0;
+        double sumSquares = 0.0;
+        double maxErrorDB = 0.0;
+        for (size_t k = first; k < last; k++)
+        {
+            const double error = std::fabs(single.magnitudes[k] - reference.magnitudes[k]);
+            maxError = std::max(maxError, error);
+            sumSquares += error * error;
+
+            const double levelDB = 20 * std::log10(reference.magnitudes[k]);
+            if (levelDB >= DB_FLOOR && single.magnitudes[k] > 0.0)
+            {
+                const double errorDB = std::fabs(20 * std::log10(single.magnitudes[k]) - levelDB);
+                maxErrorDB = std::max(maxErrorDB, errorDB);
+            }
+        }
+        const double rmsError = std::sqrt(sumSquares / (last - first));
+
+        const bool samePeaks = peaks(reference.magnitudes, first, last, NUM_PEAKS)
+                            == peaks(single.magnitudes, first, last, NUM_PEAKS);
+
+        std::cout << std::setw(12) << length.description << std::setw(10) << n << std::setw(8) << last - first
+                  << std::scientific << std::setprecision(2)
+                  << std::setw(12) << maxError << std::setw(12) << rmsError << std::setw(14) << maxErrorDB
+                  << std::setw(8) << (samePeaks ? "same" : "DIFFER")
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << reference.seconds * 1e3 << std::setw(14) << single.seconds * 1e3 << std::endl;
+    }
+
+    FFTPlan::clearCache();
+}
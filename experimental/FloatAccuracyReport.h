@@ -0,0 +1,38 @@
+#ifndef FLOATACCURACYREPORT_H
+#define FLOATACCURACYREPORT_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   Compares the single precision FFT engine (FFTPlan::Precision::Single) against the double
+*   precision reference on the band shown by the spectrograph, MIN_FREQUENCY to MAX_FREQUENCY.
+*   A 44.1 kHz test signal (tones from 0 dB down to -80 dB plus dither noise, quantized to
+*   16 bits like the decoded audio) is transformed at one length per algorithm: a power of 2,
+*   a mixed-radix length and a prime length going through Bluestein's algorithm.
+*
+*   For every length the report prints the error of the normalized magnitudes plotted by the
+*   spectrograph (largest and RMS, absolute), the largest error in dB over the bins within
+*   80 dB of the peak, whether both engines find the same peaks, and the time of each transform.
+*/
+class FloatAccuracyReport
+{
+public:
+    void run();
+
+private:
+    struct Spectrum
+    {
+        std::vector<double> magnitudes;
+        double seconds;
+    };
+
+    // Computes the normalized magnitudes of the real FFT of the samples with the given precision.
+    template <typename T>
+    static Spectrum transform(const std::vector<short>& samples);
+
+    // Quantized test signal of n samples at SAMPLE_RATE.
+    static std::vector<short> testSignal(size_t n);
+};
+
+#endif // FLOATACCURACYREPORT_H
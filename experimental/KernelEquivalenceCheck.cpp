@@ -0,0 +1,300 @@
+#define _USE_MATH_DEFINES
+
+#include "KernelEquivalenceCheck.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Odd counts, so the vector kernels also go through their scalar tails
+static const size_t FFT_SIZE = 4096;
+static const size_t NUM_VALUES = 4099;
+static const size_t NUM_SAMPLES = 4096;
+static const size_t NUM_BINS = 45;
+static const size_t NUM_TAPS = 63;
+static const size_t DECIMATION_FACTOR = 4;
+static const size_t NUM_OUTPUTS = 1021;
+
+static const double STAGE_TOLERANCE = 4 * DBL_EPSILON;
+static const double STAGE_TOLERANCE_FLOAT = 4 * FLT_EPSILON;
+static const double PHASOR_TOLERANCE = 1e-12;
+static const double FIR_TOLERANCE = 1e-13;
+
+namespace
+{
+    std::mt19937 generator(4520);
+
+    template <typename T>
+    std::vector<T> randomValues(size_t count, double range)
+    {
+        std::uniform_real_distribution<double> distribution(-range, range);
+        std::vector<T> values(count);
+        for (T& value : values)
+        {
+            value = static_cast<T>(distribution(generator));
+        }
+
+        return values;
+    }
+
+    std::vector<unsigned char> randomBytes(size_t count)
+    {
+        std::uniform_int_distribution<int> distribution(0, 255);
+        std::vector<unsigned char> bytes(count);
+        for (unsigned char& byte : bytes)
+        {
+            byte = static_cast<unsigned char>(distribution(generator));
+        }
+
+        return bytes;
+    }
+
+    // Twiddles e^(-2 pi i k / n), for k < count
+    void twiddles(size_t n, size_t count, std::vector<double>& twiddleCos, std::vector<double>& twiddleSin)
+    {
+        twiddleCos.resize(count);
+        twiddleSin.resize(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            twiddleCos[k] = std::cos(2 * M_PI * k / n);
+            twiddleSin[k] = std::sin(2 * M_PI * k / n);
+        }
+    }
+
+    template <typename T>
+    void append(std::vector<double>& result, const std::vector<T>& values)
+    {
+        result.insert(result.end(), values.begin(), values.end());
+    }
+}
+
+template <typename Kernel>
+void KernelEquivalenceCheck::check(const char* name, FFTKernels::InstructionSet set, double tolerance, bool relative, Kernel kernel)
+{
+    FFTKernels::setInstructionSet(FFTKernels::InstructionSet::Scalar);
+    const std::vector<double> expected = kernel();
+    FFTKernels::setInstructionSet(set);
+    const std::vector<double> actual = kernel();
+
+    double maxValue = 0.0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        maxValue = std::max(maxValue, std::fabs(expected[i]));
+        maxError = std::max(maxError, std::fabs(actual[i] - expected[i]));
+    }
+
+    const double error = relative && maxValue > 0.0 ? maxError / maxValue : maxError;
+    const bool passed = actual.size() == expected.size() && error <= tolerance;
+    m_passed = m_passed && passed;
+
+    std::cout << std::setw(26) << name << std::setw(10) << FFTKernels::instructionSetName(set)
+              << std::scientific << std::setprecision(2)
+              << std::setw(12) << error << std::setw(12) << tolerance
+              << std::setw(10) << (relative ? "relative" : "absolute")
+              << std::setw(8) << (passed ? "ok" : "FAILED") << std::endl;
+}
+
+bool KernelEquivalenceCheck::run()
+{
+    using Set = FFTKernels::InstructionSet;
+
+    const Set initialSet = FFTKernels::instructionSet();
+    const Set supported = FFTKernels::detectInstructionSet();
+    m_passed = true;
+
+    std::cout << "SIMD kernels against the scalar kernels (this CPU supports "
+              << FFTKernels::instructionSetName(supported) << ")" << std::endl;
+    std::cout << std::setw(26) << "Kernel" << std::setw(10) << "Set" << std::setw(12) << "Max error"
+              << std::setw(12) << "Tolerance" << std::setw(10) << "" << std::setw(8) << "Result" << std::endl;
+
+    // Inputs shared by all instruction sets, every kernel works on copies of them
+    const std::vector<double> real = randomValues<double>(FFT_SIZE, 1.0);
+    const std::vector<double> imag = randomValues<double>(FFT_SIZE, 1.0);
+    const std::vector<float> realFloat(real.begin(), real.end());
+    const std::vector<float> imagFloat(imag.begin(), imag.end());
+    const std::vector<double> values = randomValues<double>(NUM_VALUES, 1000.0);
+    const std::vector<double> valuesImag = randomValues<double>(NUM_VALUES, 1000.0);
+    const std::vector<short> samples = randomValues<short>(NUM_SAMPLES, 32767.0);
+    const std::vector<double> firInput = randomValues<double>((NUM_OUTPUTS - 1) * DECIMATION_FACTOR + NUM_TAPS, 32767.0);
+    const std::vector<double> taps = randomValues<double>(NUM_TAPS, 0.1);
+
+    std::vector<double> stepCos, stepSin;
+    twiddles(4 * NUM_BINS, NUM_BINS, stepCos, stepSin);
+
+    for (Set set : { Set::SSE2, Set::AVX2, Set::AVX512 })
+    {
+        if (static_cast<int>(set) > static_cast<int>(supported))
+            continue;
+
+        // Half sizes below, equal to and above the vector widths
+        for (size_t halfsize : { size_t(1), size_t(2), size_t(4), size_t(8), size_t(64) })
+        {
+            check("butterflyStage", set, STAGE_TOLERANCE, true, [&]() {
+                std::vector<double> twiddleCos, twiddleSin;
+                twiddles(2 * halfsize, halfsize, twiddleCos, twiddleSin);
+                std::vector<double> re = real, im = imag;
+                FFTKernels::butterflyStage(re.data(), im.data(), FFT_SIZE, halfsize, twiddleCos.data(), twiddleSin.data());
+                append(re, im);
+                return re;
+            });
+        }
+
+        // Strides below, equal to and above the vector widths
+        for (size_t stride : { size_t(1), size_t(2), size_t(8), size_t(64) })
+        {
+            check("stockhamStage", set, STAGE_TOLERANCE, true, [&]() {
+                std::vector<double> twiddleCos, twiddleSin;
+                twiddles(FFT_SIZE / stride, FFT_SIZE / (2 * stride), twiddleCos, twiddleSin);
+                std::vector<double> re(FFT_SIZE), im(FFT_SIZE);
+                FFTKernels::stockhamStage(real.data(), imag.data(), re.data(), im.data(), FFT_SIZE, stride,
+                                          twiddleCos.data(), twiddleSin.data());
+                append(re, im);
+                return re;
+            });
+
+            check("stockhamRadix4Stage", set, STAGE_TOLERANCE, true, [&]() {
+                std::vector<double> twiddleCos, twiddleSin;
+                twiddles(FFT_SIZE / stride, FFT_SIZE / (4 * stride), twiddleCos, twiddleSin);
+                std::vector<double> re(FFT_SIZE), im(FFT_SIZE);
+                FFTKernels::stockhamRadix4Stage(real.data(), imag.data(), re.data(), im.data(), FFT_SIZE, stride,
+                                                twiddleCos.data(), twiddleSin.data());
+                append(re, im);
+                return re;
+            });
+
+            check("stockhamStage (float)", set, STAGE_TOLERANCE_FLOAT, true, [&]() {
+                std::vector<double> twiddleCos, twiddleSin;
+                twiddles(FFT_SIZE / stride, FFT_SIZE / (2 * stride), twiddleCos, twiddleSin);
+                std::vector<float> re(FFT_SIZE), im(FFT_SIZE);
+                FFTKernels::stockhamStage(realFloat.data(), imagFloat.data(), re.data(), im.data(), FFT_SIZE, stride,
+                                          twiddleCos.data(), twiddleSin.data());
+                std::vector<double> result;
+                append(result, re);
+                append(result, im);
+                return result;
+            });
+
+            check("stockhamRadix4 (float)", set, STAGE_TOLERANCE_FLOAT, true, [&]() {
+                std::vector<double> twiddleCos, twiddleSin;
+                twiddles(FFT_SIZE / stride, FFT_SIZE / (4 * stride), twiddleCos, twiddleSin);
+                std::vector<float> re(FFT_SIZE), im(FFT_SIZE);
+                FFTKernels::stockhamRadix4Stage(realFloat.data(), imagFloat.data(), re.data(), im.data(), FFT_SIZE, stride,
+                                                twiddleCos.data(), twiddleSin.data());
+                std::vector<double> result;
+                append(result, re);
+                append(result, im);
+                return result;
+            });
+        }
+
+        // The largest magnitude is returned as well
+        check("magnitude", set, STAGE_TOLERANCE, true, [&]() {
+            std::vector<double> out(NUM_VALUES);
+            const double maxValue = FFTKernels::magnitude(values.data(), valuesImag.data(), out.data(), NUM_VALUES);
+            out.push_back(maxValue);
+            return out;
+        });
+
+        check("magnitude (float)", set, STAGE_TOLERANCE_FLOAT, true, [&]() {
+            const std::vector<float> re(values.begin(), values.end()), im(valuesImag.begin(), valuesImag.end());
+            std::vector<float> out(NUM_VALUES);
+            const float maxValue = FFTKernels::magnitude(re.data(), im.data(), out.data(), NUM_VALUES);
+            out.push_back(maxValue);
+            std::vector<double> result;
+            append(result, out);
+            return result;
+        });
+
+        check("scale", set, 0.0, false, [&]() {
+            std::vector<double> data = values;
+            FFTKernels::scale(data.data(), 1.0 / 3.0, NUM_VALUES);
+            return data;
+        });
+
+        check("scale (float)", set, 0.0, false, [&]() {
+            std::vector<float> data(values.begin(), values.end());
+            FFTKernels::scale(data.data(), 1.0f / 3.0f, NUM_VALUES);
+            std::vector<double> result;
+            append(result, data);
+            return result;
+        });
+
+        // 45 bins: whole AVX-512, AVX2 and SSE2 tiles and a scalar remainder
+        check("phasorDFT", set, PHASOR_TOLERANCE, true, [&]() {
+            std::vector<double> phasorReal(NUM_BINS, 1.0), phasorImag(NUM_BINS, 0.0);
+            std::vector<double> sumReal(NUM_BINS, 0.0), sumImag(NUM_BINS, 0.0);
+            FFTKernels::phasorDFT(samples.data(), NUM_SAMPLES, phasorReal.data(), phasorImag.data(),
+                                  stepCos.data(), stepSin.data(), sumReal.data(), sumImag.data(), NUM_BINS);
+            append(sumReal, sumImag);
+            append(sumReal, phasorReal);
+            append(sumReal, phasorImag);
+            return sumReal;
+        });
+
+        check("firDecimate", set, FIR_TOLERANCE, true, [&]() {
+            std::vector<double> output(NUM_OUTPUTS);
+            FFTKernels::firDecimate(firInput.data(), NUM_OUTPUTS, DECIMATION_FACTOR, taps.data(), NUM_TAPS, output.data());
+            return output;
+        });
+
+        // Random bytes are valid samples of every integer encoding, floats are drawn in [-1, 1)
+        const std::vector<unsigned char> bytes = randomBytes(NUM_VALUES * 4);
+        const std::vector<float> floats = randomValues<float>(NUM_VALUES, 1.0);
+        const struct { FFTKernels::SampleEncoding encoding; const char* name; const void* data; } encodings[] = {
+            { FFTKernels::SampleEncoding::UInt8, "decodeSamples (uint8)", bytes.data() },
+            { FFTKernels::SampleEncoding::Int8, "decodeSamples (int8)", bytes.data() },
+            { FFTKernels::SampleEncoding::Int16, "decodeSamples (int16)", bytes.data() },
+            { FFTKernels::SampleEncoding::Int32, "decodeSamples (int32)", bytes.data() },
+            { FFTKernels::SampleEncoding::Float32, "decodeSamples (float)", floats.data() },
+        };
+        for (const auto& encoding : encodings)
+        {
+            check(encoding.name, set, 0.0, false, [&]() {
+                std::vector<float> output(NUM_VALUES);
+                FFTKernels::decodeSamples(encoding.data, encoding.encoding, NUM_VALUES, output.data());
+                std::vector<double> result;
+                append(result, output);
+                return result;
+            });
+        }
+
+        // Stereo takes the shuffles, the other counts the generic path, mixed and one channel each
+        for (size_t channels : { size_t(1), size_t(2), size_t(3), size_t(8) })
+        {
+            for (int channel : { -1, static_cast<int>(channels) - 1 })
+            {
+                check(channel < 0 ? "mixChannels (mix)" : "mixChannels (channel)", set, 0.0, false, [&]() {
+                    const size_t numFrames = NUM_VALUES / channels;
+                    std::vector<float> output(numFrames);
+                    FFTKernels::mixChannels(floats.data(), channels, numFrames, channel, output.data());
+                    std::vector<double> result;
+                    append(result, output);
+                    return result;
+                });
+            }
+        }
+
+        // Half way values and values beyond full scale test the rounding and the clamping
+        std::vector<float> unclamped = randomValues<float>(NUM_VALUES, 1.5);
+        for (size_t i = 0; i < 64; i++)
+        {
+            unclamped[i] = (static_cast<float>(i) - 32.0f + 0.5f) / 32768.0f;
+        }
+        check("floatToShort", set, 0.0, false, [&]() {
+            std::vector<short> output(NUM_VALUES);
+            FFTKernels::floatToShort(unclamped.data(), NUM_VALUES, output.data());
+            std::vector<double> result;
+            append(result, output);
+            return result;
+        });
+    }
+
+    FFTKernels::setInstructionSet(initialSet);
+
+    std::cout << (m_passed ? "All kernels within tolerance" : "Some kernels are OUT OF TOLERANCE") << std::endl;
+    return m_passed;
+}
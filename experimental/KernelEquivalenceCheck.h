@@ -0,0 +1,43 @@
+#ifndef KERNELEQUIVALENCECHECK_H
+#define KERNELEQUIVALENCECHECK_H
+
+#include "FFTKernels.h"
+
+#include <vector>
+
+/**
+*   Checks every SIMD version of the FFTKernels against the scalar one: each kernel runs on the
+*   same random input with FFTKernels::setInstructionSet() forcing Scalar, then each instruction
+*   set the CPU supports, and the largest difference is compared with the tolerance of the kernel.
+*
+*   Tolerances:
+*   - The FFT stages and magnitudes compute the same expression per element, but the compiler
+*     may fuse a multiply and an add in one version and not the other: a few units in the last
+*     place of the largest output (4 epsilon, in double or float).
+*   - Scaling is a single multiply per element and must match exactly.
+*   - The phasor DFT accumulates rotations over thousands of samples, the differences of fused
+*     operations grow with them: 1e-12 of the largest sum.
+*   - firDecimate splits every dot product into as many partial sums as the vector has lanes, so
+*     the sums are reassociated: 1e-13 of the largest output.
+*   - The sample conversions are exact: integers to floats by powers of 2, channels mixed in
+*     the same order and rounding to 16 bits half to even. Any difference is an error.
+*/
+class KernelEquivalenceCheck
+{
+public:
+    // Prints one line per kernel and instruction set, returns false if any is out of tolerance.
+    bool run();
+
+private:
+    bool m_passed;
+
+    /*
+    * Runs kernel with the scalar and the given instruction set, each time from the same inputs,
+    * and reports the largest difference of the outputs it returns, relative to the largest
+    * scalar output or absolute.
+    */
+    template <typename Kernel>
+    void check(const char* name, FFTKernels::InstructionSet set, double tolerance, bool relative, Kernel kernel);
+};
+
+#endif // KERNELEQUIVALENCECHECK_H
@@ -9,6 +9,9 @@ INCLUDEPATH += ../include
 CONFIG += console
 QMAKE_CXXFLAGS += -g
 
+# FixedFFT builds its twiddle tables with C++14 constexpr functions
+CONFIG += c++14
+
 HEADERS += ../include/FFTWorkerThread.h \
            ../include/DistributedFFTWorkerThread.h \
            ../include/FFTUtils.h \
@@ -16,7 +19,36 @@ HEADERS += ../include/FFTWorkerThread.h \
            ../include/FTController.h \
            ../include/DFTWorkerThread.h \
            ../include/DistributedDFTWorkerThread.h \
-           FTAnalysis.h
+           ../include/FFTPlan.h \
+           ../include/FFTKernels.h \
+           ../include/FourStepFFT.h \
+           ../include/ZoomFFT.h \
+           ../include/ZoomFFTWorkerThread.h \
+           ../include/FixedFFT.h \
+           ../include/CancellationToken.h \
+           ../include/BinDFT.h \
+           ../include/GoertzelFilterBank.h \
+           ../include/GoertzelWorkerThread.h \
+           ../include/STFT.h \
+           ../include/STFTWorkerThread.h \
+           ../include/WelchPSD.h \
+           ../include/WelchWorkerThread.h \
+           ../include/StreamingWelchWorkerThread.h \
+           ../include/SampleRingBuffer.h \
+           ../include/LiveSpectrumWorkerThread.h \
+           ../include/SlidingDFT.h \
+           ../include/ConstantQ.h \
+           ../include/ConstantQWorkerThread.h \
+           ../include/Decimator.h \
+           ../include/DecimatorWorkerThread.h \
+           ../include/SampleStore.h \
+           ../include/SampleConverter.h \
+           ../include/ChannelWelchWorkerThread.h \
+           FTAnalysis.h \
+           FFTEngineBenchmark.h \
+           FloatAccuracyReport.h \
+           KernelEquivalenceCheck.h \
+           FFTReferenceCheck.h
 
 SOURCES += ./main.cpp \
            ../src/FFTWorkerThread.cpp \
@@ -25,7 +57,35 @@ SOURCES += ./main.cpp \
            ../src/FTController.cpp \
            ../src/DFTWorkerThread.cpp \
            ../src/DistributedDFTWorkerThread.cpp \
-           FTAnalysis.cpp
+           ../src/FFTPlan.cpp \
+           ../src/FFTKernels.cpp \
+           ../src/FourStepFFT.cpp \
+           ../src/ZoomFFT.cpp \
+           ../src/ZoomFFTWorkerThread.cpp \
+           ../src/CancellationToken.cpp \
+           ../src/BinDFT.cpp \
+           ../src/GoertzelFilterBank.cpp \
+           ../src/GoertzelWorkerThread.cpp \
+           ../src/STFT.cpp \
+           ../src/STFTWorkerThread.cpp \
+           ../src/WelchPSD.cpp \
+           ../src/WelchWorkerThread.cpp \
+           ../src/StreamingWelchWorkerThread.cpp \
+           ../src/SampleRingBuffer.cpp \
+           ../src/LiveSpectrumWorkerThread.cpp \
+           ../src/SlidingDFT.cpp \
+           ../src/ConstantQ.cpp \
+           ../src/ConstantQWorkerThread.cpp \
+           ../src/Decimator.cpp \
+           ../src/DecimatorWorkerThread.cpp \
+           ../src/SampleStore.cpp \
+           ../src/SampleConverter.cpp \
+           ../src/ChannelWelchWorkerThread.cpp \
+           FTAnalysis.cpp \
+           FFTEngineBenchmark.cpp \
+           FloatAccuracyReport.cpp \
+           KernelEquivalenceCheck.cpp \
+           FFTReferenceCheck.cpp
 
 RESOURCES += \
     resource.qrc
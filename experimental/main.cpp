@@ -1,4 +1,9 @@
 #include "FTAnalysis.h"
+#include "FFTEngineBenchmark.h"
+#include "FFTReferenceCheck.h"
+#include "FloatAccuracyReport.h"
+#include "KernelEquivalenceCheck.h"
+#include "FFTPlan.h"
 
 #include <QtCore>
 #include <QCoreApplication>
@@ -6,6 +11,41 @@
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
+
+    // Compare the radix-2 FFT engines instead of running the full analysis
+    if (a.arguments().contains("--fft-engines"))
+    {
+        FFTEngineBenchmark benchmark;
+        benchmark.run();
+        return 0;
+    }
+
+    // Compare the single precision FFT against the double precision reference
+    if (a.arguments().contains("--float-accuracy"))
+    {
+        FloatAccuracyReport report;
+        report.run();
+        return 0;
+    }
+
+    // Compare every SIMD kernel against its scalar version, fails if one is out of tolerance
+    if (a.arguments().contains("--kernel-check"))
+    {
+        KernelEquivalenceCheck check;
+        return check.run() ? 0 : 1;
+    }
+
+    // Compare the FFT plans and the band transforms against a naive DFT, fails if one is out of tolerance
+    if (a.arguments().contains("--fft-check"))
+    {
+        FFTReferenceCheck check;
+        return check.run() ? 0 : 1;
+    }
+
+    // Run the analysis with the single precision FFT engine
+    if (a.arguments().contains("--float32"))
+        FFTPlan::setPrecision(FFTPlan::Precision::Single);
+
     FTAnalysis ftAnalysis(&a);
 
     // This will cause the application to exit when
@@ -2,14 +2,19 @@
 #define AUDIOFILESTREAM_H
 
 #include "Waveform.h"
+#include "SampleConverter.h"
+#include "SampleStore.h"
 #include "Spectrograph.h"
+#include "WavFile.h"
 
 #include <QDebug>
 #include <QIODevice>
 #include <QBuffer>
 #include <QAudioDecoder>
 #include <QAudioFormat>
+#include <QAudioOutput>
 #include <QFile>
+#include <memory>
 #include <QtCore/QPointF>
 #include <QtCore/QVector>
 #include <QtCharts/QChartGlobal>
@@ -45,28 +50,46 @@ public:
     QAudioFormat getFormat();
     State getState();
     void setSampleCount(int sampleCount);
+
+    // Bytes of decoded samples kept in memory for the next file, see SampleStore::setMemoryBudget()
+    qint64 memoryBudget() const;
+    void setMemoryBudget(qint64 bytes);
     void cancelSpectrum();
     bool setFormat(const QAudioFormat& format);
     static qreal getPeakValue(const QAudioFormat& format);
 
+    // Device reading this stream, whose buffered samples add to the latency of the live spectrum
+    void setAudioOutput(QAudioOutput* output);
+
 protected:
     qint64 readData(char* data, qint64 maxlen) override;
     qint64 writeData(const char* data, qint64 len) override;
 
 private:
     void drawChartSamples(int start, char* data);
+    void startLiveSpectrum();
+
+    // Plays and analyzes a PCM .wav file in the output format straight from its mapping (see WavFile)
+    bool loadWavFile(const QString& filePath);
 
     QFile* m_file;
-    QBuffer m_input;
-    QBuffer m_output;
-    QByteArray m_data;
     QAudioDecoder m_decoder;
+
+    // Decoded or mapped samples, shared with the transforms, and where the playback is in them
+    std::shared_ptr<SampleStore> m_samples;
+    qint64 m_playbackPosition;
+    qint64 m_memoryBudget;
     QAudioFormat m_format;
 
     Waveform* m_waveform;
     QVector<QPointF> m_waveformBuffer;
+
+    // Converts the played frames to the points of the waveform
+    std::unique_ptr<SampleConverter> m_converter;
+    FloatBuffer m_waveformSamples;
     Spectrograph* m_spectrograph;
     QVector<QPointF> m_spectrumBuffer;
+    QAudioOutput* m_audioOutput;
 
     State m_state;
     qreal m_peakVal;
@@ -0,0 +1,54 @@
+#ifndef BINDFT_H
+#define BINDFT_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   Direct DFT evaluated only at a given list of frequencies, over all the samples of the
+*   signal. The cost is O(n * numBins()) instead of O(n^2) for the full spectrum, and every bin
+*   is independent, so bins can be split between worker threads (see DistributedDFTWorkerThread).
+*
+*   No trigonometric function is called per sample: each bin keeps a phasor exp(-2*pi*i*f*n/fs)
+*   that is rotated by a constant step from one sample to the next, and recomputed exactly
+*   every PHASOR_RESYNC_INTERVAL samples so the rounding errors do not pile up over long signals.
+*   The bins are processed several at a time in SIMD registers by FFTKernels::phasorDFT.
+*/
+class BinDFT
+{
+public:
+    // Samples between two exact evaluations of the phasors
+    static const size_t PHASOR_RESYNC_INTERVAL = 4096;
+
+    BinDFT(double sampleRate, const std::vector<double>& frequencies);
+
+    double sampleRate() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    /*
+     * Adds the contribution of the samples [first, last) of the signal to the bins
+     * [firstBin, lastBin). real/imag hold numBins() values, indexed by bin. Calling it on
+     * consecutive sample ranges gives the same result, up to rounding, as a single call over
+     * the whole range.
+     */
+    void accumulate(const short* samples, size_t first, size_t last, size_t firstBin, size_t lastBin,
+                    std::vector<double>& real, std::vector<double>& imag) const;
+
+private:
+    double m_sampleRate;
+    std::vector<double> m_frequencies;
+
+    // Rotation of every phasor from one sample to the next, exp(-2*pi*i*f/fs)
+    std::vector<double> m_stepCos;
+    std::vector<double> m_stepSin;
+
+    /*
+     * Sets phasorReal/phasorImag to exp(-2*pi*i*f*n/fs) for the bins [firstBin, lastBin).
+     */
+    void phasors(size_t n, size_t firstBin, size_t lastBin, double* phasorReal, double* phasorImag) const;
+};
+
+#endif // BINDFT_H
@@ -0,0 +1,84 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+class QThread;
+
+/**
+*   Cooperative cancellation shared by the compute workers of FTController. cancel() only sets
+*   a flag; the workers poll it between blocks of work (see CancellationCheckpoint) instead of
+*   in their innermost loops, and acknowledge() it when they give up so the time it took them
+*   to notice can be reported.
+*
+*   The latency budget is the longest a worker should keep computing after cancel(). The
+*   checkpoints size their blocks to a fraction of it.
+*/
+class CancellationToken
+{
+public:
+    explicit CancellationToken(std::chrono::milliseconds latencyBudget);
+
+    std::chrono::milliseconds latencyBudget() const;
+    void setLatencyBudget(std::chrono::milliseconds latencyBudget);
+
+    // Asks every worker holding this token to stop. Only the first call is timed.
+    void cancel();
+
+    // Re-arms the token for the next run.
+    void reset();
+
+    bool isCancelled() const;
+
+    // Called by a worker when it stops because of cancel(), records how long that took.
+    void acknowledge();
+
+    // Seconds elapsed since cancel(), 0 if the token is not cancelled.
+    double secondsSinceCancel() const;
+
+    // Longest time between cancel() and a call to acknowledge(), in seconds.
+    double slowestAcknowledgement() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<bool> m_cancelled;
+    std::atomic<long long> m_latencyBudgetMs;
+    std::atomic<Clock::rep> m_cancelTime;
+    std::atomic<Clock::rep> m_slowestAcknowledgement;
+};
+
+/**
+*   Block-wise polling of a CancellationToken by one worker. The worker runs blockSize() items
+*   of work, then calls reached(). The block size adapts to the measured speed so that a block
+*   takes about a quarter of the latency budget: one flag and clock read per block, and a
+*   cancellation is noticed well within the budget whatever the cost of an item.
+*
+*   The thread's own interruption request is honored as well, so workers started without a
+*   token (token is null) can still be stopped with QThread::requestInterruption().
+*/
+class CancellationCheckpoint
+{
+public:
+    CancellationCheckpoint(CancellationToken* token, QThread* thread, size_t initialBlockSize = 64);
+
+    size_t blockSize() const;
+
+    /*
+     * Call after every block of blockSize() items. Returns true, after acknowledging the
+     * token, if the work must stop.
+     */
+    bool reached();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    CancellationToken* m_token;
+    QThread* m_thread;
+    size_t m_blockSize;
+    Clock::time_point m_blockStart;
+};
+
+#endif // CANCELLATIONTOKEN_H
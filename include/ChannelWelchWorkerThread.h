@@ -0,0 +1,62 @@
+#ifndef CHANNELWELCHWORKERTHREAD_H
+#define CHANNELWELCHWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "WelchPSD.h"
+
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+/**
+*   One of the threads estimating the Welch power spectral density of several channels at once
+*   (see FTController::startChannelSpectra()). The segments of all channels are numbered one
+*   after the other and every worker takes its own contiguous range of them, whatever channel
+*   they belong to: the work is split by core, not by channel, so 8 channels on 4 cores keep
+*   the 4 cores busy and 1 channel on 8 cores uses all 8.
+*
+*   The partial sums are reported through channelWelchResultReady(), channel after channel
+*   (numBins() values each, zero for the channels the worker did not touch), and added up in
+*   worker order by FTController::handleChannelWelchResults().
+*/
+class ChannelWelchWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    ChannelWelchWorkerThread();
+    ~ChannelWelchWorkerThread();
+
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setWelchPSD(std::shared_ptr<const WelchPSD> welch);
+
+    // Mono 16 bit samples of each channel, all of the same length
+    void setChannels(std::shared_ptr<const std::vector<std::vector<short>>> channels);
+
+    // Token polled between segments, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void channelWelchResultReady(const QVector<double> power, const int workerID);
+
+private:
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const WelchPSD> m_welch;
+    std::shared_ptr<const std::vector<std::vector<short>>> m_channels;
+    QVector<double> m_power;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // CHANNELWELCHWORKERTHREAD_H
@@ -0,0 +1,75 @@
+#ifndef CONSTANTQ_H
+#define CONSTANTQ_H
+
+#include "FFTPlan.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+*   Constant-Q transform: bins spaced geometrically, binsPerOctave() per octave from
+*   minFrequency(), each one as wide as a fixed fraction of its frequency. The analysis window of
+*   bin k is Q periods of its frequency long, so low bins get long windows (fine frequency
+*   resolution) and high bins short ones, instead of the same resolution everywhere.
+*
+*   Uses the spectral kernel method (Brown and Puckette): the FFTs of the windowed complex
+*   exponentials of every bin are computed once and only their values above a threshold are
+*   kept. A frame is then one real FFT of fftSize() samples followed by a sparse product with
+*   the kernel, which costs a few values per bin. Frames are independent, so any range of
+*   them can be computed by any thread (see ConstantQWorkerThread).
+*/
+class ConstantQ
+{
+public:
+    ConstantQ(double sampleRate, double minFrequency, double maxFrequency, int binsPerOctave);
+
+    double sampleRate() const;
+    int binsPerOctave() const;
+    size_t numBins() const;
+
+    // Quality factor, frequency over bandwidth of every bin
+    double q() const;
+
+    // Center frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    // Size of the frames, enough for the window of the lowest bin
+    size_t fftSize() const;
+    size_t hopSize() const;
+
+    // Number of values kept in the spectral kernel, over all the bins
+    size_t kernelSize() const;
+
+    // Number of frames needed to cover n samples, the last one zero padded.
+    size_t numFrames(size_t n) const;
+
+    /*
+     * Adds the amplitudes of every bin, relative to a full scale sine wave, over the frames
+     * [firstFrame, lastFrame) of the n samples to amplitudeSums, which holds numBins() values.
+     *
+     * Returns false if the calling thread was interrupted before all frames were done.
+     */
+    bool accumulate(const short* samples, size_t n, size_t firstFrame, size_t lastFrame,
+                    std::vector<double>& amplitudeSums) const;
+
+private:
+    double m_sampleRate;
+    double m_minFrequency;
+    int m_binsPerOctave;
+    size_t m_numBins;
+    double m_q;
+    size_t m_fftSize;
+    size_t m_hopSize;
+    std::shared_ptr<const FFTPlan> m_plan;
+
+    // Sparse spectral kernel, row k holding the entries [m_kernelStart[k], m_kernelStart[k + 1])
+    std::vector<size_t> m_kernelStart;
+    std::vector<size_t> m_kernelBin;
+    std::vector<double> m_kernelReal;
+    std::vector<double> m_kernelImag;
+
+    void buildKernel();
+};
+
+#endif // CONSTANTQ_H
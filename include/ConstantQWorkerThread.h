@@ -0,0 +1,58 @@
+#ifndef CONSTANTQWORKERTHREAD_H
+#define CONSTANTQWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "ConstantQ.h"
+
+#include <memory>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads computing a constant-Q spectrum with ConstantQ. Each worker adds up the
+*   amplitudes of its own contiguous range of frames and reports the sums through
+*   constantQResultReady(). The partial sums are added up in worker order and averaged over the
+*   frames by FTController::handleConstantQResults().
+*/
+class ConstantQWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    ConstantQWorkerThread();
+    ~ConstantQWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+    void setConstantQ(std::shared_ptr<const ConstantQ> constantQ);
+
+    // Token polled between batches of frames, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void constantQResultReady(const QVector<double> amplitudeSums, const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const ConstantQ> m_constantQ;
+    QVector<double> m_amplitudeSums;
+    QAudioFormat m_format;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // CONSTANTQWORKERTHREAD_H
@@ -6,7 +6,25 @@ namespace Constants
 	static const int MIN_FREQUENCY = 100;
 	static const int MAX_FREQUENCY = 1000;
 	static const int NUM_DFT_WORKERS = 16;
-	static const int NUM_FFT_WORKERS = 8;
+
+	// Longest a compute worker should keep running after FTController::clear()
+	static const int CANCEL_LATENCY_BUDGET_MS = 50;
+
+	// Shortest time between two partial spectra published while a file is still decoding
+	static const int STREAM_UPDATE_INTERVAL_MS = 100;
+
+	// Samples the streaming worker holds ahead of its segments (512 KB), FTController keeps the rest
+	static const int STREAM_BUFFER_SAMPLES = 1 << 18;
+
+	// Live spectrum of the playback: samples per frame and time between two frames
+	static const int LIVE_SPECTRUM_FRAME_SIZE = 4096;
+	static const int LIVE_SPECTRUM_INTERVAL_MS = 33;
+
+	// Decoded samples kept in memory, beyond which they are spilled to a temporary file (0 = no limit)
+	static const int SAMPLE_MEMORY_BUDGET_MB = 512;
+
+	// Resolution of the constant-Q transform, bins per octave (24 = quarter tones)
+	static const int CONSTANT_Q_BINS_PER_OCTAVE = 24;
 }
 
 #endif // CONSTANTS_H
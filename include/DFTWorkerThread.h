@@ -1,9 +1,13 @@
 #ifndef DFTWORKERTHREAD_H
 #define DFTWORKERTHREAD_H
 
+#include "BinDFT.h"
+#include "CancellationToken.h"
 #include "Constants.h"
+#include "FFTKernels.h"
 
-#include <complex>
+#include <memory>
+#include <vector>
 
 #include <QDebug>
 #include <QtCore/QThread>
@@ -15,6 +19,10 @@
 
 #define _USE_MATH_DEFINES
 
+/**
+*   Computes the direct DFT of the displayed band on a single thread, with BinDFT evaluating
+*   every bin over the whole signal. Slow compared to the FFT, but a usable reference for it.
+*/
 class DFTWorkerThread : public QThread
 {
     Q_OBJECT
@@ -28,6 +36,12 @@ public:
 
     void setDataBuffer(const QBuffer* dataBuffer);
 
+    // Token polled between blocks of samples, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    // The frequencies to evaluate, shared by every DFT worker
+    void setBinDFT(std::shared_ptr<const BinDFT> binDFT);
+
     void clearData();
 
 signals:
@@ -35,6 +49,8 @@ signals:
 
 private:
     const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const BinDFT> m_binDFT;
     QVector<QPointF> m_spectrumBuffer;
     QAudioFormat m_format;
 };
@@ -0,0 +1,80 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   Lowers the sample rate of a signal that is only looked at below maxFrequency, so the
+*   transforms that follow work on 10 to 20 times fewer samples for the same resolution in Hz.
+*
+*   The factor is the largest divisor of the sample rate leaving at least
+*   MIN_OVERSAMPLING * maxFrequency samples per second (15 at 44.1 kHz and 16 at 48 kHz for the
+*   1000 Hz band), so the decimated rate stays a whole number of Hz. It is split into a few
+*   stages of at most MAX_STAGE_FACTOR: each stage is a linear phase lowpass FIR (Kaiser windowed
+*   sinc) keeping [0, maxFrequency] and rejecting by STOPBAND_ATTENUATION_DB whatever would alias
+*   into it, followed by keeping one sample out of factor. Only the kept outputs are computed
+*   (the polyphase form of the filter), with FFTKernels::firDecimate. The early stages have a
+*   wide transition band and only need a few taps, the last one works at a low rate, which is
+*   much cheaper than a single filter at the full rate.
+*
+*   The filters are centered on each output, output m sits at input sample m * factor(), and
+*   the signal is taken as 0 outside [0, n). Any range of outputs can then be computed
+*   independently with the same result, so the outputs can be split between worker threads
+*   (see DecimatorWorkerThread).
+*/
+class Decimator
+{
+public:
+    // Lowest decimated rate, relative to maxFrequency: leaves room for the transition band
+    static const int MIN_OVERSAMPLING_PERCENT = 250;
+
+    // Largest factor of a single stage
+    static const size_t MAX_STAGE_FACTOR = 8;
+
+    // Rejection of the aliased frequencies, below the quantization noise of 16 bit samples
+    static const int STOPBAND_ATTENUATION_DB = 96;
+
+    Decimator(int sampleRate, double maxFrequency);
+
+    int inputRate() const;
+    int outputRate() const;
+    double maxFrequency() const;
+
+    // Total decimation factor, 1 if the sample rate is too low to be decimated.
+    size_t factor() const;
+
+    size_t numStages() const;
+    size_t stageFactor(size_t stage) const;
+    size_t stageNumTaps(size_t stage) const;
+
+    // Number of outputs for n input samples.
+    size_t numOutputs(size_t n) const;
+
+    /*
+     * Computes the outputs [firstOutput, lastOutput) of the n samples, rounded to 16 bits, into
+     * output[0, lastOutput - firstOutput).
+     */
+    void process(const short* samples, size_t n, size_t firstOutput, size_t lastOutput, short* output) const;
+
+private:
+    struct Stage
+    {
+        size_t factor;
+        std::vector<double> taps;
+    };
+
+    int m_inputRate;
+    int m_outputRate;
+    double m_maxFrequency;
+    size_t m_factor;
+    std::vector<Stage> m_stages;
+
+    // Kaiser windowed sinc lowpass for a stage decimating by factor at inputRate.
+    static std::vector<double> designLowpass(double inputRate, size_t factor, double maxFrequency);
+
+    // Number of samples at the input of stage s for n samples at the input of the first stage.
+    size_t stageInputSize(size_t stage, size_t n) const;
+};
+
+#endif // DECIMATOR_H
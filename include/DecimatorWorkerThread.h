@@ -0,0 +1,60 @@
+#ifndef DECIMATORWORKERTHREAD_H
+#define DECIMATORWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "Decimator.h"
+
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads lowering the sample rate of the data buffer with Decimator, ahead of the
+*   transform. Each worker computes its own contiguous range of decimated samples straight into
+*   the shared output (the ranges do not overlap), reading the few input samples around its range
+*   that the filters need. decimationDone() reports that this worker is finished.
+*/
+class DecimatorWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    DecimatorWorkerThread();
+    ~DecimatorWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+
+    // The filters and the decimated samples, shared by every worker
+    void setDecimator(std::shared_ptr<const Decimator> decimator, std::shared_ptr<std::vector<short>> output);
+
+    // Token polled between batches of samples, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void decimationDone(const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const Decimator> m_decimator;
+    std::shared_ptr<std::vector<short>> m_output;
+    QAudioFormat m_format;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // DECIMATORWORKERTHREAD_H
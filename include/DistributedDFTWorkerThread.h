@@ -1,9 +1,13 @@
 #ifndef DISTRIBUTEDDFTWORKERTHREAD_H
 #define DISTRIBUTEDDFTWORKERTHREAD_H
 
+#include "BinDFT.h"
+#include "CancellationToken.h"
 #include "Constants.h"
+#include "FFTKernels.h"
 
-#include <complex>
+#include <memory>
+#include <vector>
 #include <atomic>
 
 #include <QDebug>
@@ -16,6 +20,12 @@
 
 #define _USE_MATH_DEFINES
 
+/**
+*   One of the NUM_DFT_WORKERS threads computing the direct DFT of the displayed band. Each
+*   worker evaluates its own share of the bins of BinDFT over the whole signal and reports their
+*   amplitudes through distributedResultReady(). The bin ranges do not overlap, so the combined
+*   spectrum is the same as the one of DFTWorkerThread.
+*/
 class DistributedDFTWorkerThread : public QThread
 {
 	Q_OBJECT
@@ -34,6 +44,12 @@ public:
     int getWorkerID();
     void setDataBuffer(const QBuffer* dataBuffer);
 
+    // Token polled between blocks of samples, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    // The frequencies to evaluate, shared by every DFT worker
+    void setBinDFT(std::shared_ptr<const BinDFT> binDFT);
+
     void clearData();
 
 signals:
@@ -41,9 +57,17 @@ signals:
 
 private:
     const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const BinDFT> m_binDFT;
     QVector<QPointF> m_spectrumBuffer;
     QAudioFormat m_format;
     int m_workerID;
+
+    /*
+    * Raises the shared maximum amplitude to localMax if it is larger.
+    * Normalization of amplitude is deferred to slot FTController::handleDistributedDFTResults().
+    */
+    static void updateMaxSum(double localMax);
 };
 
 #endif // DISTRIBUTEDDFTWORKERTHREAD_H
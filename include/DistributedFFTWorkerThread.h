@@ -3,6 +3,9 @@
 
 #include "Constants.h"
 #include "FFTUtils.h"
+#include "FFTPlan.h"
+#include "FFTKernels.h"
+#include "FourStepFFT.h"
 
 #include <complex>
 #include <atomic>
@@ -17,6 +20,13 @@
 
 #define _USE_MATH_DEFINES
 
+/**
+*   One of the threads computing a single FFT of the whole signal together. The transform
+*   itself is split by FourStepFFT: each worker transforms a share of the columns and rows of
+*   the four-step decomposition, then reports the bins it owns through distributedResultReady().
+*   The bin ranges of the workers do not overlap, so the combined spectrum is the same as the
+*   one of FFTWorkerThread regardless of the order in which the workers finish.
+*/
 class DistributedFFTWorkerThread : public QThread
 {
     Q_OBJECT
@@ -35,6 +45,9 @@ public:
     int getWorkerID();
     void setDataBuffer(const QBuffer* dataBuffer);
 
+    // The transform shared by every worker of the group, see FourStepFFT
+    void setFourStepFFT(FourStepFFT* fourStepFFT);
+
     void clearData();
 
 signals:
@@ -42,21 +55,22 @@ signals:
 
 private:
     const QBuffer* m_dataBuffer;
+    FourStepFFT* m_fourStepFFT;
     QVector<QPointF> m_spectrumBuffer;
     QAudioFormat m_format;
     int m_workerID;
 
     /*
-    * Computes the discrete Fourier transform (FFT) of the given real/imaginary vectors,
-    * using the Cooley-Tukey decimation-in-time radix-2 algorithm.
-    * If the vectors are not a power of 2, they are padded to the next highest power of 2.
-    * 
-    * This function is almost the same as FFTWorkerThread::cooleyTukey, except normalization of
-    * amplitude is deferred to slot FTController::handleDistributedFFTResults().
-    *
-    * Returns a vector of the (frequency_bin, amplitude) output.
+    * Raises the shared maximum amplitude to localMax if it is larger.
+    * Normalization of amplitude is deferred to slot FTController::handleDistributedFFTResults().
+    */
+    static void updateMaxSum(double localMax);
+
+    /*
+    * Converts the magnitudes of the bins [firstBin, firstBin + magnitudes.size()) of an
+    * n point transform into (frequency, amplitude) points between MIN_FREQUENCY and MAX_FREQUENCY.
     */
-    std::vector<std::pair<size_t, double>> cooleyTukey(std::vector<double>& real, std::vector<double>& imag);
+    void fillSpectrumBuffer(size_t firstBin, const std::vector<double>& magnitudes, size_t n);
 };
 
 #endif // DISTRIBUTEDFFTWORKERTHREAD_H
\ No newline at end of file
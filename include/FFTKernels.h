@@ -0,0 +1,149 @@
+#ifndef FFTKERNELS_H
+#define FFTKERNELS_H
+
+#include <cstddef>
+
+/**
+*   Inner loops of the FFT (radix-2 butterflies, Stockham stages, magnitudes and normalization),
+*   of the direct DFT (rotating phasors), of the decimation filters and of the sample format
+*   conversions with SSE2, AVX2 and AVX-512 versions. The best
+*   instruction set supported by the CPU is picked at runtime on first use, the scalar versions
+*   are used everywhere else.
+*   The element-wise kernels compute the same expression per element in every version, but the
+*   compiler may fuse multiplies and adds differently. The reductions are reassociated:
+*   firDecimate splits each dot product between the lanes and adds the partial sums at the end,
+*   and the long phasorDFT accumulations carry those rounding differences along. Results match
+*   the scalar code within the tolerances checked by experimental --kernel-check, not bit for bit.
+*/
+class FFTKernels
+{
+public:
+    enum class InstructionSet { Scalar, SSE2, AVX2, AVX512 };
+
+    // Encodings of PCM samples, see SampleConverter
+    enum class SampleEncoding { UInt8, Int8, Int16, Int32, Float32 };
+
+    // Returns the instruction set currently used by the kernels.
+    static InstructionSet instructionSet();
+
+    // Returns the best instruction set supported by this CPU.
+    static InstructionSet detectInstructionSet();
+
+    // Forces the kernels to a given instruction set (clamped to what the CPU supports),
+    // mainly used to compare against the scalar fallback. Not safe while transforms are running.
+    static void setInstructionSet(InstructionSet set);
+
+    static const char* instructionSetName(InstructionSet set);
+
+    /*
+     * Runs one decimation-in-time radix-2 level over n values held in split real/imag arrays.
+     * Each block of 2 * halfsize elements combines element j with element j + halfsize
+     * using the twiddle factor (twiddleCos[j] - i * twiddleSin[j]).
+     */
+    static void butterflyStage(double* real, double* imag, size_t n, size_t halfsize,
+                               const double* twiddleCos, const double* twiddleSin);
+
+    /*
+     * Runs one radix-2 Stockham autosort stage over n values, reading from in and writing to out
+     * (the buffers must not overlap). With m = n / (2 * stride), for every p < m and q < stride
+     * the inputs a = in[q + stride * p] and b = in[q + stride * (p + m)] give
+     * out[q + stride * 2p] = a + b and out[q + stride * (2p + 1)] = (a - b) * (twiddleCos[p] - i * twiddleSin[p]).
+     * Every access is sequential, so no reordering pass is needed before or after the stages.
+     */
+    static void stockhamStage(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin);
+
+    /*
+     * Radix-4 version of stockhamStage, with m = n / (4 * stride). The four inputs
+     * in[q + stride * (p + k * m)] are combined into out[q + stride * (4p + k)], output k being
+     * multiplied by w^k where w = twiddleCos[p] - i * twiddleSin[p] (w^2 and w^3 are derived from w).
+     */
+    static void stockhamRadix4Stage(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin);
+
+    // Writes |real[i] + i * imag[i]| to out and returns the largest magnitude.
+    static double magnitude(const double* real, const double* imag, double* out, size_t count);
+
+    // Multiplies every element of data by factor.
+    static void scale(double* data, double factor, size_t count);
+
+    // Single precision versions of the kernels above, used by FFTPlan::Precision::Single.
+    // The twiddles stay in double precision and are rounded as they are loaded.
+    static void stockhamStage(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin);
+    static void stockhamRadix4Stage(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin);
+    static float magnitude(const float* real, const float* imag, float* out, size_t count);
+    static void scale(float* data, float factor, size_t count);
+
+    /*
+     * Direct DFT of numSamples samples at numBins frequencies (see BinDFT). For every sample x
+     * and bin k, adds x * phasor[k] to sum[k], then multiplies phasor[k] by step[k]. The phasors
+     * are left rotated past the last sample, ready for the next call.
+     */
+    static void phasorDFT(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                          const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins);
+
+    /*
+     * FIR filter computing only every factor-th output (see Decimator):
+     * output[m] = sum of taps[t] * input[m * factor + t] for t < numTaps, so input must hold
+     * (numOutputs - 1) * factor + numTaps values. Each output is a dot product over contiguous
+     * taps and samples, which is what the vector versions split between their lanes.
+     */
+    static void firDecimate(const double* input, size_t numOutputs, size_t factor,
+                            const double* taps, size_t numTaps, double* output);
+
+    /*
+     * Converts count PCM values to floats in [-1, 1): the integers are divided by their full
+     * scale (128, 32768 or 2^31, after removing the offset of 128 of unsigned 8 bit samples),
+     * floats are copied as they are.
+     */
+    static void decodeSamples(const void* input, SampleEncoding encoding, size_t count, float* output);
+
+    /*
+     * Reads numFrames frames of channels interleaved values and writes one value per frame:
+     * the given channel, or with channel < 0 the average of all channels.
+     */
+    static void mixChannels(const float* input, size_t channels, size_t numFrames, int channel, float* output);
+
+    // Scales values in [-1, 1) to 16 bits, clamped to the full scale and rounded to nearest even.
+    static void floatToShort(const float* input, size_t count, short* output);
+
+private:
+    typedef void (*ButterflyStageFn)(double*, double*, size_t, size_t, const double*, const double*);
+    typedef void (*StockhamStageFn)(const double*, const double*, double*, double*, size_t, size_t, const double*, const double*);
+    typedef double (*MagnitudeFn)(const double*, const double*, double*, size_t);
+    typedef void (*ScaleFn)(double*, double, size_t);
+    typedef void (*StockhamStageFloatFn)(const float*, const float*, float*, float*, size_t, size_t, const double*, const double*);
+    typedef float (*MagnitudeFloatFn)(const float*, const float*, float*, size_t);
+    typedef void (*ScaleFloatFn)(float*, float, size_t);
+    typedef void (*PhasorDFTFn)(const short*, size_t, double*, double*, const double*, const double*, double*, double*, size_t);
+    typedef void (*FirDecimateFn)(const double*, size_t, size_t, const double*, size_t, double*);
+    typedef void (*DecodeSamplesFn)(const void*, SampleEncoding, size_t, float*);
+    typedef void (*MixChannelsFn)(const float*, size_t, size_t, int, float*);
+    typedef void (*FloatToShortFn)(const float*, size_t, short*);
+
+    struct Dispatch
+    {
+        InstructionSet set;
+        ButterflyStageFn butterflyStage;
+        StockhamStageFn stockhamStage;
+        StockhamStageFn stockhamRadix4Stage;
+        MagnitudeFn magnitude;
+        ScaleFn scale;
+        StockhamStageFloatFn stockhamStageFloat;
+        StockhamStageFloatFn stockhamRadix4StageFloat;
+        MagnitudeFloatFn magnitudeFloat;
+        ScaleFloatFn scaleFloat;
+        PhasorDFTFn phasorDFT;
+        FirDecimateFn firDecimate;
+        DecodeSamplesFn decodeSamples;
+        MixChannelsFn mixChannels;
+        FloatToShortFn floatToShort;
+    };
+
+    static Dispatch& dispatch();
+    static Dispatch dispatchFor(InstructionSet set);
+};
+
+#endif // FFTKERNELS_H
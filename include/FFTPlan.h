@@ -0,0 +1,220 @@
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QMutex>
+
+class QThread;
+
+/**
+*   Precomputed tables for an FFT of a fixed length (twiddle factors and the input
+*   permutation). Plans are immutable once built and are shared between all worker
+*   threads through a size-keyed cache, so repeated transforms of the same length only
+*   pay for the butterflies.
+*
+*   Any length is supported without padding:
+*   - powers of 2 use the radix-2 algorithm, running on the SIMD kernels in FFTKernels,
+*     either in place after a bit-reversal pass or as Stockham autosort stages (see Radix2Engine).
+*     With the Stockham engine, the frame sizes MIN_FIXED_SIZE to MAX_FIXED_SIZE go through
+*     the compile-time specialized transforms of FixedFFT.
+*   - lengths whose prime factors are all 2, 3, 5 or 7 use a mixed-radix algorithm
+*   - everything else (e.g. prime lengths) uses Bluestein's algorithm, which turns the
+*     transform into a convolution computed with a power of 2 plan
+*/
+class FFTPlan
+{
+public:
+    enum class Algorithm { Radix2, MixedRadix, Bluestein };
+
+    /*
+     * How radix-2 transforms are computed:
+     * - InPlace: bit-reversal permutation followed by in-place decimation-in-time butterflies.
+     *   No extra memory, but the permutation jumps all over arrays that are several MB for
+     *   long files.
+     * - Stockham: autosort stages ping-ponging between the data and a scratch buffer. Every
+     *   stage streams through memory sequentially and no permutation pass is needed.
+     */
+    enum class Radix2Engine { InPlace, Stockham };
+
+    /*
+     * Sample type used by the workers for their transforms. Single precision halves the memory
+     * traffic and doubles the SIMD width, at the cost of about 1e-7 relative error instead of
+     * 1e-16. Both run on the same double precision tables, so only the data is rounded.
+     * Single precision radix-2 transforms always use the Stockham engine.
+     */
+    enum class Precision { Double, Single };
+
+    // Power of 2 sizes handled by FixedFFT
+    static const size_t MIN_FIXED_SIZE = 256;
+    static const size_t MAX_FIXED_SIZE = 8192;
+
+    // Most frames transformed together by transformRealBatch()
+    static const size_t MAX_BATCH_FRAMES = 16;
+
+    // Largest plan kept by forSize(), the tables of a plan take a few tens of bytes per point
+    static const size_t MAX_CACHED_SIZE = 1 << 18;
+
+    // Returns the shared plan for length n, building it on first use. Plans longer than
+    // MAX_CACHED_SIZE are built on every call and freed with their last user.
+    static std::shared_ptr<const FFTPlan> forSize(size_t n);
+
+    // Returns the smallest power of 2 that is greater than or equal to n.
+    static size_t paddedSize(size_t n);
+
+    // Releases every cached plan. Plans still held by a running transform stay alive.
+    static void clearCache();
+
+    // Engine used by every radix-2 transform, Stockham by default. Can be changed at any time,
+    // transforms already running finish with the engine they started with.
+    static Radix2Engine radix2Engine();
+    static void setRadix2Engine(Radix2Engine engine);
+    static const char* radix2EngineName(Radix2Engine engine);
+
+    // Precision of the worker transforms, Double by default. Only read when a transform starts.
+    static Precision precision();
+    static void setPrecision(Precision precision);
+    static const char* precisionName(Precision precision);
+
+    size_t size() const;
+    Algorithm algorithm() const;
+
+    // Number of extra elements allocated per real/imag vector while a transform runs.
+    size_t scratchSize() const;
+
+    /*
+     * Computes the in-place FFT of the given real/imaginary vectors, which must both
+     * have exactly size() elements.
+     *
+     * Returns false if the calling thread was interrupted before the transform finished.
+     */
+    bool transform(std::vector<double>& real, std::vector<double>& imag) const;
+    bool transform(std::vector<float>& real, std::vector<float>& imag) const;
+
+    /*
+     * Computes the FFT of size() purely real samples. For even lengths the samples are packed
+     * as size()/2 complex values, run through a half-length complex transform and untangled
+     * in a single pass. On entry real holds the samples, on return real/imag hold the
+     * size()/2 + 1 non-negative frequency bins (the rest of the spectrum is their complex conjugate).
+     *
+     * Returns false if the calling thread was interrupted before the transform finished.
+     */
+    bool transformReal(std::vector<double>& real, std::vector<double>& imag) const;
+    bool transformReal(std::vector<float>& real, std::vector<float>& imag) const;
+
+    /*
+     * Second half of transformReal for callers that run the half-length complex transform
+     * themselves (see FourStepFFT). zReal/zImag hold the size()/2 point transform of the packed
+     * samples; bins [first, last) of the real transform are written to real/imag starting at
+     * index 0. Every bin is computed independently, so disjoint ranges can be untangled in parallel.
+     */
+    void untangleReal(const double* zReal, const double* zImag, size_t first, size_t last,
+                      double* real, double* imag) const;
+    void untangleReal(const float* zReal, const float* zImag, size_t first, size_t last,
+                      float* real, float* imag) const;
+
+    /*
+     * Real transforms of count frames of size() samples, frame f starting at
+     * frames + f * inputStride. The size()/2 + 1 bins of frame f are written to
+     * real + f * outputStride and imag + f * outputStride.
+     *
+     * For radix-2 sizes, up to MAX_BATCH_FRAMES frames (fewer for long frames, so a batch stays
+     * in the L2 cache) are interleaved sample by sample and transformed together: the batch is
+     * a single run of Stockham stages whose SIMD kernels work across the transforms, with one
+     * set of tables and scratch buffers and one interruption check per stage. Other sizes are
+     * transformed one after the other.
+     *
+     * Returns false if the calling thread was interrupted before all frames were done.
+     */
+    bool transformRealBatch(const double* frames, size_t count, size_t inputStride,
+                            double* real, double* imag, size_t outputStride) const;
+    bool transformRealBatch(const float* frames, size_t count, size_t inputStride,
+                            float* real, float* imag, size_t outputStride) const;
+
+private:
+    explicit FFTPlan(size_t n);
+    FFTPlan(const FFTPlan&) = delete;
+    FFTPlan& operator=(const FFTPlan&) = delete;
+
+    void initRadix2();
+    void initMixedRadix(const std::vector<int>& factors);
+    void initBluestein();
+
+    // Shared implementations of the public double/float overloads, defined in FFTPlan.cpp.
+    // The tables stay in double precision and are rounded to T as they are read.
+    template <typename T>
+    bool transformComplex(std::vector<T>& real, std::vector<T>& imag) const;
+    template <typename T>
+    bool transformRealSamples(std::vector<T>& real, std::vector<T>& imag) const;
+    template <typename T>
+    void untangleBins(const T* zReal, const T* zImag, size_t first, size_t last, T* real, T* imag) const;
+    template <typename T>
+    bool transformRealFrames(const T* frames, size_t count, size_t inputStride,
+                             T* real, T* imag, size_t outputStride) const;
+
+    // thread may be null for transforms that must not be interrupted (plan construction)
+    template <typename T>
+    bool execute(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const;
+    bool transformRadix2(double* real, double* imag, QThread* thread) const;
+    bool transformRadix2(float* real, float* imag, QThread* thread) const;
+    // batch > 1 runs the stages over batch transforms interleaved element by element
+    template <typename T>
+    bool transformStockham(T* real, T* imag, QThread* thread, size_t batch = 1) const;
+    template <typename T>
+    bool transformMixedRadix(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const;
+    template <typename T>
+    bool transformBluestein(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const;
+
+    // Returns the radices (4, 2, 3, 5, 7) whose product is n, or an empty vector if n has
+    // any other prime factor.
+    static std::vector<int> smoothFactors(size_t n);
+
+    size_t m_size;
+    Algorithm m_algorithm;
+
+    // Radix-2: twiddle factors laid out contiguously per level so the butterfly kernels can
+    // stream through them: the level with half-size h uses cos/sin of 2*pi*j/(2h) for j in
+    // [0, h), stored starting at index h - 1. The last level holds cos/sin of 2*pi*j/n.
+    std::vector<double> m_stageCos;
+    std::vector<double> m_stageSin;
+
+    // Input permutation: bit reversal for radix-2, digit reversal over m_factors for mixed-radix.
+    // 32 bits is plenty for any audio file we can hold.
+    std::vector<uint32_t> m_permutation;
+
+    // Radix-2 sizes from MIN_FIXED_SIZE to MAX_FIXED_SIZE: FixedFFT<size()>::transform
+    void (*m_fixedTransform)(double*, double*);
+    void (*m_fixedTransformFloat)(float*, float*);
+
+    // Mixed-radix: radix of each stage, and per stage the twiddles cos/sin of 2*pi*j*q/L for
+    // every sub-transform offset j and input q >= 1 (L is the length combined by that stage).
+    std::vector<int> m_factors;
+    std::vector<size_t> m_twiddleOffsets;
+    std::vector<double> m_twiddleCos;
+    std::vector<double> m_twiddleSin;
+
+    // Bluestein: the chirp exp(-i*pi*k^2/n) and the FFT of its conjugate, zero padded to
+    // the length of m_convolutionPlan.
+    std::shared_ptr<const FFTPlan> m_convolutionPlan;
+    std::vector<double> m_chirpCos;
+    std::vector<double> m_chirpSin;
+    std::vector<double> m_filterReal;
+    std::vector<double> m_filterImag;
+
+    // Real-input untangling twiddles cos/sin of 2*pi*k/n for k <= n/4, when n is even.
+    // Radix-2 plans read them straight from the last level of m_stageCos/m_stageSin.
+    std::vector<double> m_realCos;
+    std::vector<double> m_realSin;
+
+    static QMutex s_cacheMutex;
+    static std::map<size_t, std::shared_ptr<const FFTPlan>> s_cache;
+    static std::atomic<int> s_radix2Engine;
+    static std::atomic<int> s_precision;
+};
+
+#endif // FFTPLAN_H
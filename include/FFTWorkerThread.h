@@ -3,6 +3,8 @@
 
 #include "Constants.h"
 #include "FFTUtils.h"
+#include "FFTPlan.h"
+#include "FFTKernels.h"
 
 #include <complex>
 #include <vector>
@@ -42,13 +44,16 @@ private:
 
 
     /*
-     * Computes the discrete Fourier transform (FFT) of the given real/imaginary vectors,
-     * using the Cooley-Tukey decimation-in-time radix-2 algorithm.
-     * If the vectors are not a power of 2, they are padded to the next highest power of 2.
+     * Computes the discrete Fourier transform (FFT) of the given real samples through
+     * FFTPlan::transformReal. The samples are not padded: power of 2 lengths use the
+     * Cooley-Tukey radix-2 algorithm, other lengths the mixed-radix or Bluestein algorithms,
+     * so the bin spacing is always sampleRate / real.size(). T is double or float,
+     * following FFTPlan::precision().
      *
      * Returns a vector of the normalized the (frequency_bin, amplitude) output.
      */
-    std::vector<std::pair<size_t, double>> cooleyTukey(std::vector<double> &real, std::vector<double> &imag);
+    template <typename T>
+    std::vector<std::pair<size_t, double>> cooleyTukey(std::vector<T>& real);
 };
 
 #endif // FFTWORKERTHREAD_H
@@ -1,21 +1,39 @@
 #ifndef FTCONTROLLER_H
 #define FTCONTROLLER_H
 
+#include "CancellationToken.h"
+#include "ChannelWelchWorkerThread.h"
 #include "Constants.h"
+#include "ConstantQWorkerThread.h"
+#include "DecimatorWorkerThread.h"
 #include "DFTWorkerThread.h"
 #include "DistributedDFTWorkerThread.h"
 #include "FFTWorkerThread.h"
 #include "DistributedFFTWorkerThread.h"
+#include "GoertzelWorkerThread.h"
+#include "LiveSpectrumWorkerThread.h"
+#include "SampleConverter.h"
+#include "SampleStore.h"
+#include "STFTWorkerThread.h"
+#include "StreamingWelchWorkerThread.h"
+#include "WelchWorkerThread.h"
+#include "ZoomFFTWorkerThread.h"
 
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
 
+#include <QtCore/QMetaType>
 #include <QtCore/QThread>
 #include <QtCore/QObject>
 #include <QtCore/QPointF>
 #include <QtCore/QVector>
+#include <QtCore/QStringList>
 #include <QAudioFormat>
 
+Q_DECLARE_METATYPE(std::shared_ptr<const Spectrogram>)
+
 /**
 *   Fourier Transform Controller (FTController) handles calculation of DFT/FFT
 *   asynchronously on a thread separate from the main GUI thread, through the use of the
@@ -29,38 +47,280 @@ class FTController : public QObject
 public:
     FTController();
     ~FTController();
+
+    /*
+    * Direct DFT of the displayed band (see BinDFT), on one thread or with the bins split
+    * between NUM_DFT_WORKERS threads.
+    */
     void startDFTInAThread(const QAudioFormat format);
     void startDistributedDFT(const QAudioFormat format);
     void startFFTInAThread(const QAudioFormat format);
     void startDistributedFFT(const QAudioFormat format);
+
+    /*
+    * Computes only the displayed band, MIN_FREQUENCY to MAX_FREQUENCY, every resolution Hz
+    * with the chirp-z transform (see ZoomFFT), split between one worker per core.
+    */
+    void startZoomFFT(const QAudioFormat format, const double resolution = 1.0);
+
+    /*
+    * Checks a few target frequencies (any frequency, not only whole Hz) with the Goertzel
+    * algorithm (see GoertzelFilterBank), the samples being split between one worker per core.
+    * The amplitudes are relative to a full scale sine wave at the target frequency.
+    */
+    void startGoertzel(const QAudioFormat format, const QVector<double> frequencies);
+
+    /*
+    * Computes a spectrogram: the short-time Fourier transform of frames of frameSize samples
+    * every hopSize samples with the given window (see STFT). The frames are shared out between
+    * one worker per core, the result is reported by spectrogramReady() instead of spectrumDataReady().
+    */
+    void startSTFT(const QAudioFormat format, const int frameSize = 2048, const int hopSize = 512,
+                   const STFT::Window window = STFT::Window::Hann);
+
+    /*
+    * Power spectral density of the whole file with Welch's method (see WelchPSD): one second
+    * segments, so the bins are 1 Hz apart like the displayed band, overlapping by half and
+    * weighted by the given window. The segments are split between one worker per core and the
+    * partial sums always added in worker order, so the result does not depend on thread timing.
+    */
+    void startWelch(const QAudioFormat format, const STFT::Window window = STFT::Window::Hann);
+
+    // Signals analyzed by startChannelSpectra(): every channel, or the mid and side of a stereo input
+    enum class ChannelMode { Channels, MidSide };
+
+    /*
+    * Welch estimate of startWelch() for each channel instead of their mix, reported together by
+    * channelSpectraReady(). The channels are converted once, then the segments of all of them are
+    * split between one worker per core (see ChannelWelchWorkerThread), so the time grows with the
+    * number of channels divided by the number of cores. The spectra are normalized by the largest
+    * density of all channels, so their levels can be compared.
+    */
+    void startChannelSpectra(const QAudioFormat format, const ChannelMode mode = ChannelMode::Channels,
+                             const STFT::Window window = STFT::Window::Hann);
+
+    /*
+    * Same estimate as startWelch(), computed while the file is still being decoded: the chunks
+    * passed to appendStreamData() are consumed as they arrive and a partial spectrum is emitted
+    * through spectrumDataReady() as soon as the first segment is done, then regularly until
+    * finishStream() has been called and the final spectrum is emitted. appendStreamData() never
+    * waits for the worker: the samples it has no room for are kept and appended again when the
+    * worker makes room (see StreamingWelchWorkerThread::spaceAvailable()).
+    */
+    void startStream(const QAudioFormat format, const STFT::Window window = STFT::Window::Hann);
+    void appendStreamData(const char* data, const qint64 length);
+    void finishStream();
+
+    // How the live spectrum is computed: an FFT of the latest frame, or a sliding DFT of the band
+    enum class LiveMethod { FFT, SlidingDFT };
+
+    /*
+    * Live spectrum of the playback: the Hann windowed spectrum of the last frameSize samples given
+    * to pushPlaybackData() is reported at display rate by liveSpectrumReady() (see
+    * LiveSpectrumWorkerThread). stopLiveSpectrum() does not wait for the worker, so it can be
+    * called from the playback. It is the only way to end the live spectrum: clear() and new
+    * transforms leave it running.
+    */
+    void startLiveSpectrum(const QAudioFormat format, const int frameSize = Constants::LIVE_SPECTRUM_FRAME_SIZE,
+                           const LiveMethod method = LiveMethod::FFT);
+    void stopLiveSpectrum();
+    // outputDelaySeconds: what the output device still plays before data, added to the latency
+    void pushPlaybackData(const char* data, const qint64 length, const double outputDelaySeconds);
+
+    /*
+    * Constant-Q spectrum of the displayed band (see ConstantQ): binsPerOctave geometrically
+    * spaced bins per octave, averaged over the frames of the file. The frames are split between
+    * one worker per core. The frequencies are meant for a logarithmic axis.
+    */
+    void startConstantQ(const QAudioFormat format, const int binsPerOctave = Constants::CONSTANT_Q_BINS_PER_OCTAVE);
+
+    /*
+    * Optional stage ahead of the transforms of the displayed band (DFT, FFT, zoom FFT, Welch and
+    * constant-Q): the samples are first decimated to a rate just above twice MAX_FREQUENCY
+    * (see Decimator), split between one worker per core, and the transform then runs on 15 to
+    * 16 times fewer samples for the same resolution in Hz. Goertzel and the STFT keep the full
+    * rate, their frequencies are not limited to the band. Off by default.
+    */
+    void setDecimation(const bool enabled);
+    bool isDecimation() const;
     QBuffer* getDataBuffer();
+
+    /*
+    * Analyzes the samples of a sealed store in place instead of the ones written to
+    * getDataBuffer(): the buffer is a view of store->data(), and the store is kept alive until
+    * the next clear(), even if the file is closed meanwhile. The view is limited to the whole
+    * frames of format that fit in INT_MAX bytes.
+    */
+    void setSampleStore(std::shared_ptr<const SampleStore> store, const QAudioFormat format);
     void setAudioFormat(QAudioFormat);
     void clear();
 
+    /*
+    * Longest the workers should keep computing once clear() asks them to stop
+    * (Constants::CANCEL_LATENCY_BUDGET_MS by default).
+    */
+    void setCancelLatencyBudget(const int milliseconds);
+
 signals:
     void spectrumDataReady(const QVector<QPointF> points, const double elapsedSeconds);
 
+    // Amplitudes relative to a full scale sine, latency being the age of the sound they describe
+    void liveSpectrumReady(const QVector<QPointF> points, const double latencySeconds);
+
+    void spectrogramReady(const std::shared_ptr<const Spectrogram> spectrogram, const double elapsedSeconds);
+
+    // One spectrum per channel of startChannelSpectra(), names giving the channel of each
+    void channelSpectraReady(const QVector<QVector<QPointF>> spectra, const QStringList names, const double elapsedSeconds);
+
+    // Emitted by clear() once the running workers have stopped, with the time it took them
+    void threadsCancelled(const int numWorkers, const double elapsedSeconds);
+
 public slots:
     void handleResults(const QVector<QPointF> points);
     void handleDistributedDFTResults(const QVector<QPointF> points, const int workerID);
     void handleDistributedFFTResults(const QVector<QPointF> points, const int workerID);
+    void handleZoomFFTResults(const QVector<double> real, const QVector<double> imag, const int workerID);
+    void handleGoertzelResults(const QVector<double> real, const QVector<double> imag, const int workerID);
+    void handleSTFTResults(const int workerID);
+    void handleWelchResults(const QVector<double> power, const int workerID);
+    void handleChannelWelchResults(const QVector<double> power, const int workerID);
+    void handleStreamingResults(const QVector<double> power, const qint64 numSegments, const bool isFinal);
+    void handleStreamSpace();
+    void handleConstantQResults(const QVector<double> amplitudeSums, const int workerID);
+    void handleDecimationResults(const int workerID);
+    void handleLiveResults(const QVector<QPointF> points, const double latencySeconds);
 
 private:
     DistributedDFTWorkerThread* m_DistributedDFTWorkerThreads[Constants::NUM_DFT_WORKERS];
-    DistributedFFTWorkerThread* m_DistributedFFTWorkerThreads[Constants::NUM_FFT_WORKERS];
+    QVector<DistributedFFTWorkerThread*> m_DistributedFFTWorkerThreads;
+    FourStepFFT* m_fourStepFFT;
+    QVector<ZoomFFTWorkerThread*> m_ZoomFFTWorkerThreads;
+    std::shared_ptr<const ZoomFFT> m_zoomFFT;
+    std::shared_ptr<const BinDFT> m_binDFT;
+    QVector<GoertzelWorkerThread*> m_GoertzelWorkerThreads;
+    std::shared_ptr<const GoertzelFilterBank> m_goertzel;
+    QVector<STFTWorkerThread*> m_STFTWorkerThreads;
+    std::shared_ptr<const STFT> m_stft;
+    std::shared_ptr<Spectrogram> m_spectrogram;
+    QVector<WelchWorkerThread*> m_WelchWorkerThreads;
+    QVector<ChannelWelchWorkerThread*> m_ChannelWelchWorkerThreads;
+    std::shared_ptr<const WelchPSD> m_welch;
+    StreamingWelchWorkerThread* m_StreamingWelchWorkerThread;
+    LiveSpectrumWorkerThread* m_LiveSpectrumWorkerThread;
+    QVector<ConstantQWorkerThread*> m_ConstantQWorkerThreads;
+    std::shared_ptr<const ConstantQ> m_constantQ;
+    std::shared_ptr<const STFT> m_liveSTFT;
+    QVector<DecimatorWorkerThread*> m_DecimatorWorkerThreads;
+    std::shared_ptr<const Decimator> m_decimator;
+    std::shared_ptr<std::vector<short>> m_decimatedSamples;
     DFTWorkerThread* m_DFTWorkerThread;
     FFTWorkerThread* m_FFTWorkerThread;
     QAudioFormat m_format;
     QBuffer* m_dataBuffer;
 
+    // Owner of the samples m_dataBuffer views, if set with setSampleStore()
+    std::shared_ptr<const SampleStore> m_sampleStore;
+
+    // Mono 16 bit copy of the samples m_dataBuffer views once converted (see convertFirst()), their original format and samples
+    std::shared_ptr<std::vector<short>> m_convertedSamples;
+    QAudioFormat m_convertedFrom;
+    QByteArray m_sourceData;
+
+    // Converters of the chunks given to appendStreamData() and pushPlaybackData(), and the converted chunks
+    std::shared_ptr<const SampleConverter> m_streamConverter;
+    std::shared_ptr<const SampleConverter> m_liveConverter;
+    std::vector<short> m_streamSamples;
+    std::vector<short> m_liveSamples;
+
+    // Converted samples the streaming worker had no room for yet, from m_streamBacklogStart on,
+    // and whether finishStream() was called before they were all appended
+    std::vector<short> m_streamBacklog;
+    size_t m_streamBacklogStart;
+    bool m_streamFinishing;
+
+    // Decimated samples, and the buffer read by the transforms of the band (either of the two)
+    QBuffer* m_decimatedBuffer;
+    QBuffer* m_inputBuffer;
+
+    // Transform started again by handleDecimationResults(), with the decimated format
+    std::function<void(const QAudioFormat)> m_decimatedStart;
+    QAudioFormat m_decimatedFormat;
+    bool m_decimation;
+    bool m_decimated;
+
     QVector<QPointF> m_combinedPoints;
+
+    // Partial zoom spectra, indexed by worker ID so they are always added in the same order
+    QVector<QVector<double>> m_zoomPartialReal;
+    QVector<QVector<double>> m_zoomPartialImag;
+
+    // Partial Goertzel sums, indexed by worker ID as well
+    QVector<QVector<double>> m_goertzelPartialReal;
+    QVector<QVector<double>> m_goertzelPartialImag;
+    qint64 m_goertzelNumSamples;
+
+    // Partial periodogram sums, indexed by worker ID as well
+    QVector<QVector<double>> m_welchPartialPower;
+    size_t m_welchNumSegments;
+
+    // Partial periodogram sums of every channel, indexed by worker ID as well
+    QVector<QVector<double>> m_channelPartialPower;
+    QStringList m_channelNames;
+    size_t m_channelNumSegments;
+
+    // Partial constant-Q amplitude sums, indexed by worker ID as well
+    QVector<QVector<double>> m_constantQPartialSums;
+
+    // Next frame to be taken by an STFT worker
+    std::atomic<size_t> m_stftNextFrame;
     std::atomic<int> m_numWorkersFinished;
 
+    // Shared by the DFT, Goertzel, STFT, Welch, constant-Q and decimation workers, cancelled by terminateRunningThreads()
+    CancellationToken m_cancellationToken;
+
     std::chrono::high_resolution_clock::time_point m_timeStart;
     std::chrono::high_resolution_clock::time_point m_timeEnd;
 
     void terminateRunningThreads();
     void resetThreadData();
+
+    /*
+    * First step of the transforms of the band. With decimation on, starts the decimation workers
+    * and returns true: start is called again with the decimated format once they are done.
+    * Otherwise, or when called again, points the workers of the band at the buffer to read
+    * and returns false, the transform goes on with its format.
+    */
+    bool decimateFirst(const QAudioFormat format, std::function<void(const QAudioFormat)> start);
+
+    /*
+    * Step before decimateFirst(): the workers read mono 16 bit samples, so any other format is
+    * converted once (see SampleConverter), the channels mixed down, and start is called with the
+    * converted format before returning true. Returns false if the samples are already mono 16 bit
+    * or in an unsupported format, the transform goes on with its format.
+    */
+    bool convertFirst(const QAudioFormat format, std::function<void(const QAudioFormat)> start);
+
+    // The samples in the format they were given in, even once convertFirst() replaced m_dataBuffer.
+    QByteArray sourceData() const;
+    void setInputBuffer(QBuffer* buffer);
+
+    /*
+    * Builds the DFT of the displayed band, every Hz from MIN_FREQUENCY to MAX_FREQUENCY,
+    * unless the one of the previous run has the same sample rate.
+    */
+    void prepareBinDFT(const QAudioFormat format);
+
+    /*
+    * Builds the Welch estimator with one second segments overlapping by half, unless the one of
+    * the previous run has the same sample rate and window. Returns false if the format is invalid.
+    */
+    bool prepareWelchPSD(const QAudioFormat format, const STFT::Window window);
+
+    /*
+    * Scales a sum of numSegments periodograms into a density and returns the displayed band,
+    * normalized by its largest value unless normalize is false.
+    */
+    QVector<QPointF> welchSpectrumPoints(std::vector<double>& psd, const size_t numSegments, const bool normalize = true) const;
 };
 
 #endif // FTCONTROLLER_H
@@ -0,0 +1,240 @@
+#ifndef FIXEDFFT_H
+#define FIXEDFFT_H
+
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+*   FFT of a length N known at compile time (a power of 2 between 4 and 8192), for the frame
+*   sizes analyzed over and over. Runs the same Stockham stages as FFTPlan on the SIMD kernels
+*   of FFTKernels, but the twiddle factors are computed by the compiler into a constant table
+*   and the sequence of stages is unrolled at compile time, so a call is just the stage kernels:
+*   no plan lookup, no size checks, no interruption checks and no table indirection.
+*
+*   FFTPlan picks these transforms automatically for the sizes FFTPlan::MIN_FIXED_SIZE to
+*   FFTPlan::MAX_FIXED_SIZE when the Stockham engine is selected. They can also be called directly:
+*       FixedFFT<1024>::transform(real, imag);
+*/
+template <size_t N>
+class FixedFFT
+{
+    static_assert(N >= 4 && N <= 8192 && (N & (N - 1)) == 0, "FixedFFT needs a power of 2 size from 4 to 8192");
+
+public:
+    static constexpr size_t size() { return N; }
+
+    /*
+     * Computes the in-place FFT of the N values in real/imag (T is double or float).
+     * A scratch buffer of N values per thread is kept between calls.
+     */
+    template <typename T>
+    static void transform(T* real, T* imag);
+
+private:
+    struct Complex
+    {
+        double re;
+        double im;
+    };
+
+    // cos/sin of w = exp(-2*pi*i*p/(4m)) for the m columns of every radix-4 stage, stage after
+    // stage: N/4 + N/16 + ... < N/3 entries. Entry 0 (w = 1) also serves the radix-2 stage.
+    struct Twiddles
+    {
+        double cos[N / 3 + 1];
+        double sin[N / 3 + 1];
+    };
+
+    // Taylor series of sin/cos, accurate to the last bit for |x| <= pi/4.
+    static constexpr double sinSeries(double x);
+    static constexpr double cosSeries(double x);
+
+    // Returns cos/sin of 2*pi*k/N, reduced to the first octant with the symmetries of the circle.
+    static constexpr Complex unitRoot(size_t k);
+
+    // Builds the twiddle table, evaluated once by the compiler.
+    static constexpr Twiddles makeTwiddles();
+
+    // Index of the first twiddle of the radix-4 stage reading with the given stride.
+    static constexpr size_t stageOffset(size_t stride);
+
+    // 4 for a radix-4 stage, 2 for the final radix-2 stage of odd powers of 2, 0 once done.
+    static constexpr int stageRadix(size_t stride);
+
+    // Number of stages, the result ends up in the scratch buffer when it is odd.
+    static constexpr int numStages();
+
+    template <size_t Stride>
+    using StageTag = std::integral_constant<int, stageRadix(Stride)>;
+
+    template <size_t Stride, typename T>
+    static void stages(T* inReal, T* inImag, T* outReal, T* outImag, std::integral_constant<int, 4>);
+    template <size_t Stride, typename T>
+    static void stages(T* inReal, T* inImag, T* outReal, T* outImag, std::integral_constant<int, 2>);
+    template <size_t Stride, typename T>
+    static void stages(T*, T*, T*, T*, std::integral_constant<int, 0>) {}
+
+    static constexpr Twiddles s_twiddles = makeTwiddles();
+};
+
+template <size_t N>
+constexpr typename FixedFFT<N>::Twiddles FixedFFT<N>::s_twiddles;
+
+template <size_t N>
+constexpr double FixedFFT<N>::sinSeries(double x)
+{
+    double term = x;
+    double sum = x;
+    for (int i = 1; i <= 9; i++)
+    {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+template <size_t N>
+constexpr double FixedFFT<N>::cosSeries(double x)
+{
+    double term = 1.0;
+    double sum = 1.0;
+    for (int i = 1; i <= 9; i++)
+    {
+        term *= -x * x / ((2 * i - 1) * (2 * i));
+        sum += term;
+    }
+    return sum;
+}
+
+template <size_t N>
+constexpr typename FixedFFT<N>::Complex FixedFFT<N>::unitRoot(size_t k)
+{
+    k %= N;
+
+    // Lower half plane: conjugate of the mirrored angle
+    bool negateSin = false;
+    if (2 * k > N)
+    {
+        k = N - k;
+        negateSin = true;
+    }
+
+    // Second quadrant: exp(i*(pi - a)) = -cos(a) + i*sin(a)
+    bool negateCos = false;
+    if (4 * k > N)
+    {
+        k = N / 2 - k;
+        negateCos = true;
+    }
+
+    // Second octant: cos and sin swap around pi/4
+    Complex root = { 0.0, 0.0 };
+    const double pi = 3.14159265358979323846;
+    if (8 * k > N)
+    {
+        const double a = 2 * pi * static_cast<double>(N / 4 - k) / N;
+        root.re = sinSeries(a);
+        root.im = cosSeries(a);
+    }
+    else
+    {
+        const double a = 2 * pi * static_cast<double>(k) / N;
+        root.re = cosSeries(a);
+        root.im = sinSeries(a);
+    }
+
+    if (negateCos)
+        root.re = -root.re;
+    if (negateSin)
+        root.im = -root.im;
+    return root;
+}
+
+template <size_t N>
+constexpr size_t FixedFFT<N>::stageOffset(size_t stride)
+{
+    size_t offset = 0;
+    for (size_t s = 1; s < stride; s *= 4)
+    {
+        offset += N / (4 * s);
+    }
+    return offset;
+}
+
+template <size_t N>
+constexpr int FixedFFT<N>::stageRadix(size_t stride)
+{
+    return stride >= N ? 0 : (N / stride >= 4 ? 4 : 2);
+}
+
+template <size_t N>
+constexpr int FixedFFT<N>::numStages()
+{
+    int count = 0;
+    for (size_t stride = 1; stride < N; stride *= stageRadix(stride))
+    {
+        count++;
+    }
+    return count;
+}
+
+template <size_t N>
+constexpr typename FixedFFT<N>::Twiddles FixedFFT<N>::makeTwiddles()
+{
+    Twiddles table = {};
+    for (size_t stride = 1; stageRadix(stride) == 4; stride *= 4)
+    {
+        // Column p of this stage uses w = exp(-2*pi*i*p/(4m)) = exp(-2*pi*i*p*stride/N)
+        const size_t m = N / (4 * stride);
+        const size_t offset = stageOffset(stride);
+        for (size_t p = 0; p < m; p++)
+        {
+            const Complex root = unitRoot(p * stride);
+            table.cos[offset + p] = root.re;
+            table.sin[offset + p] = root.im;
+        }
+    }
+    return table;
+}
+
+template <size_t N>
+template <size_t Stride, typename T>
+void FixedFFT<N>::stages(T* inReal, T* inImag, T* outReal, T* outImag, std::integral_constant<int, 4>)
+{
+    FFTKernels::stockhamRadix4Stage(inReal, inImag, outReal, outImag, N, Stride,
+                                    &s_twiddles.cos[stageOffset(Stride)], &s_twiddles.sin[stageOffset(Stride)]);
+
+    // The next stage reads what this one wrote
+    stages<Stride * 4>(outReal, outImag, inReal, inImag, StageTag<Stride * 4>());
+}
+
+template <size_t N>
+template <size_t Stride, typename T>
+void FixedFFT<N>::stages(T* inReal, T* inImag, T* outReal, T* outImag, std::integral_constant<int, 2>)
+{
+    // Last stage of odd powers of 2 has a single column, whose twiddle is the first entry (1)
+    FFTKernels::stockhamStage(inReal, inImag, outReal, outImag, N, Stride, &s_twiddles.cos[0], &s_twiddles.sin[0]);
+}
+
+template <size_t N>
+template <typename T>
+void FixedFFT<N>::transform(T* real, T* imag)
+{
+    thread_local std::vector<T> scratchReal(N);
+    thread_local std::vector<T> scratchImag(N);
+
+    stages<1>(real, imag, scratchReal.data(), scratchImag.data(), StageTag<1>());
+
+    // The stages alternate between the data and the scratch buffer
+    if (numStages() % 2 == 1)
+    {
+        std::copy(scratchReal.begin(), scratchReal.end(), real);
+        std::copy(scratchImag.begin(), scratchImag.end(), imag);
+    }
+}
+
+#endif // FIXEDFFT_H
@@ -0,0 +1,125 @@
+#ifndef FOURSTEPFFT_H
+#define FOURSTEPFFT_H
+
+#include "FFTPlan.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+/**
+*   Multi-threaded FFT of one whole signal, shared by a fixed group of worker threads
+*   (see DistributedFFTWorkerThread). Uses the four-step algorithm: the n real samples are
+*   packed as M = n/2 complex values z and viewed as an n2 x n1 matrix whose row j2, column j1
+*   holds z[j1 + n1 * j2] (M = n1 * n2, n1 close to sqrt(M)), then
+*   1. every worker transforms its share of the n1 length-n2 columns and applies the twiddles
+*      exp(-2*pi*i*j1*k2/M),
+*   2. every worker transforms its share of the n2 length-n1 rows, writing them transposed
+*      into natural bin order,
+*   3. every worker untangles its own range of the n/2 + 1 real-input bins and computes
+*      their magnitudes.
+*   The workers meet at a barrier between the steps. Each step only writes disjoint ranges, so
+*   the result does not depend on scheduling and matches FFTPlan::transformReal up to rounding.
+*   The shared buffers hold doubles or floats depending on FFTPlan::precision() when the
+*   transform starts.
+*/
+class FourStepFFT
+{
+public:
+    explicit FourStepFFT(int numWorkers);
+
+    int numWorkers() const;
+
+    // Prepares for a new transform. Must be called before the workers are started.
+    void reset();
+
+    // Wakes up every worker waiting at the barrier and makes them give up on the transform.
+    void abort();
+
+    /*
+     * Runs this worker's share of the FFT of the n given samples. Every worker of the group must
+     * call this with the same samples. On success, magnitudes holds |X[k]| for the bins
+     * [firstBin, firstBin + magnitudes.size()) owned by this worker and maxMagnitude their maximum.
+     *
+     * Returns false if the transform was aborted or the calling thread was interrupted.
+     */
+    bool run(int workerID, const short* samples, size_t n,
+             size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude);
+
+private:
+    FourStepFFT(const FourStepFFT&) = delete;
+    FourStepFFT& operator=(const FourStepFFT&) = delete;
+
+    /*
+    * Chooses the matrix shape and allocates the shared buffers. Only worker 0 calls this,
+    * the first barrier publishes the result to the other workers.
+    */
+    void prepare(size_t n);
+
+    /*
+    * Blocks until every worker has reached the barrier.
+    * Returns false if the transform was aborted in the meantime.
+    */
+    bool synchronize();
+
+    // Shared buffers of one precision
+    template <typename T>
+    struct Buffers
+    {
+        // Twiddled column transforms, column j1 stored contiguously at j1 * n2
+        std::vector<T> matrixReal;
+        std::vector<T> matrixImag;
+
+        // Complex spectrum in natural order
+        std::vector<T> spectrumReal;
+        std::vector<T> spectrumImag;
+
+        void resize(size_t count);
+        void release();
+    };
+
+    // Runs the three steps on the buffers of the chosen precision.
+    template <typename T>
+    bool runSteps(int workerID, const short* samples, Buffers<T>& buffers,
+                  size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude);
+
+    template <typename T>
+    bool transformColumns(int workerID, const short* samples, Buffers<T>& buffers);
+    template <typename T>
+    bool transformRows(int workerID, Buffers<T>& buffers);
+    template <typename T>
+    void untangle(int workerID, Buffers<T>& buffers, size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude);
+
+    // Returns the range [first, last) of count items owned by workerID.
+    void workerRange(int workerID, size_t count, size_t& first, size_t& last) const;
+
+    const int m_numWorkers;
+
+    // Barrier state
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    int m_arrived;
+    unsigned int m_generation;
+    bool m_aborted;
+
+    // Shape of the current transform: n samples, M complex values (n/2 when packed, n for odd
+    // lengths), n2 rows and n1 columns
+    size_t m_size;
+    size_t m_complexSize;
+    size_t m_rows;
+    size_t m_columns;
+    bool m_packed;
+    bool m_singlePrecision;
+
+    std::shared_ptr<const FFTPlan> m_columnPlan;
+    std::shared_ptr<const FFTPlan> m_rowPlan;
+    std::shared_ptr<const FFTPlan> m_realPlan;
+
+    Buffers<double> m_doubleBuffers;
+    Buffers<float> m_singleBuffers;
+};
+
+#endif // FOURSTEPFFT_H
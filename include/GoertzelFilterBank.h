@@ -0,0 +1,52 @@
+#ifndef GOERTZELFILTERBANK_H
+#define GOERTZELFILTERBANK_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   DFT of a signal at a few arbitrary frequencies (not necessarily on the FFT grid) with the
+*   Goertzel algorithm. Each frequency costs one multiply and two adds per sample and two values
+*   of state, so checking a handful of known tones is O(n * numBins()) in time and O(numBins())
+*   in memory, instead of a full FFT of the whole file.
+*
+*   The recurrence runs on blocks of at most BLOCK_SIZE samples. Each block result is shifted by
+*   the phase of its position in the signal and added up, which keeps the rounding errors of the
+*   recurrence bounded on long signals. Blocks anywhere in the signal can be computed
+*   independently, so sample ranges can be split between worker threads (see GoertzelWorkerThread).
+*/
+class GoertzelFilterBank
+{
+public:
+    // Longest run of the recurrence before its result is folded into the sum
+    static const size_t BLOCK_SIZE = 8192;
+
+    GoertzelFilterBank(double sampleRate, const std::vector<double>& frequencies);
+
+    double sampleRate() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    /*
+     * Adds the DFT of the samples [first, last) of the signal at every frequency to real/imag,
+     * which hold numBins() values.
+     */
+    void accumulate(const short* samples, size_t first, size_t last,
+                    std::vector<double>& real, std::vector<double>& imag) const;
+
+private:
+    double m_sampleRate;
+    std::vector<double> m_frequencies;
+
+    // 2 * cos(w) of the recurrence, and cos(w)/sin(w) to finish each block
+    std::vector<double> m_coefficients;
+    std::vector<double> m_cos;
+    std::vector<double> m_sin;
+
+    // Returns 2*pi*f*n/fs reduced to [0, 2*pi) for bin k.
+    double angle(size_t k, size_t n) const;
+};
+
+#endif // GOERTZELFILTERBANK_H
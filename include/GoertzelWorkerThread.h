@@ -0,0 +1,59 @@
+#ifndef GOERTZELWORKERTHREAD_H
+#define GOERTZELWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "GoertzelFilterBank.h"
+
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads checking a list of target frequencies with GoertzelFilterBank. Each worker
+*   runs the filter bank over its own contiguous range of samples and reports the (complex) sum
+*   through goertzelResultReady(). The partial sums are added up by FTController::handleGoertzelResults().
+*/
+class GoertzelWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    GoertzelWorkerThread();
+    ~GoertzelWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+    void setFilterBank(std::shared_ptr<const GoertzelFilterBank> filterBank);
+
+    // Token polled between blocks of samples, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void goertzelResultReady(const QVector<double> real, const QVector<double> imag, const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const GoertzelFilterBank> m_filterBank;
+    QVector<double> m_real;
+    QVector<double> m_imag;
+    QAudioFormat m_format;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // GOERTZELWORKERTHREAD_H
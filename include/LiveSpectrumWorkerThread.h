@@ -0,0 +1,75 @@
+#ifndef LIVESPECTRUMWORKERTHREAD_H
+#define LIVESPECTRUMWORKERTHREAD_H
+
+#include "Constants.h"
+#include "SampleRingBuffer.h"
+#include "SlidingDFT.h"
+#include "STFT.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
+/**
+*   Spectrum of what is being played, refreshed every LIVE_SPECTRUM_INTERVAL_MS. The playback
+*   hands the samples it sends to the output device to pushSamples(), which only copies them
+*   into a lock-free SampleRingBuffer. Every interval the thread drops whatever is older than
+*   one frame, transforms the latest frame with a one-frame STFT and reports the displayed band
+*   through liveResultReady(), so the delay between the sound and its spectrum stays bounded by
+*   the interval, half a frame and the buffer of the output device however long the computation
+*   falls behind.
+*
+*   With a SlidingDFT, every new sample updates the bins of the band instead, in O(bins) per
+*   sample, and only the magnitudes are computed every interval.
+*/
+class LiveSpectrumWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    LiveSpectrumWorkerThread();
+    ~LiveSpectrumWorkerThread();
+
+    // One frame transform, its frame size is the window of the live spectrum
+    void setSTFT(std::shared_ptr<const STFT> stft);
+
+    // Replaces the STFT frames when set, the window size being the one of the sliding DFT
+    void setSlidingDFT(std::shared_ptr<SlidingDFT> slidingDFT);
+
+    // The thread runs until its interruption is requested (see FTController::stopLiveSpectrum()).
+    // Producer side, called by the playback. Never blocks; samples are dropped if the ring is full.
+    // outputDelaySeconds is how much the output device still had to play before these samples.
+    void pushSamples(const short* samples, size_t count, double outputDelaySeconds);
+
+    // Empties the ring and the sliding DFT. The thread must not be running.
+    void clearData();
+
+signals:
+    void liveResultReady(const QVector<QPointF> points, const double latencySeconds);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::shared_ptr<const STFT> m_stft;
+    std::shared_ptr<SlidingDFT> m_slidingDFT;
+    SampleRingBuffer m_ring;
+
+    // Time of the last pushSamples(), to report how old the newest sample of a frame is, and the
+    // output delay it was given
+    std::atomic<Clock::rep> m_lastPushTime;
+    std::atomic<double> m_outputDelay;
+
+    // Band of the latest frame of the STFT, or the current window of the sliding DFT
+    QVector<QPointF> stftPoints(const std::vector<short>& frame, Spectrogram& spectrum);
+    QVector<QPointF> slidingDFTPoints();
+};
+
+#endif // LIVESPECTRUMWORKERTHREAD_H
@@ -0,0 +1,100 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include "FFTPlan.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+*   Magnitudes of a short-time Fourier transform, stored as one contiguous time x frequency
+*   matrix of floats: row f holds the numBins() bins of frame f, frames being hopSize() samples
+*   apart. Amplitudes are relative to a full scale sine wave, so a pure tone at full scale reads
+*   about 1 in the bin closest to its frequency.
+*/
+class Spectrogram
+{
+public:
+    Spectrogram(double sampleRate, size_t frameSize, size_t hopSize, size_t numFrames);
+
+    double sampleRate() const;
+    size_t frameSize() const;
+    size_t hopSize() const;
+    size_t numFrames() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    // Time in seconds of the center of frame f.
+    double time(size_t f) const;
+
+    // The numBins() magnitudes of frame f.
+    const float* frame(size_t f) const;
+    float* frame(size_t f);
+
+    // The whole matrix, numFrames() rows of numBins() values.
+    const std::vector<float>& magnitudes() const;
+
+private:
+    double m_sampleRate;
+    size_t m_frameSize;
+    size_t m_hopSize;
+    size_t m_numFrames;
+    size_t m_numBins;
+    std::vector<float> m_magnitudes;
+};
+
+/**
+*   Short-time Fourier transform: the signal is cut into frames of frameSize() samples every
+*   hopSize() samples, each frame is multiplied by a window and transformed with the shared
+*   FFTPlan of its size (FixedFFT for the usual power of 2 sizes), up to FFTPlan::MAX_BATCH_FRAMES
+*   frames at a time through FFTPlan::transformRealBatch(). The last frame is zero padded.
+*   Frames are independent, so any range of them can be computed by any thread (see STFTWorkerThread).
+*/
+class STFT
+{
+public:
+    enum class Window { Rectangular, Hann, Hamming, Blackman };
+
+    STFT(double sampleRate, size_t frameSize, size_t hopSize, Window window);
+
+    double sampleRate() const;
+    size_t frameSize() const;
+    size_t hopSize() const;
+    Window window() const;
+
+    // Number of frames needed to cover n samples.
+    size_t numFrames(size_t n) const;
+
+    // Allocates the output for n samples.
+    std::shared_ptr<Spectrogram> createSpectrogram(size_t n) const;
+
+    /*
+     * Computes the frames [firstFrame, lastFrame) of the n samples into their rows of spectrogram.
+     *
+     * Returns false if the calling thread was interrupted before all frames were done.
+     */
+    bool transformFrames(const short* samples, size_t n, size_t firstFrame, size_t lastFrame,
+                         Spectrogram& spectrogram) const;
+
+    // Coefficients of a periodic window of size samples.
+    static std::vector<double> createWindow(Window window, size_t size);
+
+    static const char* windowName(Window window);
+
+private:
+    double m_sampleRate;
+    size_t m_frameSize;
+    size_t m_hopSize;
+    Window m_window;
+    std::shared_ptr<const FFTPlan> m_plan;
+
+    std::vector<double> m_windowTable;
+
+    // Turns a magnitude into an amplitude relative to a full scale sine: 2 / (32767 * sum(window))
+    double m_scale;
+};
+
+#endif // STFT_H
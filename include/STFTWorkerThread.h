@@ -0,0 +1,60 @@
+#ifndef STFTWORKERTHREAD_H
+#define STFTWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "STFT.h"
+
+#include <atomic>
+#include <memory>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads computing a spectrogram with STFT. The workers share a frame counter and
+*   keep taking the next batch of frames from it until every frame is done, so a worker that
+*   falls behind (or is descheduled) does not hold up the others. Frames are written straight
+*   into their rows of the shared Spectrogram; stftFramesDone() reports that this worker is finished.
+*/
+class STFTWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    STFTWorkerThread();
+    ~STFTWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+
+    // The transform, its output and the index of the next frame to compute, shared by every worker
+    void setSTFT(std::shared_ptr<const STFT> stft, std::shared_ptr<Spectrogram> spectrogram,
+                 std::atomic<size_t>* nextFrame);
+
+    // Token polled between batches of frames, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void stftFramesDone(const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const STFT> m_stft;
+    std::shared_ptr<Spectrogram> m_spectrogram;
+    std::atomic<size_t>* m_nextFrame;
+    QAudioFormat m_format;
+    int m_workerID;
+};
+
+#endif // STFTWORKERTHREAD_H
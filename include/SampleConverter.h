@@ -0,0 +1,118 @@
+#ifndef SAMPLECONVERTER_H
+#define SAMPLECONVERTER_H
+
+#include "FFTKernels.h"
+
+#include <QAudioFormat>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/*
+ * Allocator aligning the elements to 64 bytes, so the SIMD kernels load whole cache lines
+ * and never split an AVX-512 register across two of them.
+ */
+template <typename T>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    static const size_t ALIGNMENT = 64;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        // The block is over-allocated, the pointer to free is kept just before the aligned one
+        char* raw = static_cast<char*>(::operator new(n * sizeof(T) + ALIGNMENT + sizeof(void*)));
+        const uintptr_t start = reinterpret_cast<uintptr_t>(raw + sizeof(void*));
+        void** aligned = reinterpret_cast<void**>((start + ALIGNMENT - 1) & ~uintptr_t(ALIGNMENT - 1));
+        aligned[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float>> FloatBuffer;
+
+/**
+*   Converts interleaved PCM frames of any format QAudioDecoder produces (unsigned 8 bit,
+*   signed 8, 16 and 32 bit, 32 bit float, little endian, any number of channels) with the
+*   SIMD kernels of FFTKernels. The frames go through small blocks on the stack, so a
+*   conversion touches the input and the output once whatever their size.
+*
+*   Outputs:
+*   - toFloat(): one channel, or all of them mixed down to mono (MIX), in [-1, 1)
+*   - toShort(): one channel or the mono mix as 16 bit samples, the input of the transform
+*     workers (see shortFormat()). A mono 16 bit input is copied as it is.
+*   - deinterleave(): every channel to its own 16 bit buffer, decoding each frame only once
+*   - toMidSide(): the sum and difference of the two channels of a stereo input
+*
+*   A converter holds no state besides the format and can be used from several threads.
+*/
+class SampleConverter
+{
+public:
+    // Channel argument that mixes all channels down to mono
+    static const int MIX = -1;
+
+    // Throws std::invalid_argument if the format is not one of the above.
+    explicit SampleConverter(const QAudioFormat& format);
+    SampleConverter(FFTKernels::SampleEncoding encoding, int channelCount);
+
+    FFTKernels::SampleEncoding encoding() const;
+    int channelCount() const;
+    int bytesPerFrame() const;
+
+    // Number of whole frames in bytes.
+    size_t numFrames(size_t bytes) const;
+
+    // Whether the input is already mono 16 bit, which the workers read directly.
+    bool isNative() const;
+
+    // Converts numFrames frames of channel (or MIX) to output.
+    void toFloat(const char* data, size_t numFrames, int channel, float* output) const;
+
+    // Converts numFrames frames of channel (or MIX) to 16 bit samples.
+    void toShort(const char* data, size_t numFrames, int channel, short* output) const;
+
+    // Converts numFrames frames to 16 bit samples, outputs[c] receiving channel c.
+    void deinterleave(const char* data, size_t numFrames, short* const* outputs) const;
+
+    /*
+     * Stereo only (throws std::invalid_argument otherwise): converts numFrames frames to the
+     * mid (L + R) / 2 and side (L - R) / 2 signals as 16 bit samples.
+     */
+    void toMidSide(const char* data, size_t numFrames, short* mid, short* side) const;
+
+    // Format of the toShort() samples for a given input format: mono, signed 16 bit, same rate.
+    static QAudioFormat shortFormat(const QAudioFormat& format);
+
+private:
+    // Samples (frames times channels) converted at a time, 16 KB of floats on the stack
+    static const size_t BLOCK_SAMPLES = 4096;
+
+    FFTKernels::SampleEncoding m_encoding;
+    int m_channelCount;
+    int m_bytesPerSample;
+    size_t m_blockFrames;
+
+    // Decodes one block of at most m_blockFrames frames to output, mixing or selecting channel.
+    void convertBlock(const char* data, size_t numFrames, int channel, float* output) const;
+};
+
+#endif // SAMPLECONVERTER_H
@@ -0,0 +1,59 @@
+#ifndef SAMPLERINGBUFFER_H
+#define SAMPLERINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+*   Lock-free single producer, single consumer ring of 16 bit samples. One thread write()s,
+*   another read()s; neither ever blocks or takes a lock, so the audio callback can feed it
+*   without risking a glitch. The capacity is rounded up to a power of 2 and the positions
+*   only ever grow, their difference being the number of samples in the ring.
+*
+*   When the consumer falls behind and the ring is full, write() drops the samples that do
+*   not fit instead of overwriting ones the consumer may be reading.
+*/
+class SampleRingBuffer
+{
+public:
+    explicit SampleRingBuffer(size_t capacity);
+
+    size_t capacity() const;
+
+    // Number of samples that can be read, as seen by the consumer.
+    size_t available() const;
+
+    /*
+     * Producer: appends up to count samples.
+     * Returns the number of samples written, less than count if the ring is full.
+     */
+    size_t write(const short* samples, size_t count);
+
+    /*
+     * Consumer: moves up to count of the oldest samples to samples.
+     * Returns the number of samples read.
+     */
+    size_t read(short* samples, size_t count);
+
+    // Consumer: drops the oldest samples so at most keep are left. Returns the number dropped.
+    size_t discard(size_t keep);
+
+    // Empties the ring. Neither side may be in use.
+    void clear();
+
+private:
+    SampleRingBuffer(const SampleRingBuffer&) = delete;
+    SampleRingBuffer& operator=(const SampleRingBuffer&) = delete;
+
+    std::vector<short> m_samples;
+    size_t m_mask;
+
+    // Written by the producer only, read by the consumer
+    std::atomic<size_t> m_writePosition;
+
+    // Written by the consumer only, read by the producer
+    std::atomic<size_t> m_readPosition;
+};
+
+#endif // SAMPLERINGBUFFER_H
@@ -0,0 +1,111 @@
+#ifndef SAMPLESTORE_H
+#define SAMPLESTORE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class QTemporaryFile;
+
+/**
+*   The decoded samples of a file, held once and shared (through std::shared_ptr) by the
+*   playback, the waveform and the transforms instead of each keeping its own QByteArray.
+*
+*   While the file decodes, append() fills fixed chunks and starts a new one when the last is
+*   full, so nothing already stored is ever moved or copied again. reserve() sizes the first
+*   chunk to the expected length of the file, which is usually all of it. seal() ends the
+*   appends; the transforms need the samples in one block, so if they spread over several
+*   chunks seal() joins them, once. From then on the store is immutable and data() is the
+*   whole file.
+*
+*   With a memory budget, the full chunks beyond it are written to a temporary file and
+*   memory-mapped back, so a recording larger than the RAM only costs the pages being read,
+*   which the OS can drop again. The chunks are then joined in that file instead of on the heap.
+*
+*   A mapped file (see WavFile) is wrapped as a single sealed chunk without a copy, the
+*   store then keeps the mapping alive.
+*
+*   One thread appends and reads; the other threads may only read once the store is sealed.
+*/
+class SampleStore
+{
+public:
+    // Size of the chunks allocated once the reserved size is used up
+    static const size_t CHUNK_BYTES = 1 << 20;
+
+    SampleStore();
+    ~SampleStore();
+
+    // A sealed store viewing size bytes at data, which owner keeps valid.
+    static std::shared_ptr<SampleStore> wrap(const char* data, size_t size, std::shared_ptr<const void> owner);
+
+    /*
+     * Most bytes kept on the heap, the rest is spilled to a temporary file. 0 (the default)
+     * keeps everything in memory. Only taken into account before the first append().
+     */
+    void setMemoryBudget(size_t bytes);
+    size_t memoryBudget() const;
+
+    // Size of the first chunk, ignored once something was appended or if over the memory budget.
+    void reserve(size_t bytes);
+    void append(const char* data, size_t length);
+
+    // Ends the appends and joins the chunks into one block.
+    void seal();
+    bool isSealed() const;
+
+    // Number of bytes appended so far.
+    size_t size() const;
+
+    // Number of bytes currently on the heap, the others being mapped from the temporary file.
+    size_t memoryBytes() const;
+
+    /*
+     * Copies up to length bytes from offset to destination, across chunks.
+     * Returns the number of bytes copied, less than length at the end of the store.
+     */
+    size_t read(size_t offset, char* destination, size_t length) const;
+
+    // The whole contents, only valid once the store is sealed.
+    const char* data() const;
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<char[]> heap;
+        const char* data;
+        size_t capacity;
+        size_t size;
+    };
+
+    SampleStore(const SampleStore&) = delete;
+    SampleStore& operator=(const SampleStore&) = delete;
+
+    std::vector<Chunk> m_chunks;
+    size_t m_size;
+    size_t m_reserved;
+    bool m_sealed;
+
+    size_t m_memoryBudget;
+    size_t m_memoryBytes;
+
+    // Temporary file holding the first m_numSpilled chunks, m_spilledBytes in all
+    std::unique_ptr<QTemporaryFile> m_spillFile;
+    size_t m_numSpilled;
+    size_t m_spilledBytes;
+
+    // Wrapped memory, used instead of m_chunks
+    const char* m_external;
+    std::shared_ptr<const void> m_owner;
+
+    // Moves the oldest full chunks to the temporary file until the heap fits the budget.
+    void spillOverBudget();
+
+    // Appends chunk c to the temporary file. Returns false if it could not be written.
+    bool writeChunk(size_t c);
+
+    // Joins the chunks in the temporary file and maps them as a single one.
+    bool joinInFile();
+};
+
+#endif // SAMPLESTORE_H
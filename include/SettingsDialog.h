@@ -28,6 +28,26 @@ public:
     ~SettingsDialog();
 
     const QAudioDeviceInfo& outputDevice() const { return m_outputDevice; }
+    bool liveSpectrum() const;
+    void setLiveSpectrum(bool live);
+    bool decimation() const;
+    void setDecimation(bool decimation);
+    bool streaming() const;
+    void setStreaming(bool streaming);
+
+    // Memory budget of the decoded samples, in MB (0 = no limit)
+    int memoryBudget() const;
+    void setMemoryBudget(int megabytes);
+
+    // Index of the transform, in the order of Spectrograph::Transform
+    int transform() const;
+    void setTransform(int transform);
+
+    // Index of the view of the channels, in the order of Spectrograph::ChannelView
+    int channelView() const;
+    void setChannelView(int view);
+    bool midSide() const;
+    void setMidSide(bool midSide);
 
 private slots:
     void outputDeviceChanged(int index);
@@ -36,6 +56,13 @@ private:
     QAudioDeviceInfo m_outputDevice;
 
     QComboBox* m_outputDeviceComboBox;
+    QComboBox* m_transformComboBox;
+    QCheckBox* m_liveSpectrumCheckBox;
+    QCheckBox* m_decimationCheckBox;
+    QCheckBox* m_streamingCheckBox;
+    QSpinBox* m_memoryBudgetSpinBox;
+    QComboBox* m_channelViewComboBox;
+    QCheckBox* m_midSideCheckBox;
 };
 
 #endif // SETTINGSDIALOG_H
@@ -0,0 +1,81 @@
+#ifndef SLIDINGDFT_H
+#define SLIDINGDFT_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*   DFT of the last windowSize() samples of a stream at the bins of a frequency band, updated
+*   sample by sample in O(numBins()) with the modulated sliding DFT: for bin k the sum
+*       A[k] += (x[n] - x[n - N]) * exp(-2*pi*i*k*(n mod N)/N)
+*   runs over the new samples, the twiddles being read from an exact table instead of being
+*   rotated recursively, so the updates are unconditionally stable. The DFT of the window is
+*   A[k] times a phase that only depends on n mod N.
+*
+*   The sums still collect the rounding errors of every update. reset() recomputes them exactly
+*   from the last N samples, which update() does on its own every resetInterval() samples.
+*
+*   Magnitudes are computed with a Hann window applied in the frequency domain, from the bins on
+*   each side of the band, so they are comparable to the ones of an STFT frame of the same size.
+*/
+class SlidingDFT
+{
+public:
+    // Default number of windows between two exact recomputations of the sums
+    static const size_t RESET_WINDOWS = 64;
+
+    /*
+    * Tracks the bins between minFrequency and maxFrequency of a windowSize point DFT.
+    * A resetInterval of 0 means RESET_WINDOWS * windowSize samples.
+    */
+    SlidingDFT(double sampleRate, size_t windowSize, double minFrequency, double maxFrequency,
+               size_t resetInterval = 0);
+
+    double sampleRate() const;
+    size_t windowSize() const;
+    size_t resetInterval() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of the i-th tracked bin.
+    double frequency(size_t i) const;
+
+    // Slides the window over count new samples.
+    void update(const short* samples, size_t count);
+
+    // Recomputes the sums exactly from the samples in the window.
+    void reset();
+
+    // Forgets every sample, as if the stream was silent so far.
+    void clear();
+
+    /*
+    * Writes the numBins() Hann windowed amplitudes of the current window to amplitudes,
+    * relative to a full scale sine wave.
+    */
+    void magnitudes(double* amplitudes) const;
+
+private:
+    double m_sampleRate;
+    size_t m_windowSize;
+    size_t m_resetInterval;
+
+    // exp(-2*pi*i*q/N) = m_cos[q] - i * m_sin[q]
+    std::vector<double> m_cos;
+    std::vector<double> m_sin;
+
+    // Bins of the band with one more on each side for the window, k = m_firstBin + index
+    size_t m_firstBin;
+    size_t m_numBins;
+    std::vector<double> m_real;
+    std::vector<double> m_imag;
+
+    // Last N samples, sample n stored at n mod N, and the position of the next one
+    std::vector<short> m_history;
+    size_t m_position;
+    size_t m_samplesSinceReset;
+
+    // Differences x[n] - x[n - N] of the block being added
+    std::vector<double> m_differences;
+};
+
+#endif // SLIDINGDFT_H
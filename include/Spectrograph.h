@@ -12,6 +12,8 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChart>
 #include <QtCharts/QValueAxis>
+#include <QtCharts/QLogValueAxis>
+#include <QtGui/QImage>
 #include <QBuffer>
 #include <QAudioDecoder>
 
@@ -35,21 +37,109 @@ public:
 	QChart* getChart();
 	QValueAxis* getAxisX();
 	QValueAxis* getAxisY();
+	QLogValueAxis* getLogAxisX();
+
+    // Shows the frequencies on a base 2 logarithmic axis (one octave per major tick), see setTransform()
+    void setLogFrequencyAxis(bool log);
 	QBuffer* getDataBuffer();
+
+    // Samples to analyze without copying them, see FTController::setSampleStore()
+    void setSampleStore(std::shared_ptr<const SampleStore> store, const QAudioFormat format);
 	void cancelCalculation();
 
     void calculateSpectrum(const QAudioFormat format);
 
+    /*
+    * Transform calculateSpectrum() runs on a decoded file: the FFT of the whole file on a linear
+    * axis, its constant-Q spectrum (see FTController::startConstantQ()) on a logarithmic one, or
+    * its spectrogram (see FTController::startSTFT()) drawn as a heat map of time and frequency.
+    * Per-channel views apply to the FFT only.
+    */
+    enum class Transform { FFT, ConstantQ, Spectrogram };
+    Transform transform();
+    void setTransform(Transform transform);
+
+    /*
+    * How the spectrum of a file with several channels is shown: of the channels mixed down to
+    * mono, or one per channel (see FTController::startChannelSpectra()) drawn over each other
+    * or stacked one above the other, the first channel on top.
+    */
+    enum class ChannelView { Mixed, Overlaid, Stacked };
+    ChannelView channelView();
+    void setChannelView(ChannelView view);
+
+    // Shows the mid and side of a stereo file instead of its left and right channels
+    bool isMidSide();
+    void setMidSide(bool midSide);
+
+    // Lowers the sample rate to the displayed band before the transform (see FTController::setDecimation())
+    bool isDecimation();
+    void setDecimation(bool decimation);
+
+    /*
+    * Streaming mode: the spectrum is computed from the chunks of the decoder as they arrive
+    * (see FTController::startStream()) instead of once the whole file has been decoded.
+    */
+    bool isStreaming();
+    void setStreaming(bool streaming);
+    void startStreamingSpectrum(const QAudioFormat format);
+    void appendSpectrumData(const char* data, const qint64 length);
+    void finishStreamingSpectrum();
+
+    /*
+    * Live mode: while playing, the chart shows the spectrum of the sound being played instead
+    * of the one of the whole file (see FTController::startLiveSpectrum()), and its latency in
+    * the title.
+    */
+    bool isLiveSpectrum();
+    void setLiveSpectrum(bool live);
+    void startLiveSpectrum(const QAudioFormat format);
+    void stopLiveSpectrum();
+    void pushPlaybackData(const char* data, const qint64 length, const double outputDelaySeconds);
+
 private slots:
     void plotSpectrumData(const QVector<QPointF> points, const double elapsedSeconds);
 
+    // Only replaces the points, several times a second: the chart is set up by startLiveSpectrum()
+    void plotLiveSpectrum(const QVector<QPointF> points, const double latencySeconds);
+    void plotChannelSpectra(const QVector<QVector<QPointF>> spectra, const QStringList names, const double elapsedSeconds);
+    void plotSpectrogram(const std::shared_ptr<const Spectrogram> spectrogram, const double elapsedSeconds);
+
+    // Stretches the heat map of the spectrogram over the plot area of the chart
+    void updateSpectrogramBackground(const QRectF& plotArea);
+
 private:
 	QChart* m_spectrumChart;
 	QLineSeries* m_spectrumSeries;
 	QChartView* m_spectrumChartView;
 	QValueAxis* m_axisX;
 	QValueAxis* m_axisY;
+	QLogValueAxis* m_logAxisX;
 	FTController* m_FTController;
+	bool m_streaming;
+	bool m_live;
+    Transform m_transform;
+
+    // Title of the chart, the live spectrum adds its latency to it while it runs
+    QString m_title;
+    bool m_livePlotting;
+
+    // One series per channel, created as needed and hidden while the mixed spectrum is shown
+    QVector<QLineSeries*> m_channelSeries;
+    ChannelView m_channelView;
+    bool m_midSide;
+
+    // Heat map of the spectrogram shown, one column per group of frames, null while a spectrum is shown
+    QImage m_spectrogramImage;
+
+    // Horizontal axis currently in the chart, linear or logarithmic
+    QAbstractAxis* frequencyAxis();
+
+    // Puts the frequency and amplitude axes back after a spectrogram
+    void hideSpectrogram();
+
+    // Shows the mixed spectrum series alone, after the spectrogram or the channel spectra
+    void showSpectrumSeries();
 };
 
 #endif // SPECTROGRAPH_H
@@ -0,0 +1,100 @@
+#ifndef STREAMINGWELCHWORKERTHREAD_H
+#define STREAMINGWELCHWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "SampleRingBuffer.h"
+#include "WelchPSD.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+/**
+*   Welch power spectral density of a signal that is still being decoded. The decoder hands
+*   its chunks to appendSamples() and the thread computes each segment of the WelchPSD as soon
+*   as all of its samples have arrived, so the first estimate is ready after the first segment
+*   instead of after the whole file. The running sum of the periodograms is reported through
+*   streamingResultReady() at most every STREAM_UPDATE_INTERVAL_MS, and once more when
+*   endOfStream() has been called and the last segment is done.
+*
+*   The samples wait in a SampleRingBuffer of STREAM_BUFFER_SAMPLES and the worker keeps only
+*   the overlap between two segments. When the worker falls behind and the ring is full,
+*   appendSamples() takes what fits and returns at once: the caller keeps the rest and appends
+*   it again once spaceAvailable() is emitted, so the decoder and the GUI thread never wait
+*   for the worker.
+*/
+class StreamingWelchWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    StreamingWelchWorkerThread();
+    ~StreamingWelchWorkerThread();
+
+    void setWelchPSD(std::shared_ptr<const WelchPSD> welch);
+
+    // Token checked after every segment and while waiting for samples
+    void setCancellationToken(CancellationToken* token);
+
+    /*
+     * Queues decoded samples, called from the GUI thread while the worker runs. Never blocks:
+     * returns how many samples were taken, less than count if the ring is full, in which case
+     * spaceAvailable() is emitted once the worker has consumed some. Once the worker has
+     * stopped, the samples are dropped and count is returned.
+     */
+    size_t appendSamples(const short* samples, size_t count);
+
+    // No more samples will be appended, the worker finishes the last segment and reports.
+    void endOfStream();
+
+    // Wakes up the worker if it is waiting for samples, so it notices a cancellation.
+    void wake();
+
+    void clearData();
+
+signals:
+    void streamingResultReady(const QVector<double> power, const qint64 numSegments, const bool isFinal);
+
+    // The ring has room again after an appendSamples() that did not take all its samples
+    void spaceAvailable();
+
+private:
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const WelchPSD> m_welch;
+
+    // Samples received and not yet consumed, the wait and the flags are protected by m_mutex
+    SampleRingBuffer m_ring;
+    QMutex m_mutex;
+    QWaitCondition m_samplesAvailable;
+    bool m_endOfStream;
+    bool m_stopped;
+
+    // An appendSamples() left samples to the caller, spaceAvailable() is due
+    bool m_appendPending;
+
+    QVector<double> m_power;
+
+    /*
+    * Moves count samples from the ring to samples, waiting for the decoder as needed.
+    * Returns the number of samples read, less than count at the end of the stream or if the
+    * run was cancelled.
+    */
+    size_t readSamples(short* samples, size_t count);
+
+    // Called when run() returns, tells a caller still holding samples that they can be dropped.
+    void stopReceiving();
+
+    bool isCancelled() const;
+};
+
+#endif // STREAMINGWELCHWORKERTHREAD_H
@@ -0,0 +1,58 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+/**
+*   Reader of plain PCM .wav files that bypasses QAudioDecoder: the RIFF chunks are parsed
+*   directly and the "data" chunk is memory-mapped read-only, so the samples are never copied
+*   to the heap. Pages are brought in by the OS as the playback and the transforms touch them.
+*
+*   Supports the PCM (8 bit unsigned, 16 and 32 bit signed), 32 bit IEEE float and
+*   WAVE_FORMAT_EXTENSIBLE variants of those. Everything else (compressed formats, 24 bit,
+*   RF64) is left to QAudioDecoder.
+*
+*   Files of any size are mapped and played in full, the transforms only see the first 2 GB
+*   of them (see FTController::setSampleStore()).
+*
+*   The pointer returned by data() points into the mapping, it must not be used after
+*   close() or once the WavFile is destroyed.
+*/
+class WavFile
+{
+public:
+    WavFile();
+    ~WavFile();
+
+    /*
+     * Parses the header of filePath and maps its samples.
+     * Returns false if the file is not a supported PCM .wav file or could not be mapped.
+     */
+    bool open(const QString& filePath);
+    void close();
+
+    // Format of the samples, as QAudioDecoder would report it.
+    QAudioFormat format() const;
+
+    // The mapped samples and their size in bytes.
+    const char* data() const;
+    qint64 size() const;
+
+private:
+    QFile m_file;
+    uchar* m_data;
+    qint64 m_size;
+    QAudioFormat m_format;
+
+    // Finds the "fmt " and "data" chunks, sets m_format and returns the position and size of the samples.
+    bool readHeader(qint64& dataOffset, qint64& dataSize);
+    bool readFormat(const QByteArray& chunk);
+
+    WavFile(const WavFile&) = delete;
+    WavFile& operator=(const WavFile&) = delete;
+};
+
+#endif // WAVFILE_H
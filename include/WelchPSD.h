@@ -0,0 +1,65 @@
+#ifndef WELCHPSD_H
+#define WELCHPSD_H
+
+#include "FFTPlan.h"
+#include "STFT.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+*   Power spectral density estimate with Welch's method: the signal is cut into overlapping
+*   windowed segments of segmentSize() samples, hopSize() samples apart, and the periodograms
+*   |X[k]|^2 of the segments are averaged. Averaging lowers the variance of the estimate compared
+*   to the periodogram of the whole file, at the cost of a resolution of sampleRate / segmentSize.
+*
+*   The periodograms are only added up, so any range of segments can be summed by any thread
+*   (see WelchWorkerThread) and the partial sums added together before finish() scales them.
+*/
+class WelchPSD
+{
+public:
+    WelchPSD(double sampleRate, size_t segmentSize, size_t hopSize, STFT::Window window);
+
+    double sampleRate() const;
+    size_t segmentSize() const;
+    size_t hopSize() const;
+    STFT::Window window() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    // Number of whole segments in n samples, or 1 (zero padded) if n is shorter than a segment.
+    size_t numSegments(size_t n) const;
+
+    /*
+     * Adds the periodograms of the segments [firstSegment, lastSegment) of the n samples to power,
+     * which holds numBins() values.
+     *
+     * Returns false if the calling thread was interrupted before all segments were done.
+     */
+    bool accumulate(const short* samples, size_t n, size_t firstSegment, size_t lastSegment,
+                    std::vector<double>& power) const;
+
+    /*
+     * Turns the sum of the periodograms of numSegments segments into a one-sided density in
+     * full scale^2 / Hz, in place.
+     */
+    void finish(std::vector<double>& power, size_t numSegments) const;
+
+private:
+    double m_sampleRate;
+    size_t m_segmentSize;
+    size_t m_hopSize;
+    STFT::Window m_window;
+    std::shared_ptr<const FFTPlan> m_plan;
+
+    std::vector<double> m_windowTable;
+
+    // sum(window^2), the power of the window for the density scaling
+    double m_windowPower;
+};
+
+#endif // WELCHPSD_H
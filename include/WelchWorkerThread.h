@@ -0,0 +1,58 @@
+#ifndef WELCHWORKERTHREAD_H
+#define WELCHWORKERTHREAD_H
+
+#include "CancellationToken.h"
+#include "Constants.h"
+#include "WelchPSD.h"
+
+#include <memory>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads estimating a power spectral density with WelchPSD. Each worker sums the
+*   periodograms of its own contiguous range of segments and reports the partial sum through
+*   welchResultReady(). The partial sums are added up in worker order and averaged by
+*   FTController::handleWelchResults(), so the result does not depend on thread timing.
+*/
+class WelchWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    WelchWorkerThread();
+    ~WelchWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+    void setWelchPSD(std::shared_ptr<const WelchPSD> welch);
+
+    // Token polled between segments, the thread's interruption request is honored as well
+    void setCancellationToken(CancellationToken* token);
+
+    void clearData();
+
+signals:
+    void welchResultReady(const QVector<double> power, const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    CancellationToken* m_cancellationToken;
+    std::shared_ptr<const WelchPSD> m_welch;
+    QVector<double> m_power;
+    QAudioFormat m_format;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // WELCHWORKERTHREAD_H
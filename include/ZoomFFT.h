@@ -0,0 +1,85 @@
+#ifndef ZOOMFFT_H
+#define ZOOMFFT_H
+
+#include "FFTPlan.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+*   Band-limited spectrum (zoom FFT) computed with the chirp-z transform. Only numBins
+*   frequencies startFrequency + k * resolution are evaluated, at any resolution, instead
+*   of the full spectrum up to the Nyquist frequency.
+*
+*   The signal is cut into blocks of blockSize() samples. Each block is transformed with
+*   Bluestein's algorithm (a convolution with a chirp, computed with one power of 2 FFT
+*   and one inverse FFT) and shifted by the phase of its position in the signal, so the sum
+*   over all blocks is exactly the spectrum of the whole signal at the requested frequencies.
+*   The cost is O(n log(numBins)) and blocks are independent, so they can be split between
+*   worker threads (see ZoomFFTWorkerThread).
+*/
+class ZoomFFT
+{
+public:
+    ZoomFFT(double sampleRate, double startFrequency, double resolution, size_t numBins);
+
+    double sampleRate() const;
+    double startFrequency() const;
+    double resolution() const;
+    size_t numBins() const;
+
+    // Frequency in Hz of bin k.
+    double frequency(size_t k) const;
+
+    // Number of samples transformed together.
+    size_t blockSize() const;
+
+    // Number of blocks needed to cover n samples.
+    size_t numBlocks(size_t n) const;
+
+    /*
+     * Adds the band spectrum of the blocks [firstBlock, lastBlock) of the n given samples
+     * to real/imag, which must both have numBins() elements.
+     *
+     * Returns false if the calling thread was interrupted before all blocks were processed.
+     */
+    bool accumulate(const short* samples, size_t n, size_t firstBlock, size_t lastBlock,
+                    std::vector<double>& real, std::vector<double>& imag) const;
+
+private:
+    ZoomFFT(const ZoomFFT&) = delete;
+    ZoomFFT& operator=(const ZoomFFT&) = delete;
+
+    // Computes exp(-2*pi*i*f_k*offset/fs), the phase of every bin at sample offset.
+    void blockShift(size_t offset, std::vector<double>& shiftCos, std::vector<double>& shiftSin) const;
+
+    // Returns the fractional part of a phase expressed in cycles, as an angle in radians.
+    static double angle(double cycles);
+
+    double m_sampleRate;
+    double m_startFrequency;
+    double m_resolution;
+    size_t m_numBins;
+    size_t m_blockSize;
+
+    std::shared_ptr<const FFTPlan> m_plan;
+
+    // Chirp applied to the samples of a block: exp(-2*pi*i*(f0*n + df*n^2/2)/fs)
+    std::vector<double> m_chirpCos;
+    std::vector<double> m_chirpSin;
+
+    // Chirp removed from the outputs, exp(-2*pi*i*df*k^2/(2*fs)), and rotation of bin k from
+    // one block to the next, exp(-2*pi*i*f_k*blockSize/fs)
+    std::vector<double> m_outputCos;
+    std::vector<double> m_outputSin;
+    std::vector<double> m_stepCos;
+    std::vector<double> m_stepSin;
+
+    // FFT of the convolution filter exp(2*pi*i*df*m^2/(2*fs)), scaled by 1 / m_plan->size()
+    // so the inverse transform needs no extra pass
+    std::vector<double> m_filterReal;
+    std::vector<double> m_filterImag;
+};
+
+#endif // ZOOMFFT_H
@@ -0,0 +1,54 @@
+#ifndef ZOOMFFTWORKERTHREAD_H
+#define ZOOMFFTWORKERTHREAD_H
+
+#include "Constants.h"
+#include "ZoomFFT.h"
+
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QBuffer>
+#include <QAudioFormat>
+
+/**
+*   One of the threads computing a band-limited spectrum with ZoomFFT. Each worker transforms
+*   its own range of blocks of the signal and reports the (complex) sum of their spectra
+*   through zoomResultReady(). The partial sums are added up by FTController::handleZoomFFTResults().
+*/
+class ZoomFFTWorkerThread : public QThread
+{
+    Q_OBJECT
+
+        void run() override;
+
+public:
+    ZoomFFTWorkerThread();
+    ~ZoomFFTWorkerThread();
+
+    void setAudioFormat(QAudioFormat format);
+    void setWorkerID(int workerID);
+    void setNumWorkers(int numWorkers);
+    int getWorkerID();
+    void setDataBuffer(const QBuffer* dataBuffer);
+    void setZoomFFT(std::shared_ptr<const ZoomFFT> zoomFFT);
+
+    void clearData();
+
+signals:
+    void zoomResultReady(const QVector<double> real, const QVector<double> imag, const int workerID);
+
+private:
+    const QBuffer* m_dataBuffer;
+    std::shared_ptr<const ZoomFFT> m_zoomFFT;
+    QVector<double> m_real;
+    QVector<double> m_imag;
+    QAudioFormat m_format;
+    int m_workerID;
+    int m_numWorkers;
+};
+
+#endif // ZOOMFFTWORKERTHREAD_H
@@ -1,16 +1,19 @@
 #include "AudioFileStream.h"
 
+#include <algorithm>
 #include <iostream>
 
 AudioFileStream::AudioFileStream(Waveform* waveform, Spectrograph* spectrograph, QObject* parent) :
     QIODevice(parent),
+    m_file(new QFile(this)),
+    m_samples(std::make_shared<SampleStore>()),
+    m_playbackPosition(0),
+    m_memoryBudget(qint64(Constants::SAMPLE_MEMORY_BUDGET_MB) * 1024 * 1024),
     m_waveform(waveform),
     m_spectrograph(spectrograph),
-    m_input(&m_data),
-    m_output(&m_data),
+    m_audioOutput(nullptr),
     m_state(State::Stopped),
-    m_peakVal(0),
-    m_file(new QFile(this))
+    m_peakVal(0)
 {
     setOpenMode(QIODevice::ReadOnly);
 
@@ -32,12 +35,6 @@ bool AudioFileStream::init(const QAudioFormat& format)
     connect(&m_decoder, &QAudioDecoder::bufferReady, this, &AudioFileStream::bufferReady);
     connect(&m_decoder, &QAudioDecoder::finished, this, &AudioFileStream::finished);
 
-    // Initialize buffers
-    if (!m_output.open(QIODevice::ReadOnly) || !m_input.open(QIODevice::WriteOnly))
-    {
-        return false;
-    }
-
     m_peakVal = getPeakValue(m_format);
 
     if (m_peakVal == qreal(0))
@@ -46,6 +43,15 @@ bool AudioFileStream::init(const QAudioFormat& format)
         return false;
     }
 
+    // Exception handling, should never get inside catch.
+    try {
+        m_converter.reset(new SampleConverter(m_format));
+    }
+    catch (std::invalid_argument e) {
+        qDebug("AudioFileStream::init() Unsupported sample format, the waveform is not drawn.");
+        m_converter.reset();
+    }
+
     isInited = true;
 
     return true;
@@ -70,6 +76,15 @@ bool AudioFileStream::setFormat(const QAudioFormat& format)
         return false;
     }
 
+    // Exception handling, should never get inside catch.
+    try {
+        m_converter.reset(new SampleConverter(m_format));
+    }
+    catch (std::invalid_argument e) {
+        qDebug("AudioFileStream::setFormat() Unsupported sample format, the waveform is not drawn.");
+        m_converter.reset();
+    }
+
     return true;
 }
 
@@ -88,71 +103,28 @@ AudioFileStream::State AudioFileStream::getState()
     return m_state;
 }
 
+qint64 AudioFileStream::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void AudioFileStream::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+}
+
 void AudioFileStream::drawChartSamples(int start, char* data)
 {
     int sampleCount = m_waveform->getSampleCount();
+    if (!m_converter || start >= sampleCount)
+        return;
 
-    switch (m_format.sampleType())
+    // One point per frame, the channels mixed down to [-1, 1) like the axis
+    m_waveformSamples.resize(sampleCount - start);
+    m_converter->toFloat(data, m_waveformSamples.size(), SampleConverter::MIX, m_waveformSamples.data());
+    for (int s = start; s < sampleCount; ++s)
     {
-    case QAudioFormat::Float:
-    case QAudioFormat::SignedInt:
-        // For 32bit sample size
-        if (m_format.sampleSize() == 32)
-        {
-            int* data_int = (int*)data;
-            for (int s = start; s < sampleCount; ++s, ++data_int)
-            {
-                m_waveformBuffer[s].setY((int)*data_int / m_peakVal);
-            }
-        }
-        // For 16bit sample size
-        else if (m_format.sampleSize() == 16)
-        {
-            short* data_short = (short*)data;
-            for (int s = start; s < sampleCount; ++s, ++data_short)
-            {
-                m_waveformBuffer[s].setY((short)*data_short / m_peakVal);
-            }
-        }
-        // For 8bit sample size
-        else if (m_format.sampleSize() == 8)
-        {
-            for (int s = start; s < sampleCount; ++s, ++data)
-            {
-                m_waveformBuffer[s].setY((char)*data / m_peakVal);
-            }
-        }
-        break;
-    case QAudioFormat::UnSignedInt:
-        // For 32bit sample size
-        if (m_format.sampleSize() == 32)
-        {
-            uint* data_int = (uint*)data;
-            for (int s = start; s < sampleCount; ++s, ++data_int)
-            {
-                m_waveformBuffer[s].setY((uint)*data_int / m_peakVal);
-            }
-        }
-        // For 16bit sample size
-        else if (m_format.sampleSize() == 16)
-        {
-            ushort* data_short = (ushort*)data;
-            for (int s = start; s < sampleCount; ++s, ++data_short)
-            {
-                m_waveformBuffer[s].setY((ushort)*data_short / m_peakVal);
-            }
-        }
-        // For 8bit sample size
-        else if (m_format.sampleSize() == 8)
-        {
-            for (int s = start; s < sampleCount; ++s, ++data)
-            {
-                m_waveformBuffer[s].setY((uchar)*data / m_peakVal);
-            }
-        }
-        break;
-    default:
-        break;
+        m_waveformBuffer[s].setY(m_waveformSamples[s - start]);
     }
 }
 
@@ -161,13 +133,22 @@ qint64 AudioFileStream::readData(char* data, qint64 maxSize)
 {
     memset(data, 0, maxSize);
 
-    // If playing, read audio from m_output, else don't process any data
+    // If playing, read audio from m_samples, else don't process any data
     if (m_state == State::Playing)
     {
         int sampleCount = m_waveform->getSampleCount();
-        int resolution = m_format.sampleSize() / 8;
+        int bytesPerFrame = m_format.bytesPerFrame();
 
-        m_output.read(data, maxSize);
+        const qint64 bytesRead = static_cast<qint64>(m_samples->read(static_cast<size_t>(m_playbackPosition), data, static_cast<size_t>(maxSize)));
+        m_playbackPosition += bytesRead;
+
+        // The live spectrum follows what is sent to the output device, which plays what it
+        // already holds first
+        if (m_spectrograph->isLiveSpectrum() && bytesRead > 0)
+        {
+            const qint64 queuedBytes = m_audioOutput ? m_audioOutput->bufferSize() - m_audioOutput->bytesFree() : 0;
+            m_spectrograph->pushPlaybackData(data, bytesRead, m_format.durationForBytes(std::max<qint64>(0, queuedBytes)) / 1e6);
+        }
 
         if (m_waveformBuffer.isEmpty())
         {
@@ -178,7 +159,7 @@ qint64 AudioFileStream::readData(char* data, qint64 maxSize)
 
         // Draw the available sample points to the chart
         int start = 0;
-        const int availableSamples = int(maxSize) / resolution;
+        const int availableSamples = int(maxSize) / bytesPerFrame;
         if (availableSamples < sampleCount)
         {
             start = sampleCount - availableSamples;
@@ -201,7 +182,7 @@ qint64 AudioFileStream::readData(char* data, qint64 maxSize)
         }
 
         // If at end of file
-        if (m_output.atEnd())
+        if (m_samples->isSealed() && m_playbackPosition >= static_cast<qint64>(m_samples->size()))
         {
             stop();
         }
@@ -223,12 +204,49 @@ bool AudioFileStream::loadFile(const QString& filePath)
     if (m_peakVal == qreal(0) || !clear())
         return false;
 
+    if (loadWavFile(filePath))
+        return true;
+
+    // In streaming mode the spectrum follows the decoder instead of waiting for finished()
+    if (m_spectrograph->isStreaming())
+    {
+        m_spectrograph->startStreamingSpectrum(m_format);
+    }
+
     m_decoder.setSourceFilename(filePath);
     m_decoder.start();
 
     return true;
 }
 
+bool AudioFileStream::loadWavFile(const QString& filePath)
+{
+    if (!filePath.endsWith(".wav", Qt::CaseInsensitive))
+        return false;
+
+    std::shared_ptr<WavFile> wavFile = std::make_shared<WavFile>();
+    if (!wavFile->open(filePath))
+        return false;
+
+    // QAudioDecoder converts to the output format, the mapped samples can only be used as they are
+    if (wavFile->format() != m_format)
+    {
+        qDebug() << "AudioFileStream::loadWavFile() File format " << wavFile->format() << " differs from the output format, decoding instead.";
+        return false;
+    }
+
+    // The playback and the transforms share the mapped samples, nothing is copied. The store
+    // keeps the file mapped for as long as either of them uses it.
+    m_samples = SampleStore::wrap(wavFile->data(), static_cast<size_t>(wavFile->size()), wavFile);
+    m_spectrograph->setSampleStore(m_samples, m_format);
+
+    // All samples are there already, no need to stream them
+    isDecodingFinished = true;
+    m_spectrograph->calculateSpectrum(m_format);
+
+    return true;
+}
+
 // Start playing the audio file
 bool AudioFileStream::play(const QString& filePath)
 {
@@ -245,18 +263,29 @@ bool AudioFileStream::play(const QString& filePath)
 
         m_state = State::Playing;
         emit stateChanged(m_state);
+        startLiveSpectrum();
         return true;
     }
 
     m_state = State::Playing;
     emit stateChanged(m_state);
+    startLiveSpectrum();
 
     return true;
 }
 
+void AudioFileStream::startLiveSpectrum()
+{
+    if (m_spectrograph->isLiveSpectrum())
+    {
+        m_spectrograph->startLiveSpectrum(m_format);
+    }
+}
+
 // Pause the currently playing audio file
 void AudioFileStream::pause()
 {
+    m_spectrograph->stopLiveSpectrum();
     m_state = State::Paused;
     emit stateChanged(m_state);
 }
@@ -264,6 +293,7 @@ void AudioFileStream::pause()
 // Stop playing audio file
 void AudioFileStream::stop()
 {
+    m_spectrograph->stopLiveSpectrum();
     m_file->close();
     clear();
     m_state = State::Stopped;
@@ -273,17 +303,13 @@ void AudioFileStream::stop()
 bool AudioFileStream::clear()
 {
     m_decoder.stop();
-    m_data.clear();
     m_waveformBuffer.clear();
     m_waveform->getSeries()->clear();
 
-    m_output.close();
-    m_input.close();
-
-    if (!m_output.open(QIODevice::ReadOnly) || !m_input.open(QIODevice::WriteOnly))
-    {
-        return false;
-    }
+    // The transforms may still hold the previous samples, they are freed with the last reference
+    m_samples = std::make_shared<SampleStore>();
+    m_samples->setMemoryBudget(static_cast<size_t>(m_memoryBudget));
+    m_playbackPosition = 0;
 
     isDecodingFinished = false;
 
@@ -293,8 +319,8 @@ bool AudioFileStream::clear()
 // Determines if reached the end of audio file
 bool AudioFileStream::atEnd() const
 {
-    return m_output.size()
-        && m_output.atEnd()
+    return m_samples->size()
+        && m_playbackPosition >= static_cast<qint64>(m_samples->size())
         && isDecodingFinished;
 }
 
@@ -308,8 +334,19 @@ void AudioFileStream::bufferReady() // SLOT
     const int length = buffer.byteCount();
     const char* data = buffer.constData<char>();
 
-    m_input.write(data, length);
-    m_spectrograph->getDataBuffer()->write(data, length);
+    // The whole file usually fits the first chunk, sized from the duration (plus a second for its rounding)
+    if (m_samples->size() == 0 && m_decoder.duration() > 0)
+    {
+        m_samples->reserve(static_cast<size_t>(m_format.bytesForDuration((m_decoder.duration() + 1000) * 1000)));
+    }
+
+    // Stored once, the playback and the transforms read the same samples
+    m_samples->append(data, static_cast<size_t>(length));
+
+    if (m_spectrograph->isStreaming())
+    {
+        m_spectrograph->appendSpectrumData(data, length);
+    }
 }
 
 // Runs when decoder finished decoding
@@ -317,9 +354,20 @@ void AudioFileStream::finished() // SLOT
 {
     isDecodingFinished = true;
 
+    m_samples->seal();
+
     // When audio decoding is finished we can start calculating and plotting the
-    // DFT graph on a new thread.
-    m_spectrograph->calculateSpectrum(m_format);
+    // DFT graph on a new thread. In streaming mode it is already running and only
+    // needs the last segment, the samples themselves are only kept for the playback.
+    if (m_spectrograph->isStreaming())
+    {
+        m_spectrograph->finishStreamingSpectrum();
+    }
+    else
+    {
+        m_spectrograph->setSampleStore(m_samples, m_format);
+        m_spectrograph->calculateSpectrum(m_format);
+    }
 }
 
 void AudioFileStream::cancelSpectrum()
@@ -327,6 +375,11 @@ void AudioFileStream::cancelSpectrum()
     m_spectrograph->cancelCalculation();
 }
 
+void AudioFileStream::setAudioOutput(QAudioOutput* output)
+{
+    m_audioOutput = output;
+}
+
 qreal AudioFileStream::getPeakValue(const QAudioFormat& format)
 {
     // Note: Only the most common sample formats are supported
@@ -0,0 +1,75 @@
+#define _USE_MATH_DEFINES
+
+#include "BinDFT.h"
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+BinDFT::BinDFT(double sampleRate, const std::vector<double>& frequencies)
+    : m_sampleRate(sampleRate)
+    , m_frequencies(frequencies)
+{
+    if (sampleRate <= 0.0 || frequencies.empty())
+    {
+        throw std::invalid_argument("BinDFT::BinDFT() Invalid sample rate or frequencies");
+    }
+
+    m_stepCos.resize(m_frequencies.size());
+    m_stepSin.resize(m_frequencies.size());
+    phasors(1, 0, m_frequencies.size(), m_stepCos.data(), m_stepSin.data());
+}
+
+double BinDFT::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t BinDFT::numBins() const
+{
+    return m_frequencies.size();
+}
+
+double BinDFT::frequency(size_t k) const
+{
+    return m_frequencies[k];
+}
+
+void BinDFT::phasors(size_t n, size_t firstBin, size_t lastBin, double* phasorReal, double* phasorImag) const
+{
+    for (size_t k = firstBin; k < lastBin; k++)
+    {
+        // Only the fractional number of cycles matters, keep the angle small for accuracy
+        const double cycles = m_frequencies[k] * static_cast<double>(n) / m_sampleRate;
+        const double a = 2 * M_PI * (cycles - std::floor(cycles));
+        phasorReal[k - firstBin] = std::cos(a);
+        phasorImag[k - firstBin] = -std::sin(a);
+    }
+}
+
+void BinDFT::accumulate(const short* samples, size_t first, size_t last, size_t firstBin, size_t lastBin,
+                        std::vector<double>& real, std::vector<double>& imag) const
+{
+    if (real.size() != numBins() || imag.size() != numBins() || firstBin > lastBin || lastBin > numBins())
+    {
+        throw std::invalid_argument("BinDFT::accumulate() Size mismatch for output vectors");
+    }
+
+    const size_t count = lastBin - firstBin;
+    if (count == 0)
+        return;
+
+    std::vector<double> phasorReal(count);
+    std::vector<double> phasorImag(count);
+
+    for (size_t blockStart = first; blockStart < last; blockStart += PHASOR_RESYNC_INTERVAL)
+    {
+        const size_t blockEnd = std::min(last, blockStart + PHASOR_RESYNC_INTERVAL);
+        phasors(blockStart, firstBin, lastBin, phasorReal.data(), phasorImag.data());
+
+        FFTKernels::phasorDFT(samples + blockStart, blockEnd - blockStart, phasorReal.data(), phasorImag.data(),
+                              m_stepCos.data() + firstBin, m_stepSin.data() + firstBin,
+                              real.data() + firstBin, imag.data() + firstBin, count);
+    }
+}
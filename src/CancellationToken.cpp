@@ -0,0 +1,121 @@
+#include "CancellationToken.h"
+#include "Constants.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QtCore/QThread>
+
+// Largest block, keeps the doubling of fast blocks from overflowing
+static const size_t MAX_BLOCK_SIZE = std::numeric_limits<size_t>::max() / 4;
+
+CancellationToken::CancellationToken(std::chrono::milliseconds latencyBudget)
+    : m_cancelled(false)
+    , m_latencyBudgetMs(latencyBudget.count())
+    , m_cancelTime(0)
+    , m_slowestAcknowledgement(0)
+{
+
+}
+
+std::chrono::milliseconds CancellationToken::latencyBudget() const
+{
+    return std::chrono::milliseconds(m_latencyBudgetMs.load(std::memory_order_relaxed));
+}
+
+void CancellationToken::setLatencyBudget(std::chrono::milliseconds latencyBudget)
+{
+    m_latencyBudgetMs.store(std::max<long long>(1, latencyBudget.count()), std::memory_order_relaxed);
+}
+
+void CancellationToken::cancel()
+{
+    // The time is stored before the flag, so a worker seeing the flag also sees the time
+    Clock::rep expected = 0;
+    m_cancelTime.compare_exchange_strong(expected, Clock::now().time_since_epoch().count());
+    m_cancelled.store(true, std::memory_order_release);
+}
+
+void CancellationToken::reset()
+{
+    m_cancelled.store(false, std::memory_order_release);
+    m_cancelTime = 0;
+    m_slowestAcknowledgement = 0;
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return m_cancelled.load(std::memory_order_acquire);
+}
+
+void CancellationToken::acknowledge()
+{
+    const Clock::rep cancelTime = m_cancelTime;
+    if (cancelTime == 0)
+        return;
+
+    const Clock::rep elapsed = Clock::now().time_since_epoch().count() - cancelTime;
+    Clock::rep slowest = m_slowestAcknowledgement;
+    while (elapsed > slowest && !m_slowestAcknowledgement.compare_exchange_weak(slowest, elapsed))
+    {
+    }
+}
+
+double CancellationToken::secondsSinceCancel() const
+{
+    const Clock::rep cancelTime = m_cancelTime;
+    if (cancelTime == 0)
+        return 0.0;
+
+    const Clock::duration elapsed(Clock::now().time_since_epoch().count() - cancelTime);
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+double CancellationToken::slowestAcknowledgement() const
+{
+    return std::chrono::duration<double>(Clock::duration(m_slowestAcknowledgement.load())).count();
+}
+
+CancellationCheckpoint::CancellationCheckpoint(CancellationToken* token, QThread* thread, size_t initialBlockSize)
+    : m_token(token)
+    , m_thread(thread)
+    , m_blockSize(std::max<size_t>(1, initialBlockSize))
+    , m_blockStart(Clock::now())
+{
+
+}
+
+size_t CancellationCheckpoint::blockSize() const
+{
+    return m_blockSize;
+}
+
+bool CancellationCheckpoint::reached()
+{
+    if ((m_token && m_token->isCancelled()) || (m_thread && m_thread->isInterruptionRequested()))
+    {
+        if (m_token)
+            m_token->acknowledge();
+        return true;
+    }
+
+    // Aim for a quarter of the budget per block, leaving room for the work after the last check
+    const Clock::time_point now = Clock::now();
+    const Clock::duration elapsed = now - m_blockStart;
+    const std::chrono::milliseconds budget = m_token ? m_token->latencyBudget()
+                                                     : std::chrono::milliseconds(Constants::CANCEL_LATENCY_BUDGET_MS);
+    const Clock::duration target = budget / 4;
+    m_blockStart = now;
+
+    if (elapsed > target)
+    {
+        const double ratio = std::chrono::duration<double>(target) / std::chrono::duration<double>(elapsed);
+        m_blockSize = std::max<size_t>(1, static_cast<size_t>(m_blockSize * ratio));
+    }
+    else if (2 * elapsed < target && m_blockSize < MAX_BLOCK_SIZE)
+    {
+        m_blockSize *= 2;
+    }
+
+    return false;
+}
@@ -0,0 +1,109 @@
+#include "ChannelWelchWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+ChannelWelchWorkerThread::ChannelWelchWorkerThread()
+    : m_cancellationToken(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+ChannelWelchWorkerThread::~ChannelWelchWorkerThread()
+{
+
+}
+
+int ChannelWelchWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void ChannelWelchWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void ChannelWelchWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void ChannelWelchWorkerThread::setWelchPSD(std::shared_ptr<const WelchPSD> welch)
+{
+    m_welch = welch;
+}
+
+void ChannelWelchWorkerThread::setChannels(std::shared_ptr<const std::vector<std::vector<short>>> channels)
+{
+    m_channels = channels;
+}
+
+void ChannelWelchWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void ChannelWelchWorkerThread::clearData()
+{
+    m_power.clear();
+}
+
+void ChannelWelchWorkerThread::run()
+{
+    clearData();
+
+    if (!m_welch || !m_channels || m_channels->empty() || m_channels->front().empty())
+    {
+        return;
+    }
+
+    const size_t numChannels = m_channels->size();
+    const size_t N = m_channels->front().size();
+    const size_t numBins = m_welch->numBins();
+
+    // range of (channel, segment) items for current worker, the segments of channel c being
+    // the items [c * numSegments, (c + 1) * numSegments)
+    const size_t numSegments = m_welch->numSegments(N);
+    const size_t numItems = numChannels * numSegments;
+    const size_t itemStart = (m_workerID * numItems) / m_numWorkers;
+    const size_t itemEnd = ((m_workerID + 1) * numItems) / m_numWorkers;
+
+    m_power.fill(0.0, static_cast<int>(numChannels * numBins));
+    std::vector<double> power(numBins);
+
+    // Cancellation is only checked between batches of segments, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, 1);
+
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t c = itemStart / numSegments; c < numChannels && c * numSegments < itemEnd; c++)
+        {
+            const short* samples = (*m_channels)[c].data();
+            const size_t segmentStart = std::max(itemStart, c * numSegments) - c * numSegments;
+            const size_t segmentEnd = std::min(itemEnd, (c + 1) * numSegments) - c * numSegments;
+
+            std::fill(power.begin(), power.end(), 0.0);
+            for (size_t first = segmentStart; first < segmentEnd; )
+            {
+                const size_t last = first + std::min(segmentEnd - first, checkpoint.blockSize());
+                if (!m_welch->accumulate(samples, N, first, last, power) || checkpoint.reached())
+                {
+                    clearData();
+                    return;
+                }
+                first = last;
+            }
+
+            std::copy(power.begin(), power.end(), m_power.begin() + static_cast<int>(c * numBins));
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vector, aborting ChannelWelchWorkerThread::run()";
+        return;
+    }
+
+    emit channelWelchResultReady(m_power, m_workerID);
+}
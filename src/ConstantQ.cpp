@@ -0,0 +1,208 @@
+#define _USE_MATH_DEFINES
+
+#include "ConstantQ.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Kernel values below this fraction of the largest one of their bin are dropped
+static const double KERNEL_THRESHOLD = 0.0054;
+
+ConstantQ::ConstantQ(double sampleRate, double minFrequency, double maxFrequency, int binsPerOctave)
+    : m_sampleRate(sampleRate)
+    , m_minFrequency(minFrequency)
+    , m_binsPerOctave(binsPerOctave)
+    , m_numBins(0)
+    , m_q(0.0)
+    , m_fftSize(0)
+    , m_hopSize(0)
+{
+    if (sampleRate <= 0.0 || minFrequency <= 0.0 || maxFrequency < minFrequency
+        || maxFrequency >= sampleRate / 2 || binsPerOctave <= 0)
+    {
+        throw std::invalid_argument("ConstantQ::ConstantQ() Invalid band or bins per octave");
+    }
+
+    m_numBins = static_cast<size_t>(std::floor(binsPerOctave * std::log2(maxFrequency / minFrequency))) + 1;
+    m_q = 1.0 / (std::pow(2.0, 1.0 / binsPerOctave) - 1.0);
+
+    // The lowest bin has the longest window
+    const size_t longestWindow = static_cast<size_t>(std::ceil(m_q * sampleRate / minFrequency));
+    m_fftSize = 1;
+    while (m_fftSize < longestWindow)
+    {
+        m_fftSize <<= 1;
+    }
+    m_hopSize = m_fftSize / 4;
+    m_plan = FFTPlan::forSize(m_fftSize);
+
+    buildKernel();
+}
+
+double ConstantQ::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int ConstantQ::binsPerOctave() const
+{
+    return m_binsPerOctave;
+}
+
+size_t ConstantQ::numBins() const
+{
+    return m_numBins;
+}
+
+double ConstantQ::q() const
+{
+    return m_q;
+}
+
+double ConstantQ::frequency(size_t k) const
+{
+    return m_minFrequency * std::pow(2.0, static_cast<double>(k) / m_binsPerOctave);
+}
+
+size_t ConstantQ::fftSize() const
+{
+    return m_fftSize;
+}
+
+size_t ConstantQ::hopSize() const
+{
+    return m_hopSize;
+}
+
+size_t ConstantQ::kernelSize() const
+{
+    return m_kernelBin.size();
+}
+
+size_t ConstantQ::numFrames(size_t n) const
+{
+    if (n <= m_fftSize)
+        return n > 0 ? 1 : 0;
+
+    return 1 + (n - m_fftSize + m_hopSize - 1) / m_hopSize;
+}
+
+void ConstantQ::buildKernel()
+{
+    const size_t N = m_fftSize;
+    const size_t halfBins = N / 2 + 1;
+    std::vector<double> real;
+    std::vector<double> imag;
+
+    m_kernelStart.assign(1, 0);
+    for (size_t k = 0; k < m_numBins; k++)
+    {
+        // Hann windowed exponential of Q periods at the bin frequency, centered in the frame and
+        // normalized so that a full scale sine at that frequency gives 1/2
+        const double f = frequency(k);
+        const size_t length = std::min(N, static_cast<size_t>(std::ceil(m_q * m_sampleRate / f)));
+        const size_t offset = (N - length) / 2;
+
+        real.assign(N, 0.0);
+        imag.assign(N, 0.0);
+        double windowSum = 0.0;
+        for (size_t i = 0; i < length; i++)
+        {
+            windowSum += 0.5 - 0.5 * std::cos(2 * M_PI * i / length);
+        }
+        for (size_t i = 0; i < length; i++)
+        {
+            const double w = (0.5 - 0.5 * std::cos(2 * M_PI * i / length)) / windowSum;
+            const double a = 2 * M_PI * f * (offset + i) / m_sampleRate;
+            real[offset + i] = w * std::cos(a);
+            imag[offset + i] = w * std::sin(a);
+        }
+
+        if (!m_plan->transform(real, imag))
+        {
+            throw std::invalid_argument("ConstantQ::buildKernel() Kernel transform was interrupted");
+        }
+
+        // Parseval: sum x[n] * conj(t[n]) = sum X[j] * conj(T[j]) / N. The kernel lives in the
+        // positive frequencies, which are all a real FFT returns.
+        double peak = 0.0;
+        for (size_t j = 0; j < halfBins; j++)
+        {
+            peak = std::max(peak, std::hypot(real[j], imag[j]));
+        }
+        for (size_t j = 0; j < halfBins; j++)
+        {
+            if (std::hypot(real[j], imag[j]) >= KERNEL_THRESHOLD * peak)
+            {
+                m_kernelBin.push_back(j);
+                m_kernelReal.push_back(real[j] / N);
+                m_kernelImag.push_back(-imag[j] / N);
+            }
+        }
+        m_kernelStart.push_back(m_kernelBin.size());
+    }
+}
+
+bool ConstantQ::accumulate(const short* samples, size_t n, size_t firstFrame, size_t lastFrame,
+                           std::vector<double>& amplitudeSums) const
+{
+    if (amplitudeSums.size() != m_numBins)
+    {
+        throw std::invalid_argument("ConstantQ::accumulate() Size mismatch for output vector");
+    }
+
+    // The frames are copied into a block and transformed together, in buffers each thread
+    // keeps for its next call
+    const size_t halfBins = m_fftSize / 2 + 1;
+    const size_t maxBatch = FFTPlan::MAX_BATCH_FRAMES;
+    const size_t blockSize = std::min(maxBatch, lastFrame - firstFrame);
+    thread_local std::vector<double> frames;
+    thread_local std::vector<double> spectraReal;
+    thread_local std::vector<double> spectraImag;
+    if (frames.size() < blockSize * m_fftSize)
+        frames.resize(blockSize * m_fftSize);
+    if (spectraReal.size() < blockSize * halfBins)
+    {
+        spectraReal.resize(blockSize * halfBins);
+        spectraImag.resize(blockSize * halfBins);
+    }
+
+    for (size_t blockStart = firstFrame; blockStart < lastFrame; blockStart += FFTPlan::MAX_BATCH_FRAMES)
+    {
+        const size_t blockEnd = std::min(lastFrame, blockStart + FFTPlan::MAX_BATCH_FRAMES);
+        for (size_t f = blockStart; f < blockEnd; f++)
+        {
+            const size_t start = f * m_hopSize;
+            const size_t count = start < n ? std::min(m_fftSize, n - start) : 0;
+
+            double* frame = frames.data() + (f - blockStart) * m_fftSize;
+            std::copy(samples + start, samples + start + count, frame);
+            std::fill(frame + count, frame + m_fftSize, 0.0);
+        }
+
+        if (!m_plan->transformRealBatch(frames.data(), blockEnd - blockStart, m_fftSize,
+                                        spectraReal.data(), spectraImag.data(), halfBins))
+            return false;
+
+        for (size_t f = blockStart; f < blockEnd; f++)
+        {
+            const double* real = spectraReal.data() + (f - blockStart) * halfBins;
+            const double* imag = spectraImag.data() + (f - blockStart) * halfBins;
+            for (size_t k = 0; k < m_numBins; k++)
+            {
+                double sumReal = 0.0;
+                double sumImag = 0.0;
+                for (size_t e = m_kernelStart[k]; e < m_kernelStart[k + 1]; e++)
+                {
+                    const size_t j = m_kernelBin[e];
+                    sumReal += real[j] * m_kernelReal[e] - imag[j] * m_kernelImag[e];
+                    sumImag += real[j] * m_kernelImag[e] + imag[j] * m_kernelReal[e];
+                }
+                amplitudeSums[k] += 2.0 * std::sqrt(sumReal * sumReal + sumImag * sumImag) / 32767.0;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,109 @@
+#include "ConstantQWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+ConstantQWorkerThread::ConstantQWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+ConstantQWorkerThread::~ConstantQWorkerThread()
+{
+
+}
+
+int ConstantQWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void ConstantQWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void ConstantQWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void ConstantQWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void ConstantQWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void ConstantQWorkerThread::setConstantQ(std::shared_ptr<const ConstantQ> constantQ)
+{
+    m_constantQ = constantQ;
+}
+
+void ConstantQWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void ConstantQWorkerThread::clearData()
+{
+    m_amplitudeSums.clear();
+}
+
+void ConstantQWorkerThread::run()
+{
+    clearData();
+
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_constantQ)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    // range of frames for current worker
+    const size_t numFrames = m_constantQ->numFrames(N);
+    const size_t frameStart = (m_workerID * numFrames) / m_numWorkers;
+    const size_t frameEnd = ((m_workerID + 1) * numFrames) / m_numWorkers;
+
+    std::vector<double> amplitudeSums(m_constantQ->numBins(), 0.0);
+
+    // Cancellation is only checked between batches of frames, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, 1);
+
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t first = frameStart; first < frameEnd; )
+        {
+            const size_t last = first + std::min(frameEnd - first, checkpoint.blockSize());
+            if (!m_constantQ->accumulate(data_short, N, first, last, amplitudeSums) || checkpoint.reached())
+            {
+                clearData();
+                return;
+            }
+            first = last;
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vector, aborting ConstantQWorkerThread::run()";
+        return;
+    }
+
+    m_amplitudeSums.resize(static_cast<int>(amplitudeSums.size()));
+    std::copy(amplitudeSums.begin(), amplitudeSums.end(), m_amplitudeSums.begin());
+
+    emit constantQResultReady(m_amplitudeSums, m_workerID);
+}
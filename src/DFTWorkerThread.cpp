@@ -1,8 +1,10 @@
 #include "DFTWorkerThread.h"
-#include <math.h>
+#include <algorithm>
+#include <stdexcept>
 
 DFTWorkerThread::DFTWorkerThread()
     : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
 {
     qRegisterMetaType<QVector<QPointF>>("QVector<QPointF>");
 }
@@ -17,6 +19,16 @@ void DFTWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
     m_dataBuffer = dataBuffer;
 }
 
+void DFTWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void DFTWorkerThread::setBinDFT(std::shared_ptr<const BinDFT> binDFT)
+{
+    m_binDFT = binDFT;
+}
+
 void DFTWorkerThread::setAudioFormat(QAudioFormat format)
 {
     m_format = format;
@@ -34,70 +46,56 @@ void DFTWorkerThread::run()
     // Calculate number of samples
     const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
 
-    if (N == 0)
+    if (N == 0 || !m_binDFT)
     {
         return;
     }
 
     //qDebug() << "DFTWorkerThread::run() Number of samples received: " << N;
 
-    // Get raw data and define K
+    // Get raw data
     const char* data = m_dataBuffer->buffer().constData();
     short* data_short = (short*)data;
-    const int K = Constants::MAX_FREQUENCY;
-
-    m_spectrumBuffer.reserve(K - Constants::MIN_FREQUENCY);
-
-    double maxSum = 0.0;
-    std::complex<double> currentSum;
-
-    std::vector<std::pair<ulong, std::complex<double>>> output;
-    output.reserve(N);
 
-    const ulong samplesPerSec = m_format.bytesForDuration(1e6) / (m_format.sampleSize() / 8);
+    const size_t numBins = m_binDFT->numBins();
+    std::vector<double> real(numBins, 0.0);
+    std::vector<double> imag(numBins, 0.0);
 
-    // Loop through each k
-    for (ulong k = 0; k < N; ++k)
-    {
-        currentSum = std::complex<double>(0, 0);
+    // Cancellation is only checked between blocks of samples, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this);
 
-        // Loop through each sample n
-        for (ulong n = 0; n < N; ++n)
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t first = 0; first < N; )
         {
-            if (isInterruptionRequested())
+            const size_t last = first + std::min<size_t>(N - first, checkpoint.blockSize());
+            m_binDFT->accumulate(data_short, first, last, 0, numBins, real, imag);
+            first = last;
+
+            if (checkpoint.reached())
             {
                 clearData();
                 return;
             }
-
-            double xn = data_short[n];
-            double real = std::cos(((2 * M_PI) / samplesPerSec) * k * n);
-            double imag = std::sin(((2 * M_PI) / samplesPerSec) * k * n);
-            std::complex<double> w (real, -imag);
-            currentSum += xn * w;
         }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vectors, aborting DFTWorkerThread::run()";
+        return;
+    }
 
-        double mag = std::abs(currentSum);
-
-        // Keep track of largest y-value seen so far
-        if (mag > maxSum)
-            maxSum = mag;
-
-        // Add point to output buffer
-        output.push_back(std::make_pair(k, currentSum));
+    // Normalize by the largest amplitude in the band
+    std::vector<double> amplitude(numBins);
+    const double maxSum = FFTKernels::magnitude(real.data(), imag.data(), amplitude.data(), numBins);
+    if (maxSum > 0.0)
+    {
+        FFTKernels::scale(amplitude.data(), 1.0 / maxSum, numBins);
     }
 
-    // Normalize y values
-    for (size_t i = 0; i < (output.size() / 2); ++i)
+    m_spectrumBuffer.reserve(static_cast<int>(numBins));
+    for (size_t k = 0; k < numBins; ++k)
     {
-        // Only plot the frequencies we're interested in
-        if (output[i].first > Constants::MAX_FREQUENCY)
-            break;
-        else if (output[i].first < Constants::MIN_FREQUENCY)
-            continue;
-
-        double abs = std::abs(output[i].second) / maxSum;
-        QPointF point(output[i].first, abs);
+        QPointF point(m_binDFT->frequency(k), amplitude[k]);
         m_spectrumBuffer.append(point);
     }
 
@@ -0,0 +1,245 @@
+#define _USE_MATH_DEFINES
+
+#include "Decimator.h"
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Modified Bessel function of the first kind I0, for the Kaiser window
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+Decimator::Decimator(int sampleRate, double maxFrequency)
+    : m_inputRate(sampleRate)
+    , m_outputRate(sampleRate)
+    , m_maxFrequency(maxFrequency)
+    , m_factor(1)
+{
+    if (sampleRate <= 0 || maxFrequency <= 0.0 || 2.0 * maxFrequency >= sampleRate)
+    {
+        throw std::invalid_argument("Decimator::Decimator() Invalid sample rate or band");
+    }
+
+    // Largest divisor of the sample rate that keeps enough samples per second for the band
+    const double minRate = maxFrequency * MIN_OVERSAMPLING_PERCENT / 100.0;
+    for (size_t d = static_cast<size_t>(sampleRate / minRate); d > 1; d--)
+    {
+        if (sampleRate % d == 0)
+        {
+            m_factor = d;
+            break;
+        }
+    }
+    m_outputRate = static_cast<int>(sampleRate / m_factor);
+
+    // Prime factors, largest first, grouped into stages of at most MAX_STAGE_FACTOR
+    std::vector<size_t> primes;
+    size_t rest = m_factor;
+    for (size_t p = 2; p <= rest; p++)
+    {
+        while (rest % p == 0)
+        {
+            primes.push_back(p);
+            rest /= p;
+        }
+    }
+    std::sort(primes.rbegin(), primes.rend());
+
+    std::vector<size_t> factors;
+    for (size_t i = 0; i < primes.size(); i++)
+    {
+        if (!factors.empty() && factors.back() * primes[i] <= MAX_STAGE_FACTOR)
+            factors.back() *= primes[i];
+        else
+            factors.push_back(primes[i]);
+    }
+
+    double rate = sampleRate;
+    for (size_t s = 0; s < factors.size(); s++)
+    {
+        Stage stage;
+        stage.factor = factors[s];
+        stage.taps = designLowpass(rate, factors[s], maxFrequency);
+        m_stages.push_back(stage);
+        rate /= factors[s];
+    }
+}
+
+int Decimator::inputRate() const
+{
+    return m_inputRate;
+}
+
+int Decimator::outputRate() const
+{
+    return m_outputRate;
+}
+
+double Decimator::maxFrequency() const
+{
+    return m_maxFrequency;
+}
+
+size_t Decimator::factor() const
+{
+    return m_factor;
+}
+
+size_t Decimator::numStages() const
+{
+    return m_stages.size();
+}
+
+size_t Decimator::stageFactor(size_t stage) const
+{
+    return m_stages[stage].factor;
+}
+
+size_t Decimator::stageNumTaps(size_t stage) const
+{
+    return m_stages[stage].taps.size();
+}
+
+size_t Decimator::stageInputSize(size_t stage, size_t n) const
+{
+    for (size_t s = 0; s < stage; s++)
+    {
+        n = (n + m_stages[s].factor - 1) / m_stages[s].factor;
+    }
+
+    return n;
+}
+
+size_t Decimator::numOutputs(size_t n) const
+{
+    return stageInputSize(m_stages.size(), n);
+}
+
+std::vector<double> Decimator::designLowpass(double inputRate, size_t factor, double maxFrequency)
+{
+    // Everything above outputRate - maxFrequency would alias into the band once decimated
+    const double outputRate = inputRate / factor;
+    const double stopFrequency = outputRate - maxFrequency;
+    const double cutoff = 0.5 * (maxFrequency + stopFrequency) / inputRate;
+    const double transition = (stopFrequency - maxFrequency) / inputRate;
+
+    // Kaiser's estimates of the length and shape for the attenuation, odd so the center is a sample
+    const double attenuation = STOPBAND_ATTENUATION_DB;
+    const double beta = 0.1102 * (attenuation - 8.7);
+    size_t numTaps = static_cast<size_t>(std::ceil((attenuation - 7.95) / (14.36 * transition))) + 1;
+    numTaps |= 1;
+
+    std::vector<double> taps(numTaps);
+    const double center = 0.5 * (numTaps - 1);
+    const double i0Beta = besselI0(beta);
+    double sum = 0.0;
+    for (size_t t = 0; t < numTaps; t++)
+    {
+        const double x = t - center;
+        const double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2 * M_PI * cutoff * x) / (M_PI * x);
+        const double r = x / center;
+        taps[t] = sinc * besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+        sum += taps[t];
+    }
+
+    // Unit gain at 0 Hz, so amplitudes in the band are kept
+    for (size_t t = 0; t < numTaps; t++)
+    {
+        taps[t] /= sum;
+    }
+
+    return taps;
+}
+
+void Decimator::process(const short* samples, size_t n, size_t firstOutput, size_t lastOutput, short* output) const
+{
+    lastOutput = std::min(lastOutput, numOutputs(n));
+    if (firstOutput >= lastOutput)
+        return;
+
+    const size_t numStages = m_stages.size();
+    if (numStages == 0)
+    {
+        std::copy(samples + firstOutput, samples + lastOutput, output);
+        return;
+    }
+
+    // Work backwards from the requested outputs to the range each stage needs from the one
+    // before, clipped to the signal: first[s] and last[s] are outputs of stage s
+    std::vector<long long> first(numStages + 1);
+    std::vector<long long> last(numStages + 1);
+    first[numStages] = static_cast<long long>(firstOutput);
+    last[numStages] = static_cast<long long>(lastOutput);
+    for (size_t s = numStages; s-- > 0; )
+    {
+        const long long factor = static_cast<long long>(m_stages[s].factor);
+        const long long numTaps = static_cast<long long>(m_stages[s].taps.size());
+        const long long center = (numTaps - 1) / 2;
+        const long long inputSize = static_cast<long long>(stageInputSize(s, n));
+        first[s] = std::max(0LL, first[s + 1] * factor - center);
+        last[s] = std::min(inputSize, (last[s + 1] - 1) * factor - center + numTaps);
+    }
+
+    std::vector<double> input(samples + first[0], samples + last[0]);
+    std::vector<double> stageOutput;
+
+    for (size_t s = 0; s < numStages; s++)
+    {
+        const Stage& stage = m_stages[s];
+        const long long factor = static_cast<long long>(stage.factor);
+        const long long numTaps = static_cast<long long>(stage.taps.size());
+        const long long center = (numTaps - 1) / 2;
+        const long long inputFirst = first[s];
+        const long long inputLast = last[s];
+
+        stageOutput.assign(static_cast<size_t>(last[s + 1] - first[s + 1]), 0.0);
+
+        // Outputs whose taps all fall inside the signal go through the vector kernel in one
+        // run, the few at the ends of the signal skip the missing samples
+        long long fullFirst = (inputFirst + center + factor - 1) / factor;
+        long long fullLast = inputLast + center >= numTaps ? (inputLast + center - numTaps) / factor + 1 : 0;
+        fullFirst = std::max(fullFirst, first[s + 1]);
+        fullLast = std::max(fullFirst, std::min(fullLast, last[s + 1]));
+
+        for (long long m = first[s + 1]; m < last[s + 1]; m++)
+        {
+            if (m == fullFirst && fullLast > fullFirst)
+            {
+                FFTKernels::firDecimate(input.data() + (m * factor - center - inputFirst), static_cast<size_t>(fullLast - fullFirst),
+                                        stage.factor, stage.taps.data(), stage.taps.size(),
+                                        stageOutput.data() + (m - first[s + 1]));
+                m = fullLast - 1;
+                continue;
+            }
+
+            double sum = 0.0;
+            for (long long t = 0; t < numTaps; t++)
+            {
+                const long long j = m * factor - center + t;
+                if (j >= inputFirst && j < inputLast)
+                    sum += stage.taps[static_cast<size_t>(t)] * input[static_cast<size_t>(j - inputFirst)];
+            }
+            stageOutput[static_cast<size_t>(m - first[s + 1])] = sum;
+        }
+
+        input.swap(stageOutput);
+    }
+
+    for (size_t m = 0; m < input.size(); m++)
+    {
+        const double value = std::floor(input[m] + 0.5);
+        output[m] = static_cast<short>(std::max(-32768.0, std::min(32767.0, value)));
+    }
+}
@@ -0,0 +1,96 @@
+#include "DecimatorWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+DecimatorWorkerThread::DecimatorWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+
+}
+
+DecimatorWorkerThread::~DecimatorWorkerThread()
+{
+
+}
+
+int DecimatorWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void DecimatorWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void DecimatorWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void DecimatorWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void DecimatorWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void DecimatorWorkerThread::setDecimator(std::shared_ptr<const Decimator> decimator, std::shared_ptr<std::vector<short>> output)
+{
+    m_decimator = decimator;
+    m_output = output;
+}
+
+void DecimatorWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void DecimatorWorkerThread::clearData()
+{
+    m_output.reset();
+}
+
+void DecimatorWorkerThread::run()
+{
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_decimator || !m_output)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    // range of decimated samples for current worker
+    const size_t numOutputs = std::min(m_output->size(), m_decimator->numOutputs(N));
+    const size_t outputStart = (m_workerID * numOutputs) / m_numWorkers;
+    const size_t outputEnd = ((m_workerID + 1) * numOutputs) / m_numWorkers;
+
+    // Cancellation is only checked between batches of samples, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, 4096);
+
+    for (size_t first = outputStart; first < outputEnd; )
+    {
+        const size_t last = first + std::min(outputEnd - first, checkpoint.blockSize());
+        m_decimator->process(data_short, N, first, last, m_output->data() + first);
+        if (checkpoint.reached())
+        {
+            clearData();
+            return;
+        }
+        first = last;
+    }
+
+    emit decimationDone(m_workerID);
+}
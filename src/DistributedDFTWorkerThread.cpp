@@ -1,11 +1,13 @@
 #include "DistributedDFTWorkerThread.h"
 
-#include <math.h>
+#include <algorithm>
+#include <stdexcept>
 
 static std::atomic<double> maxSum{ 0 };
 
 DistributedDFTWorkerThread::DistributedDFTWorkerThread()
     : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
     , m_workerID(0)
 {
 
@@ -51,6 +53,25 @@ void DistributedDFTWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
     m_dataBuffer = dataBuffer;
 }
 
+void DistributedDFTWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void DistributedDFTWorkerThread::setBinDFT(std::shared_ptr<const BinDFT> binDFT)
+{
+    m_binDFT = binDFT;
+}
+
+void DistributedDFTWorkerThread::updateMaxSum(double localMax)
+{
+    // Several workers finish at the same time, only ever replace maxSum with a larger value
+    double current = maxSum;
+    while (localMax > current && !maxSum.compare_exchange_weak(current, localMax))
+    {
+    }
+}
+
 void DistributedDFTWorkerThread::run()
 {
     m_spectrumBuffer.clear();
@@ -58,7 +79,7 @@ void DistributedDFTWorkerThread::run()
     // Calculate number of samples
     const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
 
-    if (N == 0)
+    if (N == 0 || !m_binDFT)
     {
         return;
     }
@@ -67,65 +88,48 @@ void DistributedDFTWorkerThread::run()
     const char* data = m_dataBuffer->buffer().constData();
     short* data_short = (short*)data;
 
-    // range calculation for current worker
-    ulong k_start = (m_workerID * N) / Constants::NUM_DFT_WORKERS;
-    ulong k_end = ((m_workerID + 1) * N) / Constants::NUM_DFT_WORKERS;
-
-    if (k_end < N && (m_workerID + 1) == Constants::NUM_DFT_WORKERS)
-        k_end = N;
+    // range calculation for current worker: a share of the bins, each over every sample
+    const size_t numBins = m_binDFT->numBins();
+    const size_t firstBin = (m_workerID * numBins) / Constants::NUM_DFT_WORKERS;
+    const size_t lastBin = ((m_workerID + 1) * numBins) / Constants::NUM_DFT_WORKERS;
 
-    //qDebug() << "DistributedDFTWorkerThread::run() Worker ID: " << m_workerID << " Number of samples processing: " << (k_end - k_start + 1);
+    //qDebug() << "DistributedDFTWorkerThread::run() Worker ID: " << m_workerID << " Number of bins processing: " << (lastBin - firstBin);
 
-    m_spectrumBuffer.reserve(Constants::MAX_FREQUENCY - Constants::MIN_FREQUENCY);
+    std::vector<double> real(numBins, 0.0);
+    std::vector<double> imag(numBins, 0.0);
 
-    std::complex<double> currentSum;
+    // Cancellation is only checked between blocks of samples, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this);
 
-    std::vector<std::pair<ulong, std::complex<double>>> output;
-    output.reserve(N);
-
-    const ulong samplesPerSec = m_format.bytesForDuration(1e6) / (m_format.sampleSize() / 8);
-
-    // Loop through each k
-    for (ulong k = k_start; k < k_end; ++k)
-    {
-        currentSum = std::complex<double>(0, 0);
-
-        // Loop through each sample n
-        for (ulong n = k_start; n < k_end; ++n)
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t first = 0; first < N; )
         {
-            if (isInterruptionRequested())
+            const size_t last = first + std::min<size_t>(N - first, checkpoint.blockSize());
+            m_binDFT->accumulate(data_short, first, last, firstBin, lastBin, real, imag);
+            first = last;
+
+            if (checkpoint.reached())
             {
                 clearData();
                 return;
             }
-
-            double xn = data_short[n];
-            double real = std::cos(((2 * M_PI) / samplesPerSec) * k * n);
-            double imag = std::sin(((2 * M_PI) / samplesPerSec) * k * n);
-            std::complex<double> w (real, -imag);
-            currentSum += xn * w;
         }
-
-        double mag = std::abs(currentSum);
-
-        // Keep track of largest y-value seen so far
-        if (mag > maxSum)
-            maxSum = mag;
-
-        // Add point to output buffer
-        output.push_back(std::make_pair(k, currentSum));
     }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vectors, aborting DistributedDFTWorkerThread::run()";
+        return;
+    }
+
+    std::vector<double> amplitude(lastBin - firstBin);
+    const double localMax = FFTKernels::magnitude(real.data() + firstBin, imag.data() + firstBin,
+                                                  amplitude.data(), amplitude.size());
+    updateMaxSum(localMax);
 
-    for (size_t i = 0; i < (output.size() / 2); ++i)
+    m_spectrumBuffer.reserve(static_cast<int>(amplitude.size()));
+    for (size_t k = firstBin; k < lastBin; ++k)
     {
-        // Only plot the frequencies we're interested in
-        if (output[i].first > Constants::MAX_FREQUENCY)
-            break;
-        else if (output[i].first < Constants::MIN_FREQUENCY)
-            continue;
-
-        double abs = std::abs(output[i].second);
-        QPointF point(output[i].first, abs);
+        QPointF point(m_binDFT->frequency(k), amplitude[k - firstBin]);
         m_spectrumBuffer.append(point);
     }
 
@@ -0,0 +1,2125 @@
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FFTKERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang only emit AVX instructions inside functions explicitly targeted at them,
+// which lets this file be built without -mavx2 and still run on older CPUs.
+// MSVC always accepts the intrinsics, so the attributes are empty there.
+#if defined(FFTKERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define FFTKERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#define FFTKERNELS_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define FFTKERNELS_TARGET_AVX2
+#define FFTKERNELS_TARGET_AVX512
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Scalar kernels, also used for the tails the vector kernels cannot fill
+// ---------------------------------------------------------------------------------------
+
+static inline void butterflyBlockScalar(double* aRe, double* aIm, double* bRe, double* bIm,
+                                        const double* wRe, const double* wIm, size_t count)
+{
+    for (size_t j = 0; j < count; j++)
+    {
+        double tpre =  bRe[j] * wRe[j] + bIm[j] * wIm[j];
+        double tpim = -bRe[j] * wIm[j] + bIm[j] * wRe[j];
+        bRe[j] = aRe[j] - tpre;
+        bIm[j] = aIm[j] - tpim;
+        aRe[j] += tpre;
+        aIm[j] += tpim;
+    }
+}
+
+static void butterflyStageScalar(double* real, double* imag, size_t n, size_t halfsize,
+                                 const double* twiddleCos, const double* twiddleSin)
+{
+    for (size_t i = 0; i < n; i += 2 * halfsize)
+    {
+        butterflyBlockScalar(real + i, imag + i, real + i + halfsize, imag + i + halfsize,
+                             twiddleCos, twiddleSin, halfsize);
+    }
+}
+
+// The Stockham, magnitude and scale kernels also have float versions. Twiddles always come
+// from double tables and are rounded to T when they are read.
+template <typename T>
+static inline void stockhamBlockScalar(const T* aRe, const T* aIm, const T* bRe, const T* bIm,
+                                       T* sumRe, T* sumIm, T* diffRe, T* diffIm,
+                                       T wRe, T wIm, size_t count)
+{
+    for (size_t q = 0; q < count; q++)
+    {
+        const T dRe = aRe[q] - bRe[q];
+        const T dIm = aIm[q] - bIm[q];
+        sumRe[q] = aRe[q] + bRe[q];
+        sumIm[q] = aIm[q] + bIm[q];
+        diffRe[q] = dRe * wRe + dIm * wIm;
+        diffIm[q] = dIm * wRe - dRe * wIm;
+    }
+}
+
+template <typename T>
+static void stockhamStageScalar(const T* inReal, const T* inImag, T* outReal, T* outImag,
+                                size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (2 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        const size_t a = stride * p;
+        const size_t b = stride * (p + m);
+        const size_t out = 2 * stride * p;
+        stockhamBlockScalar<T>(inReal + a, inImag + a, inReal + b, inImag + b,
+                               outReal + out, outImag + out, outReal + out + stride, outImag + out + stride,
+                               static_cast<T>(twiddleCos[p]), static_cast<T>(twiddleSin[p]), stride);
+    }
+}
+
+// Twiddles of a radix-4 Stockham column: w1 = cos - i*sin from the table, w2 = w1^2, w3 = w1^3
+static inline void radix4Twiddles(double c1, double s1, double& c2, double& s2, double& c3, double& s3)
+{
+    c2 = c1 * c1 - s1 * s1;
+    s2 = 2 * c1 * s1;
+    c3 = c1 * c2 - s1 * s2;
+    s3 = c1 * s2 + s1 * c2;
+}
+
+template <typename T>
+static void stockhamRadix4StageScalar(const T* inReal, const T* inImag, T* outReal, T* outImag,
+                                      size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (4 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2d, s2d, c3d, s3d;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2d, s2d, c3d, s3d);
+        const T c1 = static_cast<T>(twiddleCos[p]), s1 = static_cast<T>(twiddleSin[p]);
+        const T c2 = static_cast<T>(c2d), s2 = static_cast<T>(s2d);
+        const T c3 = static_cast<T>(c3d), s3 = static_cast<T>(s3d);
+
+        for (size_t q = 0; q < stride; q++)
+        {
+            const size_t in = q + stride * p;
+            const size_t out = q + stride * 4 * p;
+
+            const T b0Re = inReal[in] + inReal[in + 2 * stride * m];
+            const T b0Im = inImag[in] + inImag[in + 2 * stride * m];
+            const T b1Re = inReal[in] - inReal[in + 2 * stride * m];
+            const T b1Im = inImag[in] - inImag[in + 2 * stride * m];
+            const T b2Re = inReal[in + stride * m] + inReal[in + 3 * stride * m];
+            const T b2Im = inImag[in + stride * m] + inImag[in + 3 * stride * m];
+
+            // b3 = -i * (a1 - a3)
+            const T b3Re = inImag[in + stride * m] - inImag[in + 3 * stride * m];
+            const T b3Im = inReal[in + 3 * stride * m] - inReal[in + stride * m];
+
+            const T y1Re = b1Re + b3Re;
+            const T y1Im = b1Im + b3Im;
+            const T y2Re = b0Re - b2Re;
+            const T y2Im = b0Im - b2Im;
+            const T y3Re = b1Re - b3Re;
+            const T y3Im = b1Im - b3Im;
+
+            outReal[out] = b0Re + b2Re;
+            outImag[out] = b0Im + b2Im;
+            outReal[out + stride] = y1Re * c1 + y1Im * s1;
+            outImag[out + stride] = y1Im * c1 - y1Re * s1;
+            outReal[out + 2 * stride] = y2Re * c2 + y2Im * s2;
+            outImag[out + 2 * stride] = y2Im * c2 - y2Re * s2;
+            outReal[out + 3 * stride] = y3Re * c3 + y3Im * s3;
+            outImag[out + 3 * stride] = y3Im * c3 - y3Re * s3;
+        }
+    }
+}
+
+template <typename T>
+static T magnitudeScalar(const T* real, const T* imag, T* out, size_t count)
+{
+    T maxValue = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = std::sqrt(real[i] * real[i] + imag[i] * imag[i]);
+        maxValue = std::max(maxValue, out[i]);
+    }
+
+    return maxValue;
+}
+
+template <typename T>
+static void scaleScalar(T* data, T factor, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        data[i] *= factor;
+    }
+}
+
+// Bins per tile of the phasor DFT, enough independent rotations to hide their latency
+static const size_t PHASOR_TILE_SCALAR = 4;
+
+static void phasorDFTScalar(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                            const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins)
+{
+    // Every tile of bins runs over all the samples with its phasors in registers
+    for (size_t k = 0; k < numBins; k += PHASOR_TILE_SCALAR)
+    {
+        const size_t count = std::min(PHASOR_TILE_SCALAR, numBins - k);
+        double pr[PHASOR_TILE_SCALAR] = {}, pi[PHASOR_TILE_SCALAR] = {};
+        double sc[PHASOR_TILE_SCALAR] = {}, ss[PHASOR_TILE_SCALAR] = {};
+        double sr[PHASOR_TILE_SCALAR] = {}, si[PHASOR_TILE_SCALAR] = {};
+        for (size_t j = 0; j < count; j++)
+        {
+            pr[j] = phasorReal[k + j];
+            pi[j] = phasorImag[k + j];
+            sc[j] = stepCos[k + j];
+            ss[j] = stepSin[k + j];
+            sr[j] = sumReal[k + j];
+            si[j] = sumImag[k + j];
+        }
+
+        for (size_t n = 0; n < numSamples; n++)
+        {
+            const double x = samples[n];
+            for (size_t j = 0; j < PHASOR_TILE_SCALAR; j++)
+            {
+                sr[j] += x * pr[j];
+                si[j] += x * pi[j];
+                const double re = pr[j] * sc[j] - pi[j] * ss[j];
+                pi[j] = pr[j] * ss[j] + pi[j] * sc[j];
+                pr[j] = re;
+            }
+        }
+
+        for (size_t j = 0; j < count; j++)
+        {
+            phasorReal[k + j] = pr[j];
+            phasorImag[k + j] = pi[j];
+            sumReal[k + j] = sr[j];
+            sumImag[k + j] = si[j];
+        }
+    }
+}
+
+static void firDecimateScalar(const double* input, size_t numOutputs, size_t factor,
+                              const double* taps, size_t numTaps, double* output)
+{
+    for (size_t m = 0; m < numOutputs; m++)
+    {
+        const double* x = input + m * factor;
+
+        // Four partial sums to hide the latency of the additions, the vector kernels keep one per lane
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        size_t t = 0;
+        for (; t + 4 <= numTaps; t += 4)
+        {
+            s0 += taps[t] * x[t];
+            s1 += taps[t + 1] * x[t + 1];
+            s2 += taps[t + 2] * x[t + 2];
+            s3 += taps[t + 3] * x[t + 3];
+        }
+
+        double sum = (s0 + s1) + (s2 + s3);
+        for (; t < numTaps; t++)
+        {
+            sum += taps[t] * x[t];
+        }
+        output[m] = sum;
+    }
+}
+
+// Full scale of each sample encoding, the integers are divided by it to land in [-1, 1)
+static inline float sampleScale(FFTKernels::SampleEncoding encoding)
+{
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    case FFTKernels::SampleEncoding::Int8:
+        return 1.0f / 128.0f;
+    case FFTKernels::SampleEncoding::Int16:
+        return 1.0f / 32768.0f;
+    case FFTKernels::SampleEncoding::Int32:
+        return 1.0f / 2147483648.0f;
+    default:
+        return 1.0f;
+    }
+}
+
+static void decodeSamplesScalar(const void* input, FFTKernels::SampleEncoding encoding, size_t count, float* output)
+{
+    const float scale = sampleScale(encoding);
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    {
+        const unsigned char* in = static_cast<const unsigned char*>(input);
+        for (size_t i = 0; i < count; i++)
+            output[i] = static_cast<float>(static_cast<int>(in[i]) - 128) * scale;
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int8:
+    {
+        const signed char* in = static_cast<const signed char*>(input);
+        for (size_t i = 0; i < count; i++)
+            output[i] = static_cast<float>(in[i]) * scale;
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int16:
+    {
+        const short* in = static_cast<const short*>(input);
+        for (size_t i = 0; i < count; i++)
+            output[i] = static_cast<float>(in[i]) * scale;
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int32:
+    {
+        const int* in = static_cast<const int*>(input);
+        for (size_t i = 0; i < count; i++)
+            output[i] = static_cast<float>(in[i]) * scale;
+        break;
+    }
+    default:
+        std::copy(static_cast<const float*>(input), static_cast<const float*>(input) + count, output);
+        break;
+    }
+}
+
+static void mixChannelsScalar(const float* input, size_t channels, size_t numFrames, int channel, float* output)
+{
+    if (channel >= 0)
+    {
+        for (size_t f = 0; f < numFrames; f++)
+            output[f] = input[f * channels + channel];
+        return;
+    }
+
+    const float scale = 1.0f / channels;
+    for (size_t f = 0; f < numFrames; f++)
+    {
+        const float* frame = input + f * channels;
+        float sum = frame[0];
+        for (size_t c = 1; c < channels; c++)
+        {
+            sum += frame[c];
+        }
+        output[f] = sum * scale;
+    }
+}
+
+static inline short floatToShortValue(float value)
+{
+    // Clamped before the conversion, rounded half to even like the vector conversions
+    value = std::min(32767.0f, std::max(-32768.0f, value * 32768.0f));
+    return static_cast<short>(std::nearbyint(value));
+}
+
+static void floatToShortScalar(const float* input, size_t count, short* output)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = floatToShortValue(input[i]);
+    }
+}
+
+#ifdef FFTKERNELS_X86
+
+// GCC 12 warns about the _mm512_undefined_*() placeholders inside its own AVX-512 reductions
+// and min/max intrinsics, the values are never read.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+// One radix-4 butterfly on 2 columns at once, returning the 4 outputs. Shared by both loop orders.
+#define FFTKERNELS_RADIX4_BODY(V, ADD, SUB, MUL)                                                   \
+    V b0r = ADD(a0r, a2r), b0i = ADD(a0i, a2i);                                                   \
+    V b1r = SUB(a0r, a2r), b1i = SUB(a0i, a2i);                                                   \
+    V b2r = ADD(a1r, a3r), b2i = ADD(a1i, a3i);                                                   \
+    V b3r = SUB(a1i, a3i), b3i = SUB(a3r, a1r);                                                   \
+    V y1r = ADD(b1r, b3r), y1i = ADD(b1i, b3i);                                                   \
+    V y2r = SUB(b0r, b2r), y2i = SUB(b0i, b2i);                                                   \
+    V y3r = SUB(b1r, b3r), y3i = SUB(b1i, b3i);                                                   \
+    V o0r = ADD(b0r, b2r), o0i = ADD(b0i, b2i);                                                   \
+    V o1r = ADD(MUL(y1r, c1), MUL(y1i, s1)), o1i = SUB(MUL(y1i, c1), MUL(y1r, s1));               \
+    V o2r = ADD(MUL(y2r, c2), MUL(y2i, s2)), o2i = SUB(MUL(y2i, c2), MUL(y2r, s2));               \
+    V o3r = ADD(MUL(y3r, c3), MUL(y3i, s3)), o3i = SUB(MUL(y3i, c3), MUL(y3r, s3));
+
+// Phasor DFT over a tile of 4 registers of bins starting at bin k. The phasors, steps and sums
+// stay in registers while the tile runs over every sample.
+#define FFTKERNELS_PHASOR_TILE(V, WIDTH, SET1, LOAD, STORE, ADD, SUB, MUL)                         \
+    V pr[4], pi[4], sc[4], ss[4], sr[4], si[4];                                                   \
+    for (int j = 0; j < 4; j++)                                                                   \
+    {                                                                                             \
+        pr[j] = LOAD(phasorReal + k + j * WIDTH);                                                 \
+        pi[j] = LOAD(phasorImag + k + j * WIDTH);                                                 \
+        sc[j] = LOAD(stepCos + k + j * WIDTH);                                                    \
+        ss[j] = LOAD(stepSin + k + j * WIDTH);                                                    \
+        sr[j] = LOAD(sumReal + k + j * WIDTH);                                                    \
+        si[j] = LOAD(sumImag + k + j * WIDTH);                                                    \
+    }                                                                                             \
+    for (size_t n = 0; n < numSamples; n++)                                                       \
+    {                                                                                             \
+        const V x = SET1(static_cast<double>(samples[n]));                                        \
+        for (int j = 0; j < 4; j++)                                                               \
+        {                                                                                         \
+            sr[j] = ADD(sr[j], MUL(x, pr[j]));                                                    \
+            si[j] = ADD(si[j], MUL(x, pi[j]));                                                    \
+            const V re = SUB(MUL(pr[j], sc[j]), MUL(pi[j], ss[j]));                               \
+            pi[j] = ADD(MUL(pr[j], ss[j]), MUL(pi[j], sc[j]));                                    \
+            pr[j] = re;                                                                           \
+        }                                                                                         \
+    }                                                                                             \
+    for (int j = 0; j < 4; j++)                                                                   \
+    {                                                                                             \
+        STORE(phasorReal + k + j * WIDTH, pr[j]);                                                 \
+        STORE(phasorImag + k + j * WIDTH, pi[j]);                                                 \
+        STORE(sumReal + k + j * WIDTH, sr[j]);                                                    \
+        STORE(sumImag + k + j * WIDTH, si[j]);                                                    \
+    }
+
+// ---------------------------------------------------------------------------------------
+// SSE2 kernels (2 doubles per register), SSE2 is part of every x86-64 CPU
+// ---------------------------------------------------------------------------------------
+
+static void butterflyStageSSE2(double* real, double* imag, size_t n, size_t halfsize,
+                               const double* twiddleCos, const double* twiddleSin)
+{
+    if (halfsize < 2)
+    {
+        butterflyStageScalar(real, imag, n, halfsize, twiddleCos, twiddleSin);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i += 2 * halfsize)
+    {
+        double* aRe = real + i;
+        double* aIm = imag + i;
+        double* bRe = aRe + halfsize;
+        double* bIm = aIm + halfsize;
+
+        size_t j = 0;
+        for (; j + 2 <= halfsize; j += 2)
+        {
+            __m128d wr = _mm_loadu_pd(twiddleCos + j);
+            __m128d wi = _mm_loadu_pd(twiddleSin + j);
+            __m128d br = _mm_loadu_pd(bRe + j);
+            __m128d bi = _mm_loadu_pd(bIm + j);
+            __m128d ar = _mm_loadu_pd(aRe + j);
+            __m128d ai = _mm_loadu_pd(aIm + j);
+
+            __m128d tpre = _mm_add_pd(_mm_mul_pd(br, wr), _mm_mul_pd(bi, wi));
+            __m128d tpim = _mm_sub_pd(_mm_mul_pd(bi, wr), _mm_mul_pd(br, wi));
+
+            _mm_storeu_pd(bRe + j, _mm_sub_pd(ar, tpre));
+            _mm_storeu_pd(bIm + j, _mm_sub_pd(ai, tpim));
+            _mm_storeu_pd(aRe + j, _mm_add_pd(ar, tpre));
+            _mm_storeu_pd(aIm + j, _mm_add_pd(ai, tpim));
+        }
+
+        butterflyBlockScalar(aRe + j, aIm + j, bRe + j, bIm + j, twiddleCos + j, twiddleSin + j, halfsize - j);
+    }
+}
+
+static void stockhamStageSSE2(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (2 * stride);
+
+    // First stage: vectorize over p and interleave the sums and differences on the way out
+    if (stride == 1)
+    {
+        size_t p = 0;
+        for (; p + 2 <= m; p += 2)
+        {
+            __m128d wr = _mm_loadu_pd(twiddleCos + p);
+            __m128d wi = _mm_loadu_pd(twiddleSin + p);
+            __m128d ar = _mm_loadu_pd(inReal + p);
+            __m128d ai = _mm_loadu_pd(inImag + p);
+            __m128d br = _mm_loadu_pd(inReal + p + m);
+            __m128d bi = _mm_loadu_pd(inImag + p + m);
+
+            __m128d sr = _mm_add_pd(ar, br);
+            __m128d si = _mm_add_pd(ai, bi);
+            __m128d dr = _mm_sub_pd(ar, br);
+            __m128d di = _mm_sub_pd(ai, bi);
+            __m128d tr = _mm_add_pd(_mm_mul_pd(dr, wr), _mm_mul_pd(di, wi));
+            __m128d ti = _mm_sub_pd(_mm_mul_pd(di, wr), _mm_mul_pd(dr, wi));
+
+            _mm_storeu_pd(outReal + 2 * p, _mm_unpacklo_pd(sr, tr));
+            _mm_storeu_pd(outReal + 2 * p + 2, _mm_unpackhi_pd(sr, tr));
+            _mm_storeu_pd(outImag + 2 * p, _mm_unpacklo_pd(si, ti));
+            _mm_storeu_pd(outImag + 2 * p + 2, _mm_unpackhi_pd(si, ti));
+        }
+
+        for (; p < m; p++)
+        {
+            stockhamBlockScalar<double>(inReal + p, inImag + p, inReal + p + m, inImag + p + m,
+                                        outReal + 2 * p, outImag + 2 * p, outReal + 2 * p + 1, outImag + 2 * p + 1,
+                                        twiddleCos[p], twiddleSin[p], 1);
+        }
+        return;
+    }
+
+    // Later stages: vectorize over the contiguous q, stride is a power of 2 >= 2 here
+    for (size_t p = 0; p < m; p++)
+    {
+        const double* aRe = inReal + stride * p;
+        const double* aIm = inImag + stride * p;
+        const double* bRe = inReal + stride * (p + m);
+        const double* bIm = inImag + stride * (p + m);
+        double* sumRe = outReal + 2 * stride * p;
+        double* sumIm = outImag + 2 * stride * p;
+        double* diffRe = sumRe + stride;
+        double* diffIm = sumIm + stride;
+
+        const __m128d wr = _mm_set1_pd(twiddleCos[p]);
+        const __m128d wi = _mm_set1_pd(twiddleSin[p]);
+        for (size_t q = 0; q < stride; q += 2)
+        {
+            __m128d ar = _mm_loadu_pd(aRe + q);
+            __m128d ai = _mm_loadu_pd(aIm + q);
+            __m128d br = _mm_loadu_pd(bRe + q);
+            __m128d bi = _mm_loadu_pd(bIm + q);
+            __m128d dr = _mm_sub_pd(ar, br);
+            __m128d di = _mm_sub_pd(ai, bi);
+
+            _mm_storeu_pd(sumRe + q, _mm_add_pd(ar, br));
+            _mm_storeu_pd(sumIm + q, _mm_add_pd(ai, bi));
+            _mm_storeu_pd(diffRe + q, _mm_add_pd(_mm_mul_pd(dr, wr), _mm_mul_pd(di, wi)));
+            _mm_storeu_pd(diffIm + q, _mm_sub_pd(_mm_mul_pd(di, wr), _mm_mul_pd(dr, wi)));
+        }
+    }
+}
+
+static void stockhamRadix4StageSSE2(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (4 * stride);
+
+    // First stage: vectorize over p and interleave the 4 outputs of each column on the way out
+    if (stride == 1)
+    {
+        if (m < 2)
+        {
+            stockhamRadix4StageScalar(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+            return;
+        }
+
+        for (size_t p = 0; p < m; p += 2)
+        {
+            __m128d c1 = _mm_loadu_pd(twiddleCos + p);
+            __m128d s1 = _mm_loadu_pd(twiddleSin + p);
+            __m128d c2 = _mm_sub_pd(_mm_mul_pd(c1, c1), _mm_mul_pd(s1, s1));
+            __m128d s2 = _mm_mul_pd(_mm_set1_pd(2.0), _mm_mul_pd(c1, s1));
+            __m128d c3 = _mm_sub_pd(_mm_mul_pd(c1, c2), _mm_mul_pd(s1, s2));
+            __m128d s3 = _mm_add_pd(_mm_mul_pd(c1, s2), _mm_mul_pd(s1, c2));
+
+            __m128d a0r = _mm_loadu_pd(inReal + p), a0i = _mm_loadu_pd(inImag + p);
+            __m128d a1r = _mm_loadu_pd(inReal + p + m), a1i = _mm_loadu_pd(inImag + p + m);
+            __m128d a2r = _mm_loadu_pd(inReal + p + 2 * m), a2i = _mm_loadu_pd(inImag + p + 2 * m);
+            __m128d a3r = _mm_loadu_pd(inReal + p + 3 * m), a3i = _mm_loadu_pd(inImag + p + 3 * m);
+
+            FFTKERNELS_RADIX4_BODY(__m128d, _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+
+            double* outRe = outReal + 4 * p;
+            double* outIm = outImag + 4 * p;
+            _mm_storeu_pd(outRe, _mm_unpacklo_pd(o0r, o1r));
+            _mm_storeu_pd(outRe + 2, _mm_unpacklo_pd(o2r, o3r));
+            _mm_storeu_pd(outRe + 4, _mm_unpackhi_pd(o0r, o1r));
+            _mm_storeu_pd(outRe + 6, _mm_unpackhi_pd(o2r, o3r));
+            _mm_storeu_pd(outIm, _mm_unpacklo_pd(o0i, o1i));
+            _mm_storeu_pd(outIm + 2, _mm_unpacklo_pd(o2i, o3i));
+            _mm_storeu_pd(outIm + 4, _mm_unpackhi_pd(o0i, o1i));
+            _mm_storeu_pd(outIm + 6, _mm_unpackhi_pd(o2i, o3i));
+        }
+        return;
+    }
+
+    // Later stages: vectorize over the contiguous q, stride is a power of 4 here
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m128d c1 = _mm_set1_pd(twiddleCos[p]), s1 = _mm_set1_pd(twiddleSin[p]);
+        const __m128d c2 = _mm_set1_pd(c2s), s2 = _mm_set1_pd(s2s);
+        const __m128d c3 = _mm_set1_pd(c3s), s3 = _mm_set1_pd(s3s);
+
+        const double* inRe = inReal + stride * p;
+        const double* inIm = inImag + stride * p;
+        double* outRe = outReal + stride * 4 * p;
+        double* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 2)
+        {
+            __m128d a0r = _mm_loadu_pd(inRe + q), a0i = _mm_loadu_pd(inIm + q);
+            __m128d a1r = _mm_loadu_pd(inRe + q + quarter), a1i = _mm_loadu_pd(inIm + q + quarter);
+            __m128d a2r = _mm_loadu_pd(inRe + q + 2 * quarter), a2i = _mm_loadu_pd(inIm + q + 2 * quarter);
+            __m128d a3r = _mm_loadu_pd(inRe + q + 3 * quarter), a3i = _mm_loadu_pd(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m128d, _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+
+            _mm_storeu_pd(outRe + q, o0r);
+            _mm_storeu_pd(outIm + q, o0i);
+            _mm_storeu_pd(outRe + q + stride, o1r);
+            _mm_storeu_pd(outIm + q + stride, o1i);
+            _mm_storeu_pd(outRe + q + 2 * stride, o2r);
+            _mm_storeu_pd(outIm + q + 2 * stride, o2i);
+            _mm_storeu_pd(outRe + q + 3 * stride, o3r);
+            _mm_storeu_pd(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+static double magnitudeSSE2(const double* real, const double* imag, double* out, size_t count)
+{
+    __m128d maxValues = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d re = _mm_loadu_pd(real + i);
+        __m128d im = _mm_loadu_pd(imag + i);
+        __m128d mag = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(re, re), _mm_mul_pd(im, im)));
+        _mm_storeu_pd(out + i, mag);
+        maxValues = _mm_max_pd(maxValues, mag);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, maxValues);
+    double maxValue = std::max(lanes[0], lanes[1]);
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+static void scaleSSE2(double* data, double factor, size_t count)
+{
+    const __m128d f = _mm_set1_pd(factor);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        _mm_storeu_pd(data + i, _mm_mul_pd(_mm_loadu_pd(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+// ---------------------------------------------------------------------------------------
+// AVX2 kernels (4 doubles per register)
+// ---------------------------------------------------------------------------------------
+
+FFTKERNELS_TARGET_AVX2
+static void butterflyStageAVX2(double* real, double* imag, size_t n, size_t halfsize,
+                               const double* twiddleCos, const double* twiddleSin)
+{
+    if (halfsize < 4)
+    {
+        butterflyStageSSE2(real, imag, n, halfsize, twiddleCos, twiddleSin);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i += 2 * halfsize)
+    {
+        double* aRe = real + i;
+        double* aIm = imag + i;
+        double* bRe = aRe + halfsize;
+        double* bIm = aIm + halfsize;
+
+        // halfsize is a power of 2 here, so there is never a tail
+        for (size_t j = 0; j < halfsize; j += 4)
+        {
+            __m256d wr = _mm256_loadu_pd(twiddleCos + j);
+            __m256d wi = _mm256_loadu_pd(twiddleSin + j);
+            __m256d br = _mm256_loadu_pd(bRe + j);
+            __m256d bi = _mm256_loadu_pd(bIm + j);
+            __m256d ar = _mm256_loadu_pd(aRe + j);
+            __m256d ai = _mm256_loadu_pd(aIm + j);
+
+            __m256d tpre = _mm256_add_pd(_mm256_mul_pd(br, wr), _mm256_mul_pd(bi, wi));
+            __m256d tpim = _mm256_sub_pd(_mm256_mul_pd(bi, wr), _mm256_mul_pd(br, wi));
+
+            _mm256_storeu_pd(bRe + j, _mm256_sub_pd(ar, tpre));
+            _mm256_storeu_pd(bIm + j, _mm256_sub_pd(ai, tpim));
+            _mm256_storeu_pd(aRe + j, _mm256_add_pd(ar, tpre));
+            _mm256_storeu_pd(aIm + j, _mm256_add_pd(ai, tpim));
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX2
+static void stockhamStageAVX2(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (2 * stride);
+
+    if (stride == 1 && m >= 4)
+    {
+        // m is a power of 2 here, so there is never a tail
+        for (size_t p = 0; p < m; p += 4)
+        {
+            __m256d wr = _mm256_loadu_pd(twiddleCos + p);
+            __m256d wi = _mm256_loadu_pd(twiddleSin + p);
+            __m256d ar = _mm256_loadu_pd(inReal + p);
+            __m256d ai = _mm256_loadu_pd(inImag + p);
+            __m256d br = _mm256_loadu_pd(inReal + p + m);
+            __m256d bi = _mm256_loadu_pd(inImag + p + m);
+
+            __m256d sr = _mm256_add_pd(ar, br);
+            __m256d si = _mm256_add_pd(ai, bi);
+            __m256d dr = _mm256_sub_pd(ar, br);
+            __m256d di = _mm256_sub_pd(ai, bi);
+            __m256d tr = _mm256_add_pd(_mm256_mul_pd(dr, wr), _mm256_mul_pd(di, wi));
+            __m256d ti = _mm256_sub_pd(_mm256_mul_pd(di, wr), _mm256_mul_pd(dr, wi));
+
+            // unpack works within 128-bit lanes, the permutes put the pairs back in order
+            __m256d lowRe = _mm256_unpacklo_pd(sr, tr);
+            __m256d highRe = _mm256_unpackhi_pd(sr, tr);
+            __m256d lowIm = _mm256_unpacklo_pd(si, ti);
+            __m256d highIm = _mm256_unpackhi_pd(si, ti);
+            _mm256_storeu_pd(outReal + 2 * p, _mm256_permute2f128_pd(lowRe, highRe, 0x20));
+            _mm256_storeu_pd(outReal + 2 * p + 4, _mm256_permute2f128_pd(lowRe, highRe, 0x31));
+            _mm256_storeu_pd(outImag + 2 * p, _mm256_permute2f128_pd(lowIm, highIm, 0x20));
+            _mm256_storeu_pd(outImag + 2 * p + 4, _mm256_permute2f128_pd(lowIm, highIm, 0x31));
+        }
+        return;
+    }
+
+    if (stride < 4)
+    {
+        stockhamStageSSE2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    for (size_t p = 0; p < m; p++)
+    {
+        const double* aRe = inReal + stride * p;
+        const double* aIm = inImag + stride * p;
+        const double* bRe = inReal + stride * (p + m);
+        const double* bIm = inImag + stride * (p + m);
+        double* sumRe = outReal + 2 * stride * p;
+        double* sumIm = outImag + 2 * stride * p;
+        double* diffRe = sumRe + stride;
+        double* diffIm = sumIm + stride;
+
+        const __m256d wr = _mm256_set1_pd(twiddleCos[p]);
+        const __m256d wi = _mm256_set1_pd(twiddleSin[p]);
+        for (size_t q = 0; q < stride; q += 4)
+        {
+            __m256d ar = _mm256_loadu_pd(aRe + q);
+            __m256d ai = _mm256_loadu_pd(aIm + q);
+            __m256d br = _mm256_loadu_pd(bRe + q);
+            __m256d bi = _mm256_loadu_pd(bIm + q);
+            __m256d dr = _mm256_sub_pd(ar, br);
+            __m256d di = _mm256_sub_pd(ai, bi);
+
+            _mm256_storeu_pd(sumRe + q, _mm256_add_pd(ar, br));
+            _mm256_storeu_pd(sumIm + q, _mm256_add_pd(ai, bi));
+            _mm256_storeu_pd(diffRe + q, _mm256_add_pd(_mm256_mul_pd(dr, wr), _mm256_mul_pd(di, wi)));
+            _mm256_storeu_pd(diffIm + q, _mm256_sub_pd(_mm256_mul_pd(di, wr), _mm256_mul_pd(dr, wi)));
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX2
+static void stockhamRadix4StageAVX2(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (4 * stride);
+
+    if (stride == 1 && m >= 4)
+    {
+        for (size_t p = 0; p < m; p += 4)
+        {
+            __m256d c1 = _mm256_loadu_pd(twiddleCos + p);
+            __m256d s1 = _mm256_loadu_pd(twiddleSin + p);
+            __m256d c2 = _mm256_sub_pd(_mm256_mul_pd(c1, c1), _mm256_mul_pd(s1, s1));
+            __m256d s2 = _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_mul_pd(c1, s1));
+            __m256d c3 = _mm256_sub_pd(_mm256_mul_pd(c1, c2), _mm256_mul_pd(s1, s2));
+            __m256d s3 = _mm256_add_pd(_mm256_mul_pd(c1, s2), _mm256_mul_pd(s1, c2));
+
+            __m256d a0r = _mm256_loadu_pd(inReal + p), a0i = _mm256_loadu_pd(inImag + p);
+            __m256d a1r = _mm256_loadu_pd(inReal + p + m), a1i = _mm256_loadu_pd(inImag + p + m);
+            __m256d a2r = _mm256_loadu_pd(inReal + p + 2 * m), a2i = _mm256_loadu_pd(inImag + p + 2 * m);
+            __m256d a3r = _mm256_loadu_pd(inReal + p + 3 * m), a3i = _mm256_loadu_pd(inImag + p + 3 * m);
+
+            FFTKERNELS_RADIX4_BODY(__m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+
+            // 4x4 transpose, so that the 4 outputs of column p end up next to each other
+            __m256d t0 = _mm256_unpacklo_pd(o0r, o1r), t1 = _mm256_unpackhi_pd(o0r, o1r);
+            __m256d t2 = _mm256_unpacklo_pd(o2r, o3r), t3 = _mm256_unpackhi_pd(o2r, o3r);
+            double* outRe = outReal + 4 * p;
+            _mm256_storeu_pd(outRe, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(outRe + 4, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(outRe + 8, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(outRe + 12, _mm256_permute2f128_pd(t1, t3, 0x31));
+
+            t0 = _mm256_unpacklo_pd(o0i, o1i);
+            t1 = _mm256_unpackhi_pd(o0i, o1i);
+            t2 = _mm256_unpacklo_pd(o2i, o3i);
+            t3 = _mm256_unpackhi_pd(o2i, o3i);
+            double* outIm = outImag + 4 * p;
+            _mm256_storeu_pd(outIm, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(outIm + 4, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(outIm + 8, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(outIm + 12, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+        return;
+    }
+
+    if (stride < 4)
+    {
+        stockhamRadix4StageSSE2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m256d c1 = _mm256_set1_pd(twiddleCos[p]), s1 = _mm256_set1_pd(twiddleSin[p]);
+        const __m256d c2 = _mm256_set1_pd(c2s), s2 = _mm256_set1_pd(s2s);
+        const __m256d c3 = _mm256_set1_pd(c3s), s3 = _mm256_set1_pd(s3s);
+
+        const double* inRe = inReal + stride * p;
+        const double* inIm = inImag + stride * p;
+        double* outRe = outReal + stride * 4 * p;
+        double* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 4)
+        {
+            __m256d a0r = _mm256_loadu_pd(inRe + q), a0i = _mm256_loadu_pd(inIm + q);
+            __m256d a1r = _mm256_loadu_pd(inRe + q + quarter), a1i = _mm256_loadu_pd(inIm + q + quarter);
+            __m256d a2r = _mm256_loadu_pd(inRe + q + 2 * quarter), a2i = _mm256_loadu_pd(inIm + q + 2 * quarter);
+            __m256d a3r = _mm256_loadu_pd(inRe + q + 3 * quarter), a3i = _mm256_loadu_pd(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+
+            _mm256_storeu_pd(outRe + q, o0r);
+            _mm256_storeu_pd(outIm + q, o0i);
+            _mm256_storeu_pd(outRe + q + stride, o1r);
+            _mm256_storeu_pd(outIm + q + stride, o1i);
+            _mm256_storeu_pd(outRe + q + 2 * stride, o2r);
+            _mm256_storeu_pd(outIm + q + 2 * stride, o2i);
+            _mm256_storeu_pd(outRe + q + 3 * stride, o3r);
+            _mm256_storeu_pd(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX2
+static double magnitudeAVX2(const double* real, const double* imag, double* out, size_t count)
+{
+    __m256d maxValues = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d re = _mm256_loadu_pd(real + i);
+        __m256d im = _mm256_loadu_pd(imag + i);
+        __m256d mag = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(re, re), _mm256_mul_pd(im, im)));
+        _mm256_storeu_pd(out + i, mag);
+        maxValues = _mm256_max_pd(maxValues, mag);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, maxValues);
+    double maxValue = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+FFTKERNELS_TARGET_AVX2
+static void scaleAVX2(double* data, double factor, size_t count)
+{
+    const __m256d f = _mm256_set1_pd(factor);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm256_storeu_pd(data + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+// ---------------------------------------------------------------------------------------
+// AVX-512 kernels (8 doubles per register)
+// ---------------------------------------------------------------------------------------
+
+FFTKERNELS_TARGET_AVX512
+static void butterflyStageAVX512(double* real, double* imag, size_t n, size_t halfsize,
+                                 const double* twiddleCos, const double* twiddleSin)
+{
+    if (halfsize < 8)
+    {
+        butterflyStageAVX2(real, imag, n, halfsize, twiddleCos, twiddleSin);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i += 2 * halfsize)
+    {
+        double* aRe = real + i;
+        double* aIm = imag + i;
+        double* bRe = aRe + halfsize;
+        double* bIm = aIm + halfsize;
+
+        for (size_t j = 0; j < halfsize; j += 8)
+        {
+            __m512d wr = _mm512_loadu_pd(twiddleCos + j);
+            __m512d wi = _mm512_loadu_pd(twiddleSin + j);
+            __m512d br = _mm512_loadu_pd(bRe + j);
+            __m512d bi = _mm512_loadu_pd(bIm + j);
+            __m512d ar = _mm512_loadu_pd(aRe + j);
+            __m512d ai = _mm512_loadu_pd(aIm + j);
+
+            __m512d tpre = _mm512_add_pd(_mm512_mul_pd(br, wr), _mm512_mul_pd(bi, wi));
+            __m512d tpim = _mm512_sub_pd(_mm512_mul_pd(bi, wr), _mm512_mul_pd(br, wi));
+
+            _mm512_storeu_pd(bRe + j, _mm512_sub_pd(ar, tpre));
+            _mm512_storeu_pd(bIm + j, _mm512_sub_pd(ai, tpim));
+            _mm512_storeu_pd(aRe + j, _mm512_add_pd(ar, tpre));
+            _mm512_storeu_pd(aIm + j, _mm512_add_pd(ai, tpim));
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static void stockhamStageAVX512(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    if (stride < 8)
+    {
+        stockhamStageAVX2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (2 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        const double* aRe = inReal + stride * p;
+        const double* aIm = inImag + stride * p;
+        const double* bRe = inReal + stride * (p + m);
+        const double* bIm = inImag + stride * (p + m);
+        double* sumRe = outReal + 2 * stride * p;
+        double* sumIm = outImag + 2 * stride * p;
+        double* diffRe = sumRe + stride;
+        double* diffIm = sumIm + stride;
+
+        const __m512d wr = _mm512_set1_pd(twiddleCos[p]);
+        const __m512d wi = _mm512_set1_pd(twiddleSin[p]);
+        for (size_t q = 0; q < stride; q += 8)
+        {
+            __m512d ar = _mm512_loadu_pd(aRe + q);
+            __m512d ai = _mm512_loadu_pd(aIm + q);
+            __m512d br = _mm512_loadu_pd(bRe + q);
+            __m512d bi = _mm512_loadu_pd(bIm + q);
+            __m512d dr = _mm512_sub_pd(ar, br);
+            __m512d di = _mm512_sub_pd(ai, bi);
+
+            _mm512_storeu_pd(sumRe + q, _mm512_add_pd(ar, br));
+            _mm512_storeu_pd(sumIm + q, _mm512_add_pd(ai, bi));
+            _mm512_storeu_pd(diffRe + q, _mm512_add_pd(_mm512_mul_pd(dr, wr), _mm512_mul_pd(di, wi)));
+            _mm512_storeu_pd(diffIm + q, _mm512_sub_pd(_mm512_mul_pd(di, wr), _mm512_mul_pd(dr, wi)));
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static void stockhamRadix4StageAVX512(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                      size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    // stride is a power of 4, so this covers every stage but the first two
+    if (stride < 8)
+    {
+        stockhamRadix4StageAVX2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (4 * stride);
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m512d c1 = _mm512_set1_pd(twiddleCos[p]), s1 = _mm512_set1_pd(twiddleSin[p]);
+        const __m512d c2 = _mm512_set1_pd(c2s), s2 = _mm512_set1_pd(s2s);
+        const __m512d c3 = _mm512_set1_pd(c3s), s3 = _mm512_set1_pd(s3s);
+
+        const double* inRe = inReal + stride * p;
+        const double* inIm = inImag + stride * p;
+        double* outRe = outReal + stride * 4 * p;
+        double* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 8)
+        {
+            __m512d a0r = _mm512_loadu_pd(inRe + q), a0i = _mm512_loadu_pd(inIm + q);
+            __m512d a1r = _mm512_loadu_pd(inRe + q + quarter), a1i = _mm512_loadu_pd(inIm + q + quarter);
+            __m512d a2r = _mm512_loadu_pd(inRe + q + 2 * quarter), a2i = _mm512_loadu_pd(inIm + q + 2 * quarter);
+            __m512d a3r = _mm512_loadu_pd(inRe + q + 3 * quarter), a3i = _mm512_loadu_pd(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m512d, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd)
+
+            _mm512_storeu_pd(outRe + q, o0r);
+            _mm512_storeu_pd(outIm + q, o0i);
+            _mm512_storeu_pd(outRe + q + stride, o1r);
+            _mm512_storeu_pd(outIm + q + stride, o1i);
+            _mm512_storeu_pd(outRe + q + 2 * stride, o2r);
+            _mm512_storeu_pd(outIm + q + 2 * stride, o2i);
+            _mm512_storeu_pd(outRe + q + 3 * stride, o3r);
+            _mm512_storeu_pd(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static double magnitudeAVX512(const double* real, const double* imag, double* out, size_t count)
+{
+    __m512d maxValues = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d re = _mm512_loadu_pd(real + i);
+        __m512d im = _mm512_loadu_pd(imag + i);
+        __m512d mag = _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(re, re), _mm512_mul_pd(im, im)));
+        _mm512_storeu_pd(out + i, mag);
+        maxValues = _mm512_max_pd(maxValues, mag);
+    }
+
+    double maxValue = _mm512_reduce_max_pd(maxValues);
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+FFTKERNELS_TARGET_AVX512
+static void scaleAVX512(double* data, double factor, size_t count)
+{
+    const __m512d f = _mm512_set1_pd(factor);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm512_storeu_pd(data + i, _mm512_mul_pd(_mm512_loadu_pd(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+// ---------------------------------------------------------------------------------------
+// Single precision kernels (4, 8 and 16 floats per register). Only the Stockham stages are
+// needed: the first radix-4 stage is vectorized over the columns p and transposed on the way
+// out, later stages over the contiguous q. The radix-2 stage is only used for the last level,
+// where stride = n / 2, so it is always vectorized over q.
+// ---------------------------------------------------------------------------------------
+
+// Loads 4 consecutive twiddles rounded to float
+static inline __m128 loadTwiddlesSSE2(const double* twiddles)
+{
+    return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(twiddles)), _mm_cvtpd_ps(_mm_loadu_pd(twiddles + 2)));
+}
+
+static void stockhamStageSSE2(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    if (stride < 4)
+    {
+        stockhamStageScalar<float>(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (2 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        const float* aRe = inReal + stride * p;
+        const float* aIm = inImag + stride * p;
+        const float* bRe = inReal + stride * (p + m);
+        const float* bIm = inImag + stride * (p + m);
+        float* sumRe = outReal + 2 * stride * p;
+        float* sumIm = outImag + 2 * stride * p;
+        float* diffRe = sumRe + stride;
+        float* diffIm = sumIm + stride;
+
+        const __m128 wr = _mm_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m128 wi = _mm_set1_ps(static_cast<float>(twiddleSin[p]));
+        for (size_t q = 0; q < stride; q += 4)
+        {
+            __m128 ar = _mm_loadu_ps(aRe + q);
+            __m128 ai = _mm_loadu_ps(aIm + q);
+            __m128 br = _mm_loadu_ps(bRe + q);
+            __m128 bi = _mm_loadu_ps(bIm + q);
+            __m128 dr = _mm_sub_ps(ar, br);
+            __m128 di = _mm_sub_ps(ai, bi);
+
+            _mm_storeu_ps(sumRe + q, _mm_add_ps(ar, br));
+            _mm_storeu_ps(sumIm + q, _mm_add_ps(ai, bi));
+            _mm_storeu_ps(diffRe + q, _mm_add_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi)));
+            _mm_storeu_ps(diffIm + q, _mm_sub_ps(_mm_mul_ps(di, wr), _mm_mul_ps(dr, wi)));
+        }
+    }
+}
+
+static void stockhamRadix4StageSSE2(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (4 * stride);
+
+    if (stride == 1 && m >= 4)
+    {
+        for (size_t p = 0; p < m; p += 4)
+        {
+            __m128 c1 = loadTwiddlesSSE2(twiddleCos + p);
+            __m128 s1 = loadTwiddlesSSE2(twiddleSin + p);
+            __m128 c2 = _mm_sub_ps(_mm_mul_ps(c1, c1), _mm_mul_ps(s1, s1));
+            __m128 s2 = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_mul_ps(c1, s1));
+            __m128 c3 = _mm_sub_ps(_mm_mul_ps(c1, c2), _mm_mul_ps(s1, s2));
+            __m128 s3 = _mm_add_ps(_mm_mul_ps(c1, s2), _mm_mul_ps(s1, c2));
+
+            __m128 a0r = _mm_loadu_ps(inReal + p), a0i = _mm_loadu_ps(inImag + p);
+            __m128 a1r = _mm_loadu_ps(inReal + p + m), a1i = _mm_loadu_ps(inImag + p + m);
+            __m128 a2r = _mm_loadu_ps(inReal + p + 2 * m), a2i = _mm_loadu_ps(inImag + p + 2 * m);
+            __m128 a3r = _mm_loadu_ps(inReal + p + 3 * m), a3i = _mm_loadu_ps(inImag + p + 3 * m);
+
+            FFTKERNELS_RADIX4_BODY(__m128, _mm_add_ps, _mm_sub_ps, _mm_mul_ps)
+
+            // After the transpose register k holds the 4 outputs of column p + k
+            _MM_TRANSPOSE4_PS(o0r, o1r, o2r, o3r);
+            _MM_TRANSPOSE4_PS(o0i, o1i, o2i, o3i);
+            float* outRe = outReal + 4 * p;
+            float* outIm = outImag + 4 * p;
+            _mm_storeu_ps(outRe, o0r);
+            _mm_storeu_ps(outRe + 4, o1r);
+            _mm_storeu_ps(outRe + 8, o2r);
+            _mm_storeu_ps(outRe + 12, o3r);
+            _mm_storeu_ps(outIm, o0i);
+            _mm_storeu_ps(outIm + 4, o1i);
+            _mm_storeu_ps(outIm + 8, o2i);
+            _mm_storeu_ps(outIm + 12, o3i);
+        }
+        return;
+    }
+
+    if (stride < 4)
+    {
+        stockhamRadix4StageScalar<float>(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m128 c1 = _mm_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m128 s1 = _mm_set1_ps(static_cast<float>(twiddleSin[p]));
+        const __m128 c2 = _mm_set1_ps(static_cast<float>(c2s)), s2 = _mm_set1_ps(static_cast<float>(s2s));
+        const __m128 c3 = _mm_set1_ps(static_cast<float>(c3s)), s3 = _mm_set1_ps(static_cast<float>(s3s));
+
+        const float* inRe = inReal + stride * p;
+        const float* inIm = inImag + stride * p;
+        float* outRe = outReal + stride * 4 * p;
+        float* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 4)
+        {
+            __m128 a0r = _mm_loadu_ps(inRe + q), a0i = _mm_loadu_ps(inIm + q);
+            __m128 a1r = _mm_loadu_ps(inRe + q + quarter), a1i = _mm_loadu_ps(inIm + q + quarter);
+            __m128 a2r = _mm_loadu_ps(inRe + q + 2 * quarter), a2i = _mm_loadu_ps(inIm + q + 2 * quarter);
+            __m128 a3r = _mm_loadu_ps(inRe + q + 3 * quarter), a3i = _mm_loadu_ps(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m128, _mm_add_ps, _mm_sub_ps, _mm_mul_ps)
+
+            _mm_storeu_ps(outRe + q, o0r);
+            _mm_storeu_ps(outIm + q, o0i);
+            _mm_storeu_ps(outRe + q + stride, o1r);
+            _mm_storeu_ps(outIm + q + stride, o1i);
+            _mm_storeu_ps(outRe + q + 2 * stride, o2r);
+            _mm_storeu_ps(outIm + q + 2 * stride, o2i);
+            _mm_storeu_ps(outRe + q + 3 * stride, o3r);
+            _mm_storeu_ps(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+static float magnitudeSSE2(const float* real, const float* imag, float* out, size_t count)
+{
+    __m128 maxValues = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 re = _mm_loadu_ps(real + i);
+        __m128 im = _mm_loadu_ps(imag + i);
+        __m128 mag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        _mm_storeu_ps(out + i, mag);
+        maxValues = _mm_max_ps(maxValues, mag);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, maxValues);
+    float maxValue = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+static void scaleSSE2(float* data, float factor, size_t count)
+{
+    const __m128 f = _mm_set1_ps(factor);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+FFTKERNELS_TARGET_AVX2
+static void stockhamStageAVX2(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                              size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    if (stride < 8)
+    {
+        stockhamStageSSE2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (2 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        const float* aRe = inReal + stride * p;
+        const float* aIm = inImag + stride * p;
+        const float* bRe = inReal + stride * (p + m);
+        const float* bIm = inImag + stride * (p + m);
+        float* sumRe = outReal + 2 * stride * p;
+        float* sumIm = outImag + 2 * stride * p;
+        float* diffRe = sumRe + stride;
+        float* diffIm = sumIm + stride;
+
+        const __m256 wr = _mm256_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m256 wi = _mm256_set1_ps(static_cast<float>(twiddleSin[p]));
+        for (size_t q = 0; q < stride; q += 8)
+        {
+            __m256 ar = _mm256_loadu_ps(aRe + q);
+            __m256 ai = _mm256_loadu_ps(aIm + q);
+            __m256 br = _mm256_loadu_ps(bRe + q);
+            __m256 bi = _mm256_loadu_ps(bIm + q);
+            __m256 dr = _mm256_sub_ps(ar, br);
+            __m256 di = _mm256_sub_ps(ai, bi);
+
+            _mm256_storeu_ps(sumRe + q, _mm256_add_ps(ar, br));
+            _mm256_storeu_ps(sumIm + q, _mm256_add_ps(ai, bi));
+            _mm256_storeu_ps(diffRe + q, _mm256_add_ps(_mm256_mul_ps(dr, wr), _mm256_mul_ps(di, wi)));
+            _mm256_storeu_ps(diffIm + q, _mm256_sub_ps(_mm256_mul_ps(di, wr), _mm256_mul_ps(dr, wi)));
+        }
+    }
+}
+
+// Loads 8 consecutive twiddles rounded to float
+FFTKERNELS_TARGET_AVX2
+static inline __m256 loadTwiddlesAVX2(const double* twiddles)
+{
+    const __m128 low = _mm256_cvtpd_ps(_mm256_loadu_pd(twiddles));
+    const __m128 high = _mm256_cvtpd_ps(_mm256_loadu_pd(twiddles + 4));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+// Transposes the 4 outputs of 8 columns so the outputs of each column end up next to each other
+FFTKERNELS_TARGET_AVX2
+static inline void storeInterleavedAVX2(float* out, __m256 o0, __m256 o1, __m256 o2, __m256 o3)
+{
+    // Columns p and p + 4 share a 128-bit lane, the permutes put them back in order
+    const __m256 t0 = _mm256_unpacklo_ps(o0, o1), t1 = _mm256_unpackhi_ps(o0, o1);
+    const __m256 t2 = _mm256_unpacklo_ps(o2, o3), t3 = _mm256_unpackhi_ps(o2, o3);
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(out, _mm256_permute2f128_ps(u0, u1, 0x20));
+    _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(u2, u3, 0x20));
+    _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(u0, u1, 0x31));
+    _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(u2, u3, 0x31));
+}
+
+FFTKERNELS_TARGET_AVX2
+static void stockhamRadix4StageAVX2(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                    size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    const size_t m = n / (4 * stride);
+
+    if (stride == 1 && m >= 8)
+    {
+        for (size_t p = 0; p < m; p += 8)
+        {
+            __m256 c1 = loadTwiddlesAVX2(twiddleCos + p);
+            __m256 s1 = loadTwiddlesAVX2(twiddleSin + p);
+            __m256 c2 = _mm256_sub_ps(_mm256_mul_ps(c1, c1), _mm256_mul_ps(s1, s1));
+            __m256 s2 = _mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(c1, s1));
+            __m256 c3 = _mm256_sub_ps(_mm256_mul_ps(c1, c2), _mm256_mul_ps(s1, s2));
+            __m256 s3 = _mm256_add_ps(_mm256_mul_ps(c1, s2), _mm256_mul_ps(s1, c2));
+
+            __m256 a0r = _mm256_loadu_ps(inReal + p), a0i = _mm256_loadu_ps(inImag + p);
+            __m256 a1r = _mm256_loadu_ps(inReal + p + m), a1i = _mm256_loadu_ps(inImag + p + m);
+            __m256 a2r = _mm256_loadu_ps(inReal + p + 2 * m), a2i = _mm256_loadu_ps(inImag + p + 2 * m);
+            __m256 a3r = _mm256_loadu_ps(inReal + p + 3 * m), a3i = _mm256_loadu_ps(inImag + p + 3 * m);
+
+            FFTKERNELS_RADIX4_BODY(__m256, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps)
+
+            storeInterleavedAVX2(outReal + 4 * p, o0r, o1r, o2r, o3r);
+            storeInterleavedAVX2(outImag + 4 * p, o0i, o1i, o2i, o3i);
+        }
+        return;
+    }
+
+    if (stride < 8)
+    {
+        stockhamRadix4StageSSE2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m256 c1 = _mm256_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m256 s1 = _mm256_set1_ps(static_cast<float>(twiddleSin[p]));
+        const __m256 c2 = _mm256_set1_ps(static_cast<float>(c2s)), s2 = _mm256_set1_ps(static_cast<float>(s2s));
+        const __m256 c3 = _mm256_set1_ps(static_cast<float>(c3s)), s3 = _mm256_set1_ps(static_cast<float>(s3s));
+
+        const float* inRe = inReal + stride * p;
+        const float* inIm = inImag + stride * p;
+        float* outRe = outReal + stride * 4 * p;
+        float* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 8)
+        {
+            __m256 a0r = _mm256_loadu_ps(inRe + q), a0i = _mm256_loadu_ps(inIm + q);
+            __m256 a1r = _mm256_loadu_ps(inRe + q + quarter), a1i = _mm256_loadu_ps(inIm + q + quarter);
+            __m256 a2r = _mm256_loadu_ps(inRe + q + 2 * quarter), a2i = _mm256_loadu_ps(inIm + q + 2 * quarter);
+            __m256 a3r = _mm256_loadu_ps(inRe + q + 3 * quarter), a3i = _mm256_loadu_ps(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m256, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps)
+
+            _mm256_storeu_ps(outRe + q, o0r);
+            _mm256_storeu_ps(outIm + q, o0i);
+            _mm256_storeu_ps(outRe + q + stride, o1r);
+            _mm256_storeu_ps(outIm + q + stride, o1i);
+            _mm256_storeu_ps(outRe + q + 2 * stride, o2r);
+            _mm256_storeu_ps(outIm + q + 2 * stride, o2i);
+            _mm256_storeu_ps(outRe + q + 3 * stride, o3r);
+            _mm256_storeu_ps(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX2
+static float magnitudeAVX2(const float* real, const float* imag, float* out, size_t count)
+{
+    __m256 maxValues = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 re = _mm256_loadu_ps(real + i);
+        __m256 im = _mm256_loadu_ps(imag + i);
+        __m256 mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        _mm256_storeu_ps(out + i, mag);
+        maxValues = _mm256_max_ps(maxValues, mag);
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, maxValues);
+    float maxValue = *std::max_element(lanes, lanes + 8);
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+FFTKERNELS_TARGET_AVX2
+static void scaleAVX2(float* data, float factor, size_t count)
+{
+    const __m256 f = _mm256_set1_ps(factor);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+FFTKERNELS_TARGET_AVX512
+static void stockhamStageAVX512(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    if (stride < 16)
+    {
+        stockhamStageAVX2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (2 * stride);
+    for (size_t p = 0; p < m; p++)
+    {
+        const float* aRe = inReal + stride * p;
+        const float* aIm = inImag + stride * p;
+        const float* bRe = inReal + stride * (p + m);
+        const float* bIm = inImag + stride * (p + m);
+        float* sumRe = outReal + 2 * stride * p;
+        float* sumIm = outImag + 2 * stride * p;
+        float* diffRe = sumRe + stride;
+        float* diffIm = sumIm + stride;
+
+        const __m512 wr = _mm512_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m512 wi = _mm512_set1_ps(static_cast<float>(twiddleSin[p]));
+        for (size_t q = 0; q < stride; q += 16)
+        {
+            __m512 ar = _mm512_loadu_ps(aRe + q);
+            __m512 ai = _mm512_loadu_ps(aIm + q);
+            __m512 br = _mm512_loadu_ps(bRe + q);
+            __m512 bi = _mm512_loadu_ps(bIm + q);
+            __m512 dr = _mm512_sub_ps(ar, br);
+            __m512 di = _mm512_sub_ps(ai, bi);
+
+            _mm512_storeu_ps(sumRe + q, _mm512_add_ps(ar, br));
+            _mm512_storeu_ps(sumIm + q, _mm512_add_ps(ai, bi));
+            _mm512_storeu_ps(diffRe + q, _mm512_add_ps(_mm512_mul_ps(dr, wr), _mm512_mul_ps(di, wi)));
+            _mm512_storeu_ps(diffIm + q, _mm512_sub_ps(_mm512_mul_ps(di, wr), _mm512_mul_ps(dr, wi)));
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static void stockhamRadix4StageAVX512(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                      size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    // stride is a power of 4, so this covers every stage but the first two
+    if (stride < 16)
+    {
+        stockhamRadix4StageAVX2(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+        return;
+    }
+
+    const size_t m = n / (4 * stride);
+    const size_t quarter = stride * m;
+    for (size_t p = 0; p < m; p++)
+    {
+        double c2s, s2s, c3s, s3s;
+        radix4Twiddles(twiddleCos[p], twiddleSin[p], c2s, s2s, c3s, s3s);
+        const __m512 c1 = _mm512_set1_ps(static_cast<float>(twiddleCos[p]));
+        const __m512 s1 = _mm512_set1_ps(static_cast<float>(twiddleSin[p]));
+        const __m512 c2 = _mm512_set1_ps(static_cast<float>(c2s)), s2 = _mm512_set1_ps(static_cast<float>(s2s));
+        const __m512 c3 = _mm512_set1_ps(static_cast<float>(c3s)), s3 = _mm512_set1_ps(static_cast<float>(s3s));
+
+        const float* inRe = inReal + stride * p;
+        const float* inIm = inImag + stride * p;
+        float* outRe = outReal + stride * 4 * p;
+        float* outIm = outImag + stride * 4 * p;
+        for (size_t q = 0; q < stride; q += 16)
+        {
+            __m512 a0r = _mm512_loadu_ps(inRe + q), a0i = _mm512_loadu_ps(inIm + q);
+            __m512 a1r = _mm512_loadu_ps(inRe + q + quarter), a1i = _mm512_loadu_ps(inIm + q + quarter);
+            __m512 a2r = _mm512_loadu_ps(inRe + q + 2 * quarter), a2i = _mm512_loadu_ps(inIm + q + 2 * quarter);
+            __m512 a3r = _mm512_loadu_ps(inRe + q + 3 * quarter), a3i = _mm512_loadu_ps(inIm + q + 3 * quarter);
+
+            FFTKERNELS_RADIX4_BODY(__m512, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps)
+
+            _mm512_storeu_ps(outRe + q, o0r);
+            _mm512_storeu_ps(outIm + q, o0i);
+            _mm512_storeu_ps(outRe + q + stride, o1r);
+            _mm512_storeu_ps(outIm + q + stride, o1i);
+            _mm512_storeu_ps(outRe + q + 2 * stride, o2r);
+            _mm512_storeu_ps(outIm + q + 2 * stride, o2i);
+            _mm512_storeu_ps(outRe + q + 3 * stride, o3r);
+            _mm512_storeu_ps(outIm + q + 3 * stride, o3i);
+        }
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static float magnitudeAVX512(const float* real, const float* imag, float* out, size_t count)
+{
+    __m512 maxValues = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512 re = _mm512_loadu_ps(real + i);
+        __m512 im = _mm512_loadu_ps(imag + i);
+        __m512 mag = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im)));
+        _mm512_storeu_ps(out + i, mag);
+        maxValues = _mm512_max_ps(maxValues, mag);
+    }
+
+    float maxValue = _mm512_reduce_max_ps(maxValues);
+
+    return std::max(maxValue, magnitudeScalar(real + i, imag + i, out + i, count - i));
+}
+
+FFTKERNELS_TARGET_AVX512
+static void scaleAVX512(float* data, float factor, size_t count)
+{
+    const __m512 f = _mm512_set1_ps(factor);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm512_storeu_ps(data + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), f));
+    }
+
+    scaleScalar(data + i, factor, count - i);
+}
+
+// ---------------------------------------------------------------------------------------
+// Phasor DFT kernels, tiles of 4 registers of bins, the remaining bins go to the narrower kernels
+// ---------------------------------------------------------------------------------------
+
+static void phasorDFTSSE2(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                          const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins)
+{
+    size_t k = 0;
+    for (; k + 8 <= numBins; k += 8)
+    {
+        FFTKERNELS_PHASOR_TILE(__m128d, 2, _mm_set1_pd, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+    }
+
+    phasorDFTScalar(samples, numSamples, phasorReal + k, phasorImag + k, stepCos + k, stepSin + k,
+                    sumReal + k, sumImag + k, numBins - k);
+}
+
+FFTKERNELS_TARGET_AVX2
+static void phasorDFTAVX2(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                          const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins)
+{
+    size_t k = 0;
+    for (; k + 16 <= numBins; k += 16)
+    {
+        FFTKERNELS_PHASOR_TILE(__m256d, 4, _mm256_set1_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+    }
+
+    phasorDFTSSE2(samples, numSamples, phasorReal + k, phasorImag + k, stepCos + k, stepSin + k,
+                  sumReal + k, sumImag + k, numBins - k);
+}
+
+FFTKERNELS_TARGET_AVX512
+static void phasorDFTAVX512(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                            const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins)
+{
+    size_t k = 0;
+    for (; k + 32 <= numBins; k += 32)
+    {
+        FFTKERNELS_PHASOR_TILE(__m512d, 8, _mm512_set1_pd, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd)
+    }
+
+    phasorDFTAVX2(samples, numSamples, phasorReal + k, phasorImag + k, stepCos + k, stepSin + k,
+                  sumReal + k, sumImag + k, numBins - k);
+}
+
+// ---------------------------------------------------------------------------------------
+// Decimating FIR kernels, two registers of taps per step, the remaining taps are scalar
+// ---------------------------------------------------------------------------------------
+
+static void firDecimateSSE2(const double* input, size_t numOutputs, size_t factor,
+                            const double* taps, size_t numTaps, double* output)
+{
+    for (size_t m = 0; m < numOutputs; m++)
+    {
+        const double* x = input + m * factor;
+        __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+        size_t t = 0;
+        for (; t + 4 <= numTaps; t += 4)
+        {
+            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(taps + t), _mm_loadu_pd(x + t)));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(taps + t + 2), _mm_loadu_pd(x + t + 2)));
+        }
+
+        const __m128d s = _mm_add_pd(s0, s1);
+        double sum = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+        for (; t < numTaps; t++)
+        {
+            sum += taps[t] * x[t];
+        }
+        output[m] = sum;
+    }
+}
+
+FFTKERNELS_TARGET_AVX2
+static void firDecimateAVX2(const double* input, size_t numOutputs, size_t factor,
+                            const double* taps, size_t numTaps, double* output)
+{
+    for (size_t m = 0; m < numOutputs; m++)
+    {
+        const double* x = input + m * factor;
+        __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+        size_t t = 0;
+        for (; t + 8 <= numTaps; t += 8)
+        {
+            s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(taps + t), _mm256_loadu_pd(x + t)));
+            s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(taps + t + 4), _mm256_loadu_pd(x + t + 4)));
+        }
+
+        const __m256d s = _mm256_add_pd(s0, s1);
+        const __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+        for (; t < numTaps; t++)
+        {
+            sum += taps[t] * x[t];
+        }
+        output[m] = sum;
+    }
+}
+
+FFTKERNELS_TARGET_AVX512
+static void firDecimateAVX512(const double* input, size_t numOutputs, size_t factor,
+                              const double* taps, size_t numTaps, double* output)
+{
+    for (size_t m = 0; m < numOutputs; m++)
+    {
+        const double* x = input + m * factor;
+        __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+        size_t t = 0;
+        for (; t + 16 <= numTaps; t += 16)
+        {
+            s0 = _mm512_add_pd(s0, _mm512_mul_pd(_mm512_loadu_pd(taps + t), _mm512_loadu_pd(x + t)));
+            s1 = _mm512_add_pd(s1, _mm512_mul_pd(_mm512_loadu_pd(taps + t + 8), _mm512_loadu_pd(x + t + 8)));
+        }
+
+        double sum = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+        for (; t < numTaps; t++)
+        {
+            sum += taps[t] * x[t];
+        }
+        output[m] = sum;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Sample format conversion kernels. The integers are widened to 32 bits and converted like
+// the scalar code; stereo frames are split with shuffles, other channel counts are scalar.
+// ---------------------------------------------------------------------------------------
+
+static void decodeSamplesSSE2(const void* input, FFTKernels::SampleEncoding encoding, size_t count, float* output)
+{
+    const __m128 scale = _mm_set1_ps(sampleScale(encoding));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    case FFTKernels::SampleEncoding::Int8:
+    {
+        const unsigned char* in = static_cast<const unsigned char*>(input);
+        const bool isUnsigned = encoding == FFTKernels::SampleEncoding::UInt8;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i v[4];
+            if (isUnsigned)
+            {
+                const __m128i lo = _mm_unpacklo_epi8(x, zero);
+                const __m128i hi = _mm_unpackhi_epi8(x, zero);
+                const __m128i offset = _mm_set1_epi32(128);
+                v[0] = _mm_sub_epi32(_mm_unpacklo_epi16(lo, zero), offset);
+                v[1] = _mm_sub_epi32(_mm_unpackhi_epi16(lo, zero), offset);
+                v[2] = _mm_sub_epi32(_mm_unpacklo_epi16(hi, zero), offset);
+                v[3] = _mm_sub_epi32(_mm_unpackhi_epi16(hi, zero), offset);
+            }
+            else
+            {
+                // Each byte lands in the top of a 32 bit lane, the arithmetic shift extends its sign
+                const __m128i lo = _mm_unpacklo_epi8(x, x);
+                const __m128i hi = _mm_unpackhi_epi8(x, x);
+                v[0] = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24);
+                v[1] = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24);
+                v[2] = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24);
+                v[3] = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24);
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                _mm_storeu_ps(output + i + 4 * j, _mm_mul_ps(_mm_cvtepi32_ps(v[j]), scale));
+            }
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int16:
+    {
+        const short* in = static_cast<const short*>(input);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int32:
+    {
+        const int* in = static_cast<const int*>(input);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    const size_t bytesPerValue = encoding == FFTKernels::SampleEncoding::UInt8 || encoding == FFTKernels::SampleEncoding::Int8 ? 1
+                               : encoding == FFTKernels::SampleEncoding::Int16 ? 2 : 4;
+    decodeSamplesScalar(static_cast<const char*>(input) + i * bytesPerValue, encoding, count - i, output + i);
+}
+
+static void mixChannelsSSE2(const float* input, size_t channels, size_t numFrames, int channel, float* output)
+{
+    if (channels != 2)
+    {
+        mixChannelsScalar(input, channels, numFrames, channel, output);
+        return;
+    }
+
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t f = 0;
+    for (; f + 4 <= numFrames; f += 4)
+    {
+        const __m128 a = _mm_loadu_ps(input + 2 * f);
+        const __m128 b = _mm_loadu_ps(input + 2 * f + 4);
+        const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 out = channel == 0 ? left : channel == 1 ? right : _mm_mul_ps(_mm_add_ps(left, right), half);
+        _mm_storeu_ps(output + f, out);
+    }
+
+    mixChannelsScalar(input + 2 * f, channels, numFrames - f, channel, output + f);
+}
+
+// Converts 8 floats to 16 bits with the same clamping and rounding as floatToShortValue()
+static inline __m128i floatToShort8SSE2(__m128 a, __m128 b)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 low = _mm_set1_ps(-32768.0f);
+    const __m128 high = _mm_set1_ps(32767.0f);
+    a = _mm_min_ps(high, _mm_max_ps(low, _mm_mul_ps(a, scale)));
+    b = _mm_min_ps(high, _mm_max_ps(low, _mm_mul_ps(b, scale)));
+    return _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+}
+
+static void floatToShortSSE2(const float* input, size_t count, short* output)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i x = floatToShort8SSE2(_mm_loadu_ps(input + i), _mm_loadu_ps(input + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), x);
+    }
+
+    floatToShortScalar(input + i, count - i, output + i);
+}
+
+FFTKERNELS_TARGET_AVX2
+static void decodeSamplesAVX2(const void* input, FFTKernels::SampleEncoding encoding, size_t count, float* output)
+{
+    const __m256 scale = _mm256_set1_ps(sampleScale(encoding));
+    size_t i = 0;
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    {
+        const unsigned char* in = static_cast<const unsigned char*>(input);
+        const __m256i offset = _mm256_set1_epi32(128);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(x, offset)), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int8:
+    {
+        const signed char* in = static_cast<const signed char*>(input);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i x = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int16:
+    {
+        const short* in = static_cast<const short*>(input);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int32:
+    {
+        const int* in = static_cast<const int*>(input);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    const size_t bytesPerValue = encoding == FFTKernels::SampleEncoding::UInt8 || encoding == FFTKernels::SampleEncoding::Int8 ? 1
+                               : encoding == FFTKernels::SampleEncoding::Int16 ? 2 : 4;
+    decodeSamplesScalar(static_cast<const char*>(input) + i * bytesPerValue, encoding, count - i, output + i);
+}
+
+FFTKERNELS_TARGET_AVX2
+static void mixChannelsAVX2(const float* input, size_t channels, size_t numFrames, int channel, float* output)
+{
+    if (channels != 2)
+    {
+        mixChannelsScalar(input, channels, numFrames, channel, output);
+        return;
+    }
+
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t f = 0;
+    for (; f + 8 <= numFrames; f += 8)
+    {
+        // The shuffles work within 128 bit lanes, the permute puts the 4 pairs of frames back in order
+        const __m256 a = _mm256_loadu_ps(input + 2 * f);
+        const __m256 b = _mm256_loadu_ps(input + 2 * f + 8);
+        const __m256 left = _mm256_castpd_ps(_mm256_permute4x64_pd(
+            _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+        const __m256 right = _mm256_castpd_ps(_mm256_permute4x64_pd(
+            _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        const __m256 out = channel == 0 ? left : channel == 1 ? right : _mm256_mul_ps(_mm256_add_ps(left, right), half);
+        _mm256_storeu_ps(output + f, out);
+    }
+
+    mixChannelsScalar(input + 2 * f, channels, numFrames - f, channel, output + f);
+}
+
+FFTKERNELS_TARGET_AVX2
+static void floatToShortAVX2(const float* input, size_t count, short* output)
+{
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 low = _mm256_set1_ps(-32768.0f);
+    const __m256 high = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 x = _mm256_min_ps(high, _mm256_max_ps(low, _mm256_mul_ps(_mm256_loadu_ps(input + i), scale)));
+        const __m256i v = _mm256_cvtps_epi32(x);
+        const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+    }
+
+    floatToShortScalar(input + i, count - i, output + i);
+}
+
+FFTKERNELS_TARGET_AVX512
+static void decodeSamplesAVX512(const void* input, FFTKernels::SampleEncoding encoding, size_t count, float* output)
+{
+    const __m512 scale = _mm512_set1_ps(sampleScale(encoding));
+    size_t i = 0;
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    {
+        const unsigned char* in = static_cast<const unsigned char*>(input);
+        const __m512i offset = _mm512_set1_epi32(128);
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512i x = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(x, offset)), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int8:
+    {
+        const signed char* in = static_cast<const signed char*>(input);
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512i x = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int16:
+    {
+        const short* in = static_cast<const short*>(input);
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512i x = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    case FFTKernels::SampleEncoding::Int32:
+    {
+        const int* in = static_cast<const int*>(input);
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512i x = _mm512_loadu_si512(in + i);
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    const size_t bytesPerValue = encoding == FFTKernels::SampleEncoding::UInt8 || encoding == FFTKernels::SampleEncoding::Int8 ? 1
+                               : encoding == FFTKernels::SampleEncoding::Int16 ? 2 : 4;
+    decodeSamplesScalar(static_cast<const char*>(input) + i * bytesPerValue, encoding, count - i, output + i);
+}
+
+FFTKERNELS_TARGET_AVX512
+static void mixChannelsAVX512(const float* input, size_t channels, size_t numFrames, int channel, float* output)
+{
+    if (channels != 2)
+    {
+        mixChannelsScalar(input, channels, numFrames, channel, output);
+        return;
+    }
+
+    const __m512i evenIndex = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+    const __m512i oddIndex = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    size_t f = 0;
+    for (; f + 16 <= numFrames; f += 16)
+    {
+        const __m512 a = _mm512_loadu_ps(input + 2 * f);
+        const __m512 b = _mm512_loadu_ps(input + 2 * f + 16);
+        const __m512 left = _mm512_permutex2var_ps(a, evenIndex, b);
+        const __m512 right = _mm512_permutex2var_ps(a, oddIndex, b);
+        const __m512 out = channel == 0 ? left : channel == 1 ? right : _mm512_mul_ps(_mm512_add_ps(left, right), half);
+        _mm512_storeu_ps(output + f, out);
+    }
+
+    mixChannelsScalar(input + 2 * f, channels, numFrames - f, channel, output + f);
+}
+
+FFTKERNELS_TARGET_AVX512
+static void floatToShortAVX512(const float* input, size_t count, short* output)
+{
+    const __m512 scale = _mm512_set1_ps(32768.0f);
+    const __m512 low = _mm512_set1_ps(-32768.0f);
+    const __m512 high = _mm512_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m512 x = _mm512_min_ps(high, _mm512_max_ps(low, _mm512_mul_ps(_mm512_loadu_ps(input + i), scale)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(x)));
+    }
+
+    floatToShortScalar(input + i, count - i, output + i);
+}
+
+#undef FFTKERNELS_PHASOR_TILE
+#undef FFTKERNELS_RADIX4_BODY
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // FFTKERNELS_X86
+
+// ---------------------------------------------------------------------------------------
+// Runtime dispatch
+// ---------------------------------------------------------------------------------------
+
+FFTKernels::InstructionSet FFTKernels::detectInstructionSet()
+{
+#if defined(FFTKERNELS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    // The OS must also save the YMM (and ZMM) registers on context switches
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false;
+    bool avx512 = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = avx && ymmEnabled && (info[1] & (1 << 5)) != 0;
+        avx512 = zmmEnabled && (info[1] & (1 << 16)) != 0;
+    }
+
+    if (avx512)
+        return InstructionSet::AVX512;
+    if (avx2)
+        return InstructionSet::AVX2;
+    if (sse2)
+        return InstructionSet::SSE2;
+#elif defined(FFTKERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return InstructionSet::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return InstructionSet::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return InstructionSet::SSE2;
+#endif
+
+    return InstructionSet::Scalar;
+}
+
+FFTKernels::Dispatch FFTKernels::dispatchFor(InstructionSet set)
+{
+    switch (set)
+    {
+#ifdef FFTKERNELS_X86
+    case InstructionSet::AVX512:
+        return { set, butterflyStageAVX512, stockhamStageAVX512, stockhamRadix4StageAVX512, magnitudeAVX512, scaleAVX512,
+                 stockhamStageAVX512, stockhamRadix4StageAVX512, magnitudeAVX512, scaleAVX512, phasorDFTAVX512,
+                 firDecimateAVX512, decodeSamplesAVX512, mixChannelsAVX512, floatToShortAVX512 };
+    case InstructionSet::AVX2:
+        return { set, butterflyStageAVX2, stockhamStageAVX2, stockhamRadix4StageAVX2, magnitudeAVX2, scaleAVX2,
+                 stockhamStageAVX2, stockhamRadix4StageAVX2, magnitudeAVX2, scaleAVX2, phasorDFTAVX2,
+                 firDecimateAVX2, decodeSamplesAVX2, mixChannelsAVX2, floatToShortAVX2 };
+    case InstructionSet::SSE2:
+        return { set, butterflyStageSSE2, stockhamStageSSE2, stockhamRadix4StageSSE2, magnitudeSSE2, scaleSSE2,
+                 stockhamStageSSE2, stockhamRadix4StageSSE2, magnitudeSSE2, scaleSSE2, phasorDFTSSE2,
+                 firDecimateSSE2, decodeSamplesSSE2, mixChannelsSSE2, floatToShortSSE2 };
+#endif
+    default:
+        return { InstructionSet::Scalar, butterflyStageScalar, stockhamStageScalar<double>, stockhamRadix4StageScalar<double>,
+                 magnitudeScalar<double>, scaleScalar<double>, stockhamStageScalar<float>, stockhamRadix4StageScalar<float>,
+                 magnitudeScalar<float>, scaleScalar<float>, phasorDFTScalar, firDecimateScalar,
+                 decodeSamplesScalar, mixChannelsScalar, floatToShortScalar };
+    }
+}
+
+FFTKernels::Dispatch& FFTKernels::dispatch()
+{
+    // Initialized once, thread-safe since C++11
+    static Dispatch table = dispatchFor(detectInstructionSet());
+    return table;
+}
+
+FFTKernels::InstructionSet FFTKernels::instructionSet()
+{
+    return dispatch().set;
+}
+
+void FFTKernels::setInstructionSet(InstructionSet set)
+{
+    const InstructionSet supported = detectInstructionSet();
+    if (static_cast<int>(set) > static_cast<int>(supported))
+        set = supported;
+
+    dispatch() = dispatchFor(set);
+}
+
+const char* FFTKernels::instructionSetName(InstructionSet set)
+{
+    switch (set)
+    {
+    case InstructionSet::SSE2:
+        return "SSE2";
+    case InstructionSet::AVX2:
+        return "AVX2";
+    case InstructionSet::AVX512:
+        return "AVX-512";
+    default:
+        return "Scalar";
+    }
+}
+
+void FFTKernels::butterflyStage(double* real, double* imag, size_t n, size_t halfsize,
+                                const double* twiddleCos, const double* twiddleSin)
+{
+    dispatch().butterflyStage(real, imag, n, halfsize, twiddleCos, twiddleSin);
+}
+
+void FFTKernels::stockhamStage(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                               size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    dispatch().stockhamStage(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+}
+
+void FFTKernels::stockhamRadix4Stage(const double* inReal, const double* inImag, double* outReal, double* outImag,
+                                     size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    dispatch().stockhamRadix4Stage(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+}
+
+double FFTKernels::magnitude(const double* real, const double* imag, double* out, size_t count)
+{
+    return dispatch().magnitude(real, imag, out, count);
+}
+
+void FFTKernels::scale(double* data, double factor, size_t count)
+{
+    dispatch().scale(data, factor, count);
+}
+
+void FFTKernels::stockhamStage(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                               size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    dispatch().stockhamStageFloat(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+}
+
+void FFTKernels::stockhamRadix4Stage(const float* inReal, const float* inImag, float* outReal, float* outImag,
+                                     size_t n, size_t stride, const double* twiddleCos, const double* twiddleSin)
+{
+    dispatch().stockhamRadix4StageFloat(inReal, inImag, outReal, outImag, n, stride, twiddleCos, twiddleSin);
+}
+
+float FFTKernels::magnitude(const float* real, const float* imag, float* out, size_t count)
+{
+    return dispatch().magnitudeFloat(real, imag, out, count);
+}
+
+void FFTKernels::scale(float* data, float factor, size_t count)
+{
+    dispatch().scaleFloat(data, factor, count);
+}
+
+void FFTKernels::phasorDFT(const short* samples, size_t numSamples, double* phasorReal, double* phasorImag,
+                           const double* stepCos, const double* stepSin, double* sumReal, double* sumImag, size_t numBins)
+{
+    dispatch().phasorDFT(samples, numSamples, phasorReal, phasorImag, stepCos, stepSin, sumReal, sumImag, numBins);
+}
+
+void FFTKernels::firDecimate(const double* input, size_t numOutputs, size_t factor,
+                             const double* taps, size_t numTaps, double* output)
+{
+    dispatch().firDecimate(input, numOutputs, factor, taps, numTaps, output);
+}
+
+void FFTKernels::decodeSamples(const void* input, SampleEncoding encoding, size_t count, float* output)
+{
+    dispatch().decodeSamples(input, encoding, count, output);
+}
+
+void FFTKernels::mixChannels(const float* input, size_t channels, size_t numFrames, int channel, float* output)
+{
+    dispatch().mixChannels(input, channels, numFrames, channel, output);
+}
+
+void FFTKernels::floatToShort(const float* input, size_t count, short* output)
+{
+    dispatch().floatToShort(input, count, output);
+}
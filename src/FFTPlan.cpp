@@ -0,0 +1,1023 @@
+#define _USE_MATH_DEFINES
+
+#include "FFTPlan.h"
+#include "FFTKernels.h"
+#include "FixedFFT.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include <QtCore/QThread>
+
+QMutex FFTPlan::s_cacheMutex;
+std::map<size_t, std::shared_ptr<const FFTPlan>> FFTPlan::s_cache;
+std::atomic<int> FFTPlan::s_radix2Engine{ static_cast<int>(FFTPlan::Radix2Engine::Stockham) };
+std::atomic<int> FFTPlan::s_precision{ static_cast<int>(FFTPlan::Precision::Double) };
+
+namespace
+{
+    // Memory a batch of transformRealBatch() may use, the packed frames and the Stockham
+    // scratch buffers, so its stages run in the L2 cache
+    const size_t BATCH_CACHE_BYTES = 512 * 1024;
+
+    // cos/sin of 2*pi*k*q/p for the odd radices of the mixed-radix algorithm
+    struct SmallDFTTable
+    {
+        double cos[8][8];
+        double sin[8][8];
+    };
+
+    const SmallDFTTable& smallDFTTable(int radix)
+    {
+        static const std::array<SmallDFTTable, 8> tables = []()
+        {
+            std::array<SmallDFTTable, 8> result = {};
+            for (int p = 3; p < 8; p += 2)
+            {
+                for (int k = 0; k < p; k++)
+                {
+                    for (int q = 0; q < p; q++)
+                    {
+                        result[p].cos[k][q] = std::cos(2 * M_PI * ((k * q) % p) / p);
+                        result[p].sin[k][q] = std::sin(2 * M_PI * ((k * q) % p) / p);
+                    }
+                }
+            }
+            return result;
+        }();
+
+        return tables[radix];
+    }
+
+    bool interrupted(QThread* thread)
+    {
+        return thread && thread->isInterruptionRequested();
+    }
+
+    template <size_t N>
+    void selectFixedFFT(void (*&transform)(double*, double*), void (*&transformFloat)(float*, float*))
+    {
+        transform = &FixedFFT<N>::template transform<double>;
+        transformFloat = &FixedFFT<N>::template transform<float>;
+    }
+}
+
+FFTPlan::FFTPlan(size_t n)
+    : m_size(n)
+    , m_algorithm(Algorithm::Radix2)
+    , m_fixedTransform(nullptr)
+    , m_fixedTransformFloat(nullptr)
+{
+    if (n == 0)
+    {
+        throw std::invalid_argument("FFTPlan::FFTPlan() Length must be positive");
+    }
+
+    if (paddedSize(n) == n)
+    {
+        initRadix2();
+    }
+    else
+    {
+        std::vector<int> factors = smoothFactors(n);
+        if (!factors.empty())
+            initMixedRadix(factors);
+        else
+            initBluestein();
+
+        // Twiddles for untangling a real transform computed at half length
+        if (n % 2 == 0)
+        {
+            m_realCos.resize(n / 4 + 1);
+            m_realSin.resize(n / 4 + 1);
+            for (size_t k = 0; k <= n / 4; k++)
+            {
+                m_realCos[k] = std::cos(2 * M_PI * k / n);
+                m_realSin[k] = std::sin(2 * M_PI * k / n);
+            }
+        }
+    }
+}
+
+void FFTPlan::initRadix2()
+{
+    const size_t n = m_size;
+    m_algorithm = Algorithm::Radix2;
+
+    // Compute the number of total levels for the FFT using bit shifting
+    int levels = 0;
+    for (size_t temp = n; temp > 1U; temp >>= 1)
+    {
+        levels++;
+    }
+
+    // cos/sin calculations, done once per size instead of once per transform.
+    // The last level is computed directly, every other level picks every (n / size)-th entry
+    // from it, which are the same values the strided table lookup used to read.
+    m_stageCos.resize(n - 1);
+    m_stageSin.resize(n - 1);
+    const size_t lastStage = n / 2 - (n > 1 ? 1 : 0);
+    for (size_t i = 0; i < n / 2; i++)
+    {
+        m_stageCos[lastStage + i] = std::cos(2 * M_PI * i / n);
+        m_stageSin[lastStage + i] = std::sin(2 * M_PI * i / n);
+    }
+
+    for (size_t halfsize = 1; halfsize < n / 2; halfsize *= 2)
+    {
+        const size_t tablestep = n / (2 * halfsize);
+        for (size_t j = 0; j < halfsize; j++)
+        {
+            m_stageCos[halfsize - 1 + j] = m_stageCos[lastStage + j * tablestep];
+            m_stageSin[halfsize - 1 + j] = m_stageSin[lastStage + j * tablestep];
+        }
+    }
+
+    // Bit-reversed addressing permutation
+    // https://en.wikipedia.org/wiki/Bit-reversal_permutation
+    // rev(i) is rev(i / 2) shifted right once, with the LSB of i moved to the top bit.
+    m_permutation.resize(n);
+    m_permutation[0] = 0;
+    for (size_t i = 1; i < n; i++)
+    {
+        m_permutation[i] = static_cast<uint32_t>((m_permutation[i >> 1] >> 1) | ((i & 1U) << (levels - 1)));
+    }
+
+    // Frame sizes with a compile-time specialized transform
+    switch (n)
+    {
+    case 256:
+        selectFixedFFT<256>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    case 512:
+        selectFixedFFT<512>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    case 1024:
+        selectFixedFFT<1024>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    case 2048:
+        selectFixedFFT<2048>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    case 4096:
+        selectFixedFFT<4096>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    case 8192:
+        selectFixedFFT<8192>(m_fixedTransform, m_fixedTransformFloat);
+        break;
+    default:
+        break;
+    }
+}
+
+void FFTPlan::initMixedRadix(const std::vector<int>& factors)
+{
+    m_algorithm = Algorithm::MixedRadix;
+    m_factors = factors;
+
+    // Digit-reversal permutation. Stage s combines factors[s] interleaved sub-transforms of
+    // the previous stages into one, so adding a factor p as the new outermost digit maps
+    // position q * M + t to input index q + p * previous[t].
+    m_permutation.assign(1, 0);
+    for (int p : m_factors)
+    {
+        const size_t m = m_permutation.size();
+        std::vector<uint32_t> next(m * p);
+        for (int q = 0; q < p; q++)
+        {
+            for (size_t t = 0; t < m; t++)
+            {
+                next[q * m + t] = static_cast<uint32_t>(q + static_cast<size_t>(p) * m_permutation[t]);
+            }
+        }
+        m_permutation.swap(next);
+    }
+
+    // Twiddles exp(-2*pi*i*j*q/L) of every stage. (j * q) is reduced modulo L first so the
+    // angle stays accurate for long transforms.
+    size_t subLength = 1;
+    for (int p : m_factors)
+    {
+        const size_t length = subLength * p;
+        m_twiddleOffsets.push_back(m_twiddleCos.size());
+        for (size_t j = 0; j < subLength; j++)
+        {
+            for (int q = 1; q < p; q++)
+            {
+                const double angle = 2 * M_PI * static_cast<double>((j * q) % length) / length;
+                m_twiddleCos.push_back(std::cos(angle));
+                m_twiddleSin.push_back(std::sin(angle));
+            }
+        }
+        subLength = length;
+    }
+}
+
+void FFTPlan::initBluestein()
+{
+    const size_t n = m_size;
+    m_algorithm = Algorithm::Bluestein;
+
+    // The linear convolution of two length n sequences needs at least 2n - 1 points
+    const size_t m = paddedSize(2 * n - 1);
+    m_convolutionPlan = forSize(m);
+
+    // Chirp w[k] = exp(-i*pi*k^2/n). k^2 is reduced modulo 2n, where the chirp repeats,
+    // to keep the angle accurate for long transforms.
+    m_chirpCos.resize(n);
+    m_chirpSin.resize(n);
+    for (size_t k = 0; k < n; k++)
+    {
+        const unsigned long long kk = (static_cast<unsigned long long>(k) * k) % (2ULL * n);
+        const double angle = M_PI * static_cast<double>(kk) / n;
+        m_chirpCos[k] = std::cos(angle);
+        m_chirpSin[k] = std::sin(angle);
+    }
+
+    // Filter conj(w[k]) wrapped around so the circular convolution matches the linear one
+    m_filterReal.assign(m, 0.0);
+    m_filterImag.assign(m, 0.0);
+    m_filterReal[0] = m_chirpCos[0];
+    m_filterImag[0] = m_chirpSin[0];
+    for (size_t k = 1; k < n; k++)
+    {
+        m_filterReal[k] = m_filterReal[m - k] = m_chirpCos[k];
+        m_filterImag[k] = m_filterImag[m - k] = m_chirpSin[k];
+    }
+
+    m_convolutionPlan->execute(m_filterReal, m_filterImag, nullptr);
+}
+
+std::vector<int> FFTPlan::smoothFactors(size_t n)
+{
+    std::vector<int> factors;
+
+    // Radix 4 first since it needs the fewest operations per element
+    while (n % 4 == 0)
+    {
+        factors.push_back(4);
+        n /= 4;
+    }
+
+    for (int p : { 2, 3, 5, 7 })
+    {
+        while (n % p == 0)
+        {
+            factors.push_back(p);
+            n /= p;
+        }
+    }
+
+    if (n != 1)
+        factors.clear();
+
+    return factors;
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::forSize(size_t n)
+{
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        auto it = s_cache.find(n);
+        if (it != s_cache.end())
+            return it->second;
+    }
+
+    // Build outside the lock so workers asking for other sizes are not held up.
+    std::shared_ptr<const FFTPlan> plan(new FFTPlan(n));
+
+    // Whole-file transforms would otherwise keep hundreds of megabytes of tables for good
+    if (n > MAX_CACHED_SIZE)
+        return plan;
+
+    QMutexLocker locker(&s_cacheMutex);
+
+    // Another thread may have built the same plan in the meantime, keep the first one.
+    auto inserted = s_cache.emplace(n, plan);
+    return inserted.first->second;
+}
+
+size_t FFTPlan::paddedSize(size_t n)
+{
+    size_t powOf2 = 1;
+    while (powOf2 < n)
+    {
+        powOf2 <<= 1;
+    }
+
+    return powOf2;
+}
+
+void FFTPlan::clearCache()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.clear();
+}
+
+size_t FFTPlan::size() const
+{
+    return m_size;
+}
+
+FFTPlan::Algorithm FFTPlan::algorithm() const
+{
+    return m_algorithm;
+}
+
+size_t FFTPlan::scratchSize() const
+{
+    switch (m_algorithm)
+    {
+    case Algorithm::MixedRadix:
+        return m_size;
+    case Algorithm::Bluestein:
+        return m_convolutionPlan->size();
+    default:
+        return radix2Engine() == Radix2Engine::Stockham || precision() == Precision::Single ? m_size : 0;
+    }
+}
+
+FFTPlan::Radix2Engine FFTPlan::radix2Engine()
+{
+    return static_cast<Radix2Engine>(s_radix2Engine.load(std::memory_order_relaxed));
+}
+
+void FFTPlan::setRadix2Engine(Radix2Engine engine)
+{
+    s_radix2Engine.store(static_cast<int>(engine), std::memory_order_relaxed);
+}
+
+const char* FFTPlan::radix2EngineName(Radix2Engine engine)
+{
+    switch (engine)
+    {
+    case Radix2Engine::Stockham:
+        return "Stockham";
+    default:
+        return "In-place";
+    }
+}
+
+FFTPlan::Precision FFTPlan::precision()
+{
+    return static_cast<Precision>(s_precision.load(std::memory_order_relaxed));
+}
+
+void FFTPlan::setPrecision(Precision precision)
+{
+    s_precision.store(static_cast<int>(precision), std::memory_order_relaxed);
+}
+
+const char* FFTPlan::precisionName(Precision precision)
+{
+    switch (precision)
+    {
+    case Precision::Single:
+        return "float32";
+    default:
+        return "float64";
+    }
+}
+
+bool FFTPlan::transform(std::vector<double>& real, std::vector<double>& imag) const
+{
+    return transformComplex(real, imag);
+}
+
+bool FFTPlan::transform(std::vector<float>& real, std::vector<float>& imag) const
+{
+    return transformComplex(real, imag);
+}
+
+template <typename T>
+bool FFTPlan::transformComplex(std::vector<T>& real, std::vector<T>& imag) const
+{
+    if (real.size() != m_size || imag.size() != m_size)
+    {
+        throw std::invalid_argument("FFTPlan::transform() Size mismatch for real/imag vectors");
+    }
+
+    return execute(real, imag, QThread::currentThread());
+}
+
+template <typename T>
+bool FFTPlan::execute(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const
+{
+    switch (m_algorithm)
+    {
+    case Algorithm::MixedRadix:
+        return transformMixedRadix(real, imag, thread);
+    case Algorithm::Bluestein:
+        return transformBluestein(real, imag, thread);
+    default:
+        return transformRadix2(real.data(), imag.data(), thread);
+    }
+}
+
+// Implementation of the Cooley-Tukey FFT algorithm, modified for our use case,
+// adapted from https://www.nayuki.io/page/free-small-fft-in-multiple-languages
+bool FFTPlan::transformRadix2(double* real, double* imag, QThread* thread) const
+{
+    if (radix2Engine() == Radix2Engine::Stockham)
+    {
+        if (m_fixedTransform)
+        {
+            m_fixedTransform(real, imag);
+            return !interrupted(thread);
+        }
+
+        return transformStockham(real, imag, thread);
+    }
+
+    const size_t n = m_size;
+
+    // Swap every element with its bit-reversed partner
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t j = m_permutation[i];
+        if (j > i)
+        {
+            std::swap(real[i], real[j]);
+            std::swap(imag[i], imag[j]);
+        }
+    }
+
+    // Cooley-Tukey decimation-in-time radix-2 FFT algorithm, one vectorized kernel call per level
+    for (size_t halfsize = 1; halfsize < n; halfsize *= 2)
+    {
+        // Checking once per level keeps the butterflies free of calls
+        if (interrupted(thread))
+        {
+            return false;
+        }
+
+        FFTKernels::butterflyStage(real, imag, n, halfsize,
+                                   &m_stageCos[halfsize - 1], &m_stageSin[halfsize - 1]);
+    }
+
+    return !interrupted(thread);
+}
+
+bool FFTPlan::transformRadix2(float* real, float* imag, QThread* thread) const
+{
+    // There are no in-place kernels for single precision
+    if (m_fixedTransformFloat)
+    {
+        m_fixedTransformFloat(real, imag);
+        return !interrupted(thread);
+    }
+
+    return transformStockham(real, imag, thread);
+}
+
+template <typename T>
+bool FFTPlan::transformStockham(T* real, T* imag, QThread* thread, size_t batch) const
+{
+    // Element j of transform b sits at j * batch + b. Every stage then has the same shape as for
+    // one transform with each stride multiplied by batch, so starting at stride batch is enough.
+    const size_t n = m_size * batch;
+
+    // Large buffers come straight from the OS and every page would fault again on each call,
+    // so each thread keeps its scratch buffers for the next transform
+    thread_local std::vector<T> scratchReal;
+    thread_local std::vector<T> scratchImag;
+    if (scratchReal.size() < n)
+    {
+        scratchReal.resize(n);
+        scratchImag.resize(n);
+    }
+
+    // Each stage reads one buffer and writes the other. Radix-4 stages split blocks of length
+    // L = n / stride into quarters, using w = exp(-2*pi*i*p/L) from the level with half-size L/2.
+    // Odd powers of 2 finish with one radix-2 stage, where every twiddle is 1.
+    T* inReal = real;
+    T* inImag = imag;
+    T* outReal = scratchReal.data();
+    T* outImag = scratchImag.data();
+    for (size_t stride = batch; stride < n; )
+    {
+        if (interrupted(thread))
+        {
+            return false;
+        }
+
+        const size_t length = n / stride;
+        if (length >= 4)
+        {
+            FFTKernels::stockhamRadix4Stage(inReal, inImag, outReal, outImag, n, stride,
+                                            &m_stageCos[length / 2 - 1], &m_stageSin[length / 2 - 1]);
+            stride *= 4;
+        }
+        else
+        {
+            FFTKernels::stockhamStage(inReal, inImag, outReal, outImag, n, stride,
+                                      &m_stageCos[0], &m_stageSin[0]);
+            stride *= 2;
+        }
+
+        std::swap(inReal, outReal);
+        std::swap(inImag, outImag);
+    }
+
+    // The result is in natural order already, it only has to end up in the caller's buffer
+    if (inReal != real)
+    {
+        std::copy(inReal, inReal + n, real);
+        std::copy(inImag, inImag + n, imag);
+    }
+
+    return !interrupted(thread);
+}
+
+// Decimation-in-time mixed-radix FFT. After the digit-reversal permutation, stage s turns
+// every run of L = subLength * p elements into the length L transform of the matching
+// input subsequence, by combining p interleaved transforms of length subLength.
+template <typename T>
+bool FFTPlan::transformMixedRadix(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const
+{
+    const size_t n = m_size;
+
+    // The permutation is not an involution like bit reversal, so gather into scratch vectors.
+    // They are swapped with the result below, each thread then keeps the old input vectors.
+    thread_local std::vector<T> re;
+    thread_local std::vector<T> im;
+    re.resize(n);
+    im.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        re[i] = real[m_permutation[i]];
+        im[i] = imag[m_permutation[i]];
+    }
+
+    size_t subLength = 1;
+    for (size_t stage = 0; stage < m_factors.size(); stage++)
+    {
+        if (interrupted(thread))
+        {
+            return false;
+        }
+
+        const int p = m_factors[stage];
+        const size_t length = subLength * p;
+        const double* twCos = &m_twiddleCos[m_twiddleOffsets[stage]];
+        const double* twSin = &m_twiddleSin[m_twiddleOffsets[stage]];
+        const SmallDFTTable& table = smallDFTTable(p);
+
+        T xr[8];
+        T xi[8];
+
+        for (size_t block = 0; block < n; block += length)
+        {
+            for (size_t j = 0; j < subLength; j++)
+            {
+                // Load the p inputs and multiply input q by exp(-2*pi*i*j*q/L)
+                const size_t base = block + j;
+                xr[0] = re[base];
+                xi[0] = im[base];
+                for (int q = 1; q < p; q++)
+                {
+                    const size_t index = base + q * subLength;
+                    const T c = static_cast<T>(twCos[j * (p - 1) + q - 1]);
+                    const T s = static_cast<T>(twSin[j * (p - 1) + q - 1]);
+                    xr[q] = re[index] * c + im[index] * s;
+                    xi[q] = im[index] * c - re[index] * s;
+                }
+
+                // Length p DFT of the twiddled inputs
+                switch (p)
+                {
+                case 2:
+                {
+                    re[base] = xr[0] + xr[1];
+                    im[base] = xi[0] + xi[1];
+                    re[base + subLength] = xr[0] - xr[1];
+                    im[base + subLength] = xi[0] - xi[1];
+                    break;
+                }
+                case 4:
+                {
+                    const T t0r = xr[0] + xr[2], t0i = xi[0] + xi[2];
+                    const T t1r = xr[0] - xr[2], t1i = xi[0] - xi[2];
+                    const T t2r = xr[1] + xr[3], t2i = xi[1] + xi[3];
+                    const T t3r = xr[1] - xr[3], t3i = xi[1] - xi[3];
+                    re[base] = t0r + t2r;
+                    im[base] = t0i + t2i;
+                    re[base + subLength] = t1r + t3i;
+                    im[base + subLength] = t1i - t3r;
+                    re[base + 2 * subLength] = t0r - t2r;
+                    im[base + 2 * subLength] = t0i - t2i;
+                    re[base + 3 * subLength] = t1r - t3i;
+                    im[base + 3 * subLength] = t1i + t3r;
+                    break;
+                }
+                default:
+                {
+                    // Odd radix: pair inputs q and p - q, whose twiddles are complex conjugates
+                    const int h = (p - 1) / 2;
+                    T sumR[4], sumI[4], difR[4], difI[4];
+                    T y0r = xr[0];
+                    T y0i = xi[0];
+                    for (int q = 1; q <= h; q++)
+                    {
+                        sumR[q] = xr[q] + xr[p - q];
+                        sumI[q] = xi[q] + xi[p - q];
+                        difR[q] = xr[q] - xr[p - q];
+                        difI[q] = xi[q] - xi[p - q];
+                        y0r += sumR[q];
+                        y0i += sumI[q];
+                    }
+
+                    for (int k = 1; k <= h; k++)
+                    {
+                        T sr = xr[0], si = xi[0], tr = 0, ti = 0;
+                        for (int q = 1; q <= h; q++)
+                        {
+                            const T c = static_cast<T>(table.cos[k][q]);
+                            const T s = static_cast<T>(table.sin[k][q]);
+                            sr += sumR[q] * c;
+                            si += sumI[q] * c;
+                            tr += difR[q] * s;
+                            ti += difI[q] * s;
+                        }
+                        re[base + k * subLength] = sr + ti;
+                        im[base + k * subLength] = si - tr;
+                        re[base + (p - k) * subLength] = sr - ti;
+                        im[base + (p - k) * subLength] = si + tr;
+                    }
+
+                    re[base] = y0r;
+                    im[base] = y0i;
+                    break;
+                }
+                }
+            }
+        }
+
+        subLength = length;
+    }
+
+    real.swap(re);
+    imag.swap(im);
+
+    return !interrupted(thread);
+}
+
+// Bluestein's algorithm: with w[k] = exp(-i*pi*k^2/n), X[k] = w[k] * sum(x[j] * w[j] * conj(w[k - j])),
+// a convolution computed with a power of 2 FFT of at least 2n - 1 points.
+template <typename T>
+bool FFTPlan::transformBluestein(std::vector<T>& real, std::vector<T>& imag, QThread* thread) const
+{
+    const size_t n = m_size;
+    const size_t m = m_convolutionPlan->size();
+
+    // Kept by each thread for its next transform, the convolution plan is a power of 2 and never
+    // comes back here
+    thread_local std::vector<T> re;
+    thread_local std::vector<T> im;
+    re.assign(m, 0);
+    im.assign(m, 0);
+    for (size_t k = 0; k < n; k++)
+    {
+        const T c = static_cast<T>(m_chirpCos[k]);
+        const T s = static_cast<T>(m_chirpSin[k]);
+        re[k] = real[k] * c + imag[k] * s;
+        im[k] = imag[k] * c - real[k] * s;
+    }
+
+    if (!m_convolutionPlan->execute(re, im, thread))
+    {
+        return false;
+    }
+
+    // Multiply by the filter spectrum and conjugate, so the forward plan computes the inverse
+    for (size_t k = 0; k < m; k++)
+    {
+        const T fr = static_cast<T>(m_filterReal[k]);
+        const T fi = static_cast<T>(m_filterImag[k]);
+        const T r = re[k] * fr - im[k] * fi;
+        const T i = re[k] * fi + im[k] * fr;
+        re[k] = r;
+        im[k] = -i;
+    }
+
+    if (!m_convolutionPlan->execute(re, im, thread))
+    {
+        return false;
+    }
+
+    // Undo the conjugation, scale the inverse transform and apply the output chirp
+    const T scale = static_cast<T>(1.0 / m);
+    for (size_t k = 0; k < n; k++)
+    {
+        const T c = static_cast<T>(m_chirpCos[k]);
+        const T s = static_cast<T>(m_chirpSin[k]);
+        const T r = re[k] * scale;
+        const T i = -im[k] * scale;
+        real[k] = r * c + i * s;
+        imag[k] = i * c - r * s;
+    }
+
+    return !interrupted(thread);
+}
+
+bool FFTPlan::transformReal(std::vector<double>& real, std::vector<double>& imag) const
+{
+    return transformRealSamples(real, imag);
+}
+
+bool FFTPlan::transformReal(std::vector<float>& real, std::vector<float>& imag) const
+{
+    return transformRealSamples(real, imag);
+}
+
+template <typename T>
+bool FFTPlan::transformRealSamples(std::vector<T>& real, std::vector<T>& imag) const
+{
+    const size_t n = m_size;
+    if (real.size() != n)
+    {
+        throw std::invalid_argument("FFTPlan::transformReal() Size mismatch for real vector");
+    }
+
+    QThread* thread = QThread::currentThread();
+
+    // Odd lengths cannot be packed, run the full complex transform and keep the lower half
+    if (n % 2 != 0)
+    {
+        imag.assign(n, 0);
+        if (!execute(real, imag, thread))
+        {
+            return false;
+        }
+
+        real.resize(n / 2 + 1);
+        imag.resize(n / 2 + 1);
+        return true;
+    }
+
+    // Pack even samples as the real part and odd samples as the imaginary part of a
+    // half-length signal. Writing index m only reads from 2m and 2m + 1, so this works in place.
+    const size_t half = n / 2;
+    imag.resize(half);
+    for (size_t m = 0; m < half; m++)
+    {
+        imag[m] = real[2 * m + 1];
+        real[m] = real[2 * m];
+    }
+    real.resize(half);
+
+    if (!forSize(half)->execute(real, imag, thread))
+    {
+        return false;
+    }
+
+    // Split Z into the spectra of the even (E) and odd (O) samples and combine them with
+    // X[k] = E[k] + W^k O[k], W = exp(-2*pi*i/n). Bins k and half - k share their inputs
+    // (X[half - k] = conj(E[k] - W^k O[k])), so each pair is finished together in place.
+    real.resize(half + 1);
+    imag.resize(half + 1);
+
+    const T z0re = real[0];
+    const T z0im = imag[0];
+    real[0] = z0re + z0im;
+    imag[0] = 0;
+    real[half] = z0re - z0im;
+    imag[half] = 0;
+
+    const bool radix2 = m_algorithm == Algorithm::Radix2;
+    const double* cosTable = radix2 ? &m_stageCos[half - 1] : m_realCos.data();
+    const double* sinTable = radix2 ? &m_stageSin[half - 1] : m_realSin.data();
+    for (size_t k = 1; k <= half / 2; k++)
+    {
+        const size_t mk = half - k;
+
+        const T evenRe = T(0.5) * (real[k] + real[mk]);
+        const T evenIm = T(0.5) * (imag[k] - imag[mk]);
+        const T oddRe  = T(0.5) * (imag[k] + imag[mk]);
+        const T oddIm  = T(0.5) * (real[mk] - real[k]);
+
+        // W^k * O[k]
+        const T c = static_cast<T>(cosTable[k]);
+        const T s = static_cast<T>(sinTable[k]);
+        const T twRe = oddRe * c + oddIm * s;
+        const T twIm = oddIm * c - oddRe * s;
+
+        real[k] = evenRe + twRe;
+        imag[k] = evenIm + twIm;
+        real[mk] = evenRe - twRe;
+        imag[mk] = twIm - evenIm;
+    }
+
+    return true;
+}
+
+void FFTPlan::untangleReal(const double* zReal, const double* zImag, size_t first, size_t last,
+                           double* real, double* imag) const
+{
+    untangleBins(zReal, zImag, first, last, real, imag);
+}
+
+void FFTPlan::untangleReal(const float* zReal, const float* zImag, size_t first, size_t last,
+                           float* real, float* imag) const
+{
+    untangleBins(zReal, zImag, first, last, real, imag);
+}
+
+template <typename T>
+void FFTPlan::untangleBins(const T* zReal, const T* zImag, size_t first, size_t last,
+                           T* real, T* imag) const
+{
+    const size_t half = m_size / 2;
+    if (m_size % 2 != 0 || first > last || last > half + 1)
+    {
+        throw std::invalid_argument("FFTPlan::untangleReal() Invalid bin range");
+    }
+
+    const bool radix2 = m_algorithm == Algorithm::Radix2;
+    const double* cosTable = radix2 ? &m_stageCos[half - 1] : m_realCos.data();
+    const double* sinTable = radix2 ? &m_stageSin[half - 1] : m_realSin.data();
+    for (size_t k = first; k < last; k++)
+    {
+        T* outRe = real + (k - first);
+        T* outIm = imag + (k - first);
+        if (k == 0 || k == half)
+        {
+            *outRe = k == 0 ? zReal[0] + zImag[0] : zReal[0] - zImag[0];
+            *outIm = 0;
+            continue;
+        }
+
+        const size_t mk = half - k;
+
+        const T evenRe = T(0.5) * (zReal[k] + zReal[mk]);
+        const T evenIm = T(0.5) * (zImag[k] - zImag[mk]);
+        const T oddRe  = T(0.5) * (zImag[k] + zImag[mk]);
+        const T oddIm  = T(0.5) * (zReal[mk] - zReal[k]);
+
+        // Only the twiddles up to n/4 are stored, above that W^k = -conj(W^(half - k))
+        const bool mirrored = !radix2 && k > half / 2;
+        const T c = static_cast<T>(mirrored ? -cosTable[mk] : cosTable[k]);
+        const T s = static_cast<T>(mirrored ? sinTable[mk] : sinTable[k]);
+
+        *outRe = evenRe + oddRe * c + oddIm * s;
+        *outIm = evenIm + oddIm * c - oddRe * s;
+    }
+}
+
+bool FFTPlan::transformRealBatch(const double* frames, size_t count, size_t inputStride,
+                                 double* real, double* imag, size_t outputStride) const
+{
+    return transformRealFrames(frames, count, inputStride, real, imag, outputStride);
+}
+
+bool FFTPlan::transformRealBatch(const float* frames, size_t count, size_t inputStride,
+                                 float* real, float* imag, size_t outputStride) const
+{
+    return transformRealFrames(frames, count, inputStride, real, imag, outputStride);
+}
+
+template <typename T>
+bool FFTPlan::transformRealFrames(const T* frames, size_t count, size_t inputStride,
+                                  T* real, T* imag, size_t outputStride) const
+{
+    const size_t n = m_size;
+    const size_t half = n / 2;
+    if (inputStride < n || outputStride < half + 1)
+    {
+        throw std::invalid_argument("FFTPlan::transformRealBatch() Frames overlap");
+    }
+
+    QThread* thread = QThread::currentThread();
+
+    // Odd lengths cannot be packed, run the full complex transform of every frame
+    if (n % 2 != 0)
+    {
+        std::vector<T> frameReal(n);
+        std::vector<T> frameImag(n);
+        for (size_t f = 0; f < count; f++)
+        {
+            std::copy(frames + f * inputStride, frames + f * inputStride + n, frameReal.begin());
+            std::fill(frameImag.begin(), frameImag.end(), T(0));
+            if (!execute(frameReal, frameImag, thread))
+            {
+                return false;
+            }
+
+            std::copy(frameReal.begin(), frameReal.begin() + half + 1, real + f * outputStride);
+            std::copy(frameImag.begin(), frameImag.begin() + half + 1, imag + f * outputStride);
+        }
+        return true;
+    }
+
+    // The half-length plan is looked up once for all the frames
+    const std::shared_ptr<const FFTPlan> halfPlan = forSize(half);
+
+    // As many frames as fit in the cache, but no more than there are
+    size_t batch = MAX_BATCH_FRAMES;
+    while (batch > 1 && (batch / 2 >= count || 4 * half * batch * sizeof(T) > BATCH_CACHE_BYTES))
+    {
+        batch /= 2;
+    }
+
+    // FixedFFT already keeps a whole frame in registers and L1, the frames only gain from being
+    // interleaved for the other radix-2 sizes, where one transform is too short to fill the
+    // SIMD kernels
+    const bool fixedSize = half >= MIN_FIXED_SIZE && half <= MAX_FIXED_SIZE;
+    if (halfPlan->m_algorithm != Algorithm::Radix2 || fixedSize)
+    {
+        batch = 1;
+    }
+
+    // Kept by each thread for its next batch, like the Stockham scratch buffers
+    thread_local std::vector<T> batchReal;
+    thread_local std::vector<T> batchImag;
+    for (size_t first = 0; first < count; first += batch)
+    {
+        const size_t numFrames = std::min(batch, count - first);
+
+        // The mixed-radix and Bluestein transforms may swap the vectors, take their data every time
+        batchReal.resize(half * batch);
+        batchImag.resize(half * batch);
+        T* zReal = batchReal.data();
+        T* zImag = batchImag.data();
+
+        // Pack the even samples of every frame as the real part and the odd samples as the
+        // imaginary part of a half-length signal (see transformReal), interleaving the frames.
+        // The last batch is completed with silent frames.
+        for (size_t b = 0; b < batch; b++)
+        {
+            if (b >= numFrames)
+            {
+                for (size_t m = 0; m < half; m++)
+                {
+                    zReal[m * batch + b] = 0;
+                    zImag[m * batch + b] = 0;
+                }
+                continue;
+            }
+
+            const T* x = frames + (first + b) * inputStride;
+            for (size_t m = 0; m < half; m++)
+            {
+                zReal[m * batch + b] = x[2 * m];
+                zImag[m * batch + b] = x[2 * m + 1];
+            }
+        }
+
+        if (batch == 1)
+        {
+            // One frame at a time, straight from the packed buffer into its bins
+            if (!halfPlan->execute(batchReal, batchImag, thread))
+            {
+                return false;
+            }
+
+            untangleBins(batchReal.data(), batchImag.data(), 0, half + 1, real + first * outputStride, imag + first * outputStride);
+            continue;
+        }
+
+        if (!halfPlan->transformStockham(zReal, zImag, thread, batch))
+        {
+            return false;
+        }
+
+        // Untangle each frame into its bins, X[k] = E[k] + W^k O[k] as in transformReal
+        const double* cosTable = &m_stageCos[half - 1];
+        const double* sinTable = &m_stageSin[half - 1];
+        for (size_t b = 0; b < numFrames; b++)
+        {
+            T* outRe = real + (first + b) * outputStride;
+            T* outIm = imag + (first + b) * outputStride;
+
+            outRe[0] = zReal[b] + zImag[b];
+            outIm[0] = 0;
+            outRe[half] = zReal[b] - zImag[b];
+            outIm[half] = 0;
+
+            for (size_t k = 1; k <= half / 2; k++)
+            {
+                const size_t mk = half - k;
+                const T zkRe = zReal[k * batch + b], zkIm = zImag[k * batch + b];
+                const T zmkRe = zReal[mk * batch + b], zmkIm = zImag[mk * batch + b];
+
+                const T evenRe = T(0.5) * (zkRe + zmkRe);
+                const T evenIm = T(0.5) * (zkIm - zmkIm);
+                const T oddRe  = T(0.5) * (zkIm + zmkIm);
+                const T oddIm  = T(0.5) * (zmkRe - zkRe);
+
+                const T c = static_cast<T>(cosTable[k]);
+                const T s = static_cast<T>(sinTable[k]);
+                const T twRe = oddRe * c + oddIm * s;
+                const T twIm = oddIm * c - oddRe * s;
+
+                outRe[k] = evenRe + twRe;
+                outIm[k] = evenIm + twIm;
+                outRe[mk] = evenRe - twRe;
+                outIm[mk] = twIm - evenIm;
+            }
+        }
+    }
+
+    return true;
+}
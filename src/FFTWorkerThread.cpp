@@ -30,135 +30,51 @@ void FFTWorkerThread::clearData()
 
 // Implementation of the Cooley-Tukey FFT algorithm, modified for our use case,
 // adapted from https://www.nayuki.io/page/free-small-fft-in-multiple-languages
-std::vector<std::pair<size_t, double>> FFTWorkerThread::cooleyTukey(std::vector<double> &real, std::vector<double> &imag)
+template <typename T>
+std::vector<std::pair<size_t, double>> FFTWorkerThread::cooleyTukey(std::vector<T>& real)
 {
     std::vector<std::pair<size_t, double>> output;
 
-    // Check the length of both real/imag vectors
-    size_t n = real.size();
-    if (n != imag.size())
-    {
-        throw std::invalid_argument("FFTWorkerThread::cooleyTukey() Size mismatch for real/imag vectors");
-    }
+    // Any length is transformed as-is, so bin i sits exactly at i * samplesPerSec / n
+    const size_t n = real.size();
 
-    // Compute the number of total levels for the FFT using bit shifting
-    int levels = 0;
-    for (size_t temp = n; temp > 1U; temp >>= 1)
-    {
-        levels++;
-    }
+    // Only the non-negative frequencies are produced for real input
+    output.reserve(n / 2 + 1);
 
-    // If length is not a power of 2, resize both vectors to next highest power of 2.
-    if (static_cast<size_t>(1U) << levels != n)
-    {
-        int powOf2 = static_cast<size_t>(1U) << (levels + 1);
-        real.resize(powOf2);
-        imag.resize(powOf2);
-        n = powOf2;
-        levels++;
-        //qDebug() << "FFTWorkerThread::cooleyTukey() padded vector to size " << powOf2;
-    }
-
-    output.reserve(n);
-
-    // cos/sin calculations
     const ulong samplesPerSec = m_format.bytesForDuration(1e6) / (m_format.sampleSize() / 8);
-    std::vector<double> cosTable(n / 2);
-    std::vector<double> sinTable(n / 2);
-    for (size_t i = 0; i < n / 2; i++)
-    {
-        if (isInterruptionRequested())
-        {
-            clearData();
-            return output;
-        }
 
-        cosTable[i] = std::cos(2 * M_PI * i / n);
-        sinTable[i] = std::sin(2 * M_PI * i / n);
-    }
-
-    // Bit-reversed addressing permutation
-    // https://en.wikipedia.org/wiki/Bit-reversal_permutation
-    for (size_t i = 0; i < n; i++)
+    // Twiddle factors and the input permutation come from the shared plan for this size
+    std::vector<T> imag;
+    std::shared_ptr<const FFTPlan> plan = FFTPlan::forSize(n);
+    if (!plan->transformReal(real, imag))
     {
-        if (isInterruptionRequested())
-        {
-            clearData();
-            return output;
-        }
-
-        // Reverse the current index with bit width equal to number of levels
-        size_t j = FFTUtils::reverseBits(i, levels);
-
-        // If the reversed index is greater than the current index,
-        // swap the values in the real/imaginary vectors.
-        if (j > i)
-        {
-            std::swap(real[i], real[j]);
-            std::swap(imag[i], imag[j]);
-        }
+        clearData();
+        return output;
     }
 
-    // Cooley-Tukey decimation-in-time radix-2 FFT algorithm
-    for (size_t size = 2; size <= n; size *= 2)
+    // Calculate magnitude of every complex element in place and normalize by the largest one
+    const T maxSum = FFTKernels::magnitude(real.data(), imag.data(), real.data(), real.size());
+    if (maxSum > 0)
     {
-        size_t halfsize = size / 2;
-        size_t tablestep = n / size;
-        for (size_t i = 0; i < n; i += size)
-        {
-            for (size_t j = i, k = 0; j < i + halfsize; j++, k += tablestep)
-            {
-                if (isInterruptionRequested())
-                {
-                    clearData();
-                    return output;
-                }
-
-                size_t l = j + halfsize;
-                double tpre =  real[l] * cosTable[k] + imag[l] * sinTable[k];
-                double tpim = -real[l] * sinTable[k] + imag[l] * cosTable[k];
-                real[l] = real[j] - tpre;
-                imag[l] = imag[j] - tpim;
-                real[j] += tpre;
-                imag[j] += tpim;
-            }
-        }
-        if (size == n)  // Prevent overflow when calculating size *= 2
-            break;
+        FFTKernels::scale(real.data(), 1 / maxSum, real.size());
     }
 
-    double maxSum = 0.0;
-
     // Fill output vector
     int prevK = -1;
     for (size_t i = 0; i < real.size(); ++i)
     {
-        // Calculate magnitude of complex element
-        std::complex<double> complex(real[i], imag[i]);
-        double abs = std::abs(complex);
-
-        // Update maxSum
-        if (abs > maxSum)
-            maxSum = abs;
-
         // Get the corresponding frequency bin from the current index.
-        int k = FFTUtils::index2Freq(i, samplesPerSec, real.size());
+        int k = FFTUtils::index2Freq(i, samplesPerSec, n);
 
         // Skip duplicate frequencies (since we are casting to int, we lose the float precision)
         if (k == prevK)
             continue;
 
         // Add the frequency, amplitude pair to the output vector
-        output.push_back(std::make_pair(k, abs));
+        output.push_back(std::make_pair(k, real[i]));
         prevK = k;
     }
 
-    // Normalization by maxSum
-    for (size_t i = 0; i < output.size(); ++i)
-    {
-        output[i].second /= maxSum;
-    }
-
     return output;
 }
 
@@ -185,16 +101,21 @@ void FFTWorkerThread::run()
 
     std::vector<std::pair<size_t, double>> output;
 
-    // Prepare real/imag vectors, imaginary vector is zeroed out
-    std::vector<double> real(data_short, data_short + N);
-    std::vector<double> imag;
-    imag.resize(real.size());
-
     // Exception handling, should never get inside catch.
     try {
-        output = cooleyTukey(real, imag);
+        // Only the real samples are needed, the transform packs them into half-length complex values
+        if (FFTPlan::precision() == FFTPlan::Precision::Single)
+        {
+            std::vector<float> real(data_short, data_short + N);
+            output = cooleyTukey(real);
+        }
+        else
+        {
+            std::vector<double> real(data_short, data_short + N);
+            output = cooleyTukey(real);
+        }
     }  catch (std::invalid_argument e) {
-        qDebug() << "Invalid sizes of reals/imags vectors, aborting FFTWorkerThread::run()";
+        qDebug() << "Invalid size of reals vector, aborting FFTWorkerThread::run()";
         return;
     }
 
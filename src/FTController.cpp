@@ -1,15 +1,31 @@
 #include "FTController.h"
 
+#include <climits>
+
 FTController::FTController()
-    : m_dataBuffer(new QBuffer)
+    : m_StreamingWelchWorkerThread(new StreamingWelchWorkerThread)
+    , m_LiveSpectrumWorkerThread(new LiveSpectrumWorkerThread)
     , m_DFTWorkerThread(new DFTWorkerThread)
     , m_FFTWorkerThread(new FFTWorkerThread)
+    , m_dataBuffer(new QBuffer)
+    , m_streamBacklogStart(0)
+    , m_streamFinishing(false)
+    , m_decimatedBuffer(new QBuffer)
+    , m_inputBuffer(m_dataBuffer)
+    , m_decimation(false)
+    , m_decimated(false)
+    , m_goertzelNumSamples(0)
+    , m_welchNumSegments(0)
+    , m_channelNumSegments(0)
     , m_numWorkersFinished(0)
+    , m_cancellationToken(std::chrono::milliseconds(Constants::CANCEL_LATENCY_BUDGET_MS))
 {
     m_combinedPoints.resize((Constants::MAX_FREQUENCY - Constants::MIN_FREQUENCY + 1));
 
     m_dataBuffer->open(QIODevice::ReadWrite);
+    m_decimatedBuffer->open(QIODevice::ReadWrite);
     m_DFTWorkerThread->setDataBuffer(m_dataBuffer);
+    m_DFTWorkerThread->setCancellationToken(&m_cancellationToken);
     m_FFTWorkerThread->setDataBuffer(m_dataBuffer);
     connect(m_DFTWorkerThread, &DFTWorkerThread::resultReady, this, &FTController::handleResults);
     connect(m_FFTWorkerThread, &FFTWorkerThread::resultReady, this, &FTController::handleResults);
@@ -19,54 +35,220 @@ FTController::FTController()
         m_DistributedDFTWorkerThreads[i] = new DistributedDFTWorkerThread;
         m_DistributedDFTWorkerThreads[i]->setWorkerID(i);
         m_DistributedDFTWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_DistributedDFTWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
         connect(m_DistributedDFTWorkerThreads[i], &DistributedDFTWorkerThread::distributedResultReady, this, &FTController::handleDistributedDFTResults);
     }
 
-    for (int i = 0; i < Constants::NUM_FFT_WORKERS; ++i)
+    // The distributed FFT splits a single transform, so use one worker per core
+    const int numFFTWorkers = qMax(1, QThread::idealThreadCount());
+    m_fourStepFFT = new FourStepFFT(numFFTWorkers);
+    m_DistributedFFTWorkerThreads.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
     {
         m_DistributedFFTWorkerThreads[i] = new DistributedFFTWorkerThread;
         m_DistributedFFTWorkerThreads[i]->setWorkerID(i);
         m_DistributedFFTWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_DistributedFFTWorkerThreads[i]->setFourStepFFT(m_fourStepFFT);
         connect(m_DistributedFFTWorkerThreads[i], &DistributedFFTWorkerThread::distributedResultReady, this, &FTController::handleDistributedFFTResults);
     }
+
+    // Zoom FFT blocks are independent, one worker per core as well
+    m_ZoomFFTWorkerThreads.resize(numFFTWorkers);
+    m_zoomPartialReal.resize(numFFTWorkers);
+    m_zoomPartialImag.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_ZoomFFTWorkerThreads[i] = new ZoomFFTWorkerThread;
+        m_ZoomFFTWorkerThreads[i]->setWorkerID(i);
+        m_ZoomFFTWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_ZoomFFTWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        connect(m_ZoomFFTWorkerThreads[i], &ZoomFFTWorkerThread::zoomResultReady, this, &FTController::handleZoomFFTResults);
+    }
+
+    // Goertzel workers split the samples, one per core
+    m_GoertzelWorkerThreads.resize(numFFTWorkers);
+    m_goertzelPartialReal.resize(numFFTWorkers);
+    m_goertzelPartialImag.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_GoertzelWorkerThreads[i] = new GoertzelWorkerThread;
+        m_GoertzelWorkerThreads[i]->setWorkerID(i);
+        m_GoertzelWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_GoertzelWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_GoertzelWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_GoertzelWorkerThreads[i], &GoertzelWorkerThread::goertzelResultReady, this, &FTController::handleGoertzelResults);
+    }
+
+    // STFT workers take frames from a shared counter, one per core
+    qRegisterMetaType<std::shared_ptr<const Spectrogram>>("std::shared_ptr<const Spectrogram>");
+    m_STFTWorkerThreads.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_STFTWorkerThreads[i] = new STFTWorkerThread;
+        m_STFTWorkerThreads[i]->setWorkerID(i);
+        m_STFTWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_STFTWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_STFTWorkerThreads[i], &STFTWorkerThread::stftFramesDone, this, &FTController::handleSTFTResults);
+    }
+
+    // Welch workers split the segments, one per core
+    m_WelchWorkerThreads.resize(numFFTWorkers);
+    m_welchPartialPower.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_WelchWorkerThreads[i] = new WelchWorkerThread;
+        m_WelchWorkerThreads[i]->setWorkerID(i);
+        m_WelchWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_WelchWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_WelchWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_WelchWorkerThreads[i], &WelchWorkerThread::welchResultReady, this, &FTController::handleWelchResults);
+    }
+
+    // Per-channel Welch workers split the segments of all channels, one per core as well
+    m_ChannelWelchWorkerThreads.resize(numFFTWorkers);
+    m_channelPartialPower.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_ChannelWelchWorkerThreads[i] = new ChannelWelchWorkerThread;
+        m_ChannelWelchWorkerThreads[i]->setWorkerID(i);
+        m_ChannelWelchWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_ChannelWelchWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_ChannelWelchWorkerThreads[i], &ChannelWelchWorkerThread::channelWelchResultReady, this, &FTController::handleChannelWelchResults);
+    }
+
+    // Constant-Q workers split the frames, one per core
+    m_ConstantQWorkerThreads.resize(numFFTWorkers);
+    m_constantQPartialSums.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_ConstantQWorkerThreads[i] = new ConstantQWorkerThread;
+        m_ConstantQWorkerThreads[i]->setWorkerID(i);
+        m_ConstantQWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_ConstantQWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_ConstantQWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_ConstantQWorkerThreads[i], &ConstantQWorkerThread::constantQResultReady, this, &FTController::handleConstantQResults);
+    }
+
+    // Decimation workers split the decimated samples, one per core
+    m_DecimatorWorkerThreads.resize(numFFTWorkers);
+
+    for (int i = 0; i < numFFTWorkers; ++i)
+    {
+        m_DecimatorWorkerThreads[i] = new DecimatorWorkerThread;
+        m_DecimatorWorkerThreads[i]->setWorkerID(i);
+        m_DecimatorWorkerThreads[i]->setNumWorkers(numFFTWorkers);
+        m_DecimatorWorkerThreads[i]->setDataBuffer(m_dataBuffer);
+        m_DecimatorWorkerThreads[i]->setCancellationToken(&m_cancellationToken);
+        connect(m_DecimatorWorkerThreads[i], &DecimatorWorkerThread::decimationDone, this, &FTController::handleDecimationResults);
+    }
+
+    // A single worker follows the decoder, its segments only become available one after the other
+    m_StreamingWelchWorkerThread->setCancellationToken(&m_cancellationToken);
+    connect(m_StreamingWelchWorkerThread, &StreamingWelchWorkerThread::streamingResultReady, this, &FTController::handleStreamingResults);
+    connect(m_StreamingWelchWorkerThread, &StreamingWelchWorkerThread::spaceAvailable, this, &FTController::handleStreamSpace);
+
+    // The live spectrum follows the playback, not the transforms: only stopLiveSpectrum() ends it
+    connect(m_LiveSpectrumWorkerThread, &LiveSpectrumWorkerThread::liveResultReady, this, &FTController::handleLiveResults);
 }
 
 FTController::~FTController() 
 {
     terminateRunningThreads();
+    stopLiveSpectrum();
+    m_LiveSpectrumWorkerThread->wait();
 }
 
 void FTController::terminateRunningThreads()
 {
+    QVector<QThread*> running;
     if (m_DFTWorkerThread->isRunning())
+        running.append(m_DFTWorkerThread);
+    if (m_FFTWorkerThread->isRunning())
+        running.append(m_FFTWorkerThread);
+    for (int i = 0; i < Constants::NUM_DFT_WORKERS; ++i)
+    {
+        if (m_DistributedDFTWorkerThreads[i]->isRunning())
+            running.append(m_DistributedDFTWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_DistributedFFTWorkerThreads.size(); ++i)
+    {
+        if (m_DistributedFFTWorkerThreads[i]->isRunning())
+            running.append(m_DistributedFFTWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_ZoomFFTWorkerThreads.size(); ++i)
+    {
+        if (m_ZoomFFTWorkerThreads[i]->isRunning())
+            running.append(m_ZoomFFTWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_GoertzelWorkerThreads.size(); ++i)
+    {
+        if (m_GoertzelWorkerThreads[i]->isRunning())
+            running.append(m_GoertzelWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_STFTWorkerThreads.size(); ++i)
+    {
+        if (m_STFTWorkerThreads[i]->isRunning())
+            running.append(m_STFTWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_WelchWorkerThreads.size(); ++i)
+    {
+        if (m_WelchWorkerThreads[i]->isRunning())
+            running.append(m_WelchWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_ChannelWelchWorkerThreads.size(); ++i)
     {
-        m_DFTWorkerThread->requestInterruption();
-        m_DFTWorkerThread->wait();
+        if (m_ChannelWelchWorkerThreads[i]->isRunning())
+            running.append(m_ChannelWelchWorkerThreads[i]);
     }
+    for (int i = 0; i < m_ConstantQWorkerThreads.size(); ++i)
+    {
+        if (m_ConstantQWorkerThreads[i]->isRunning())
+            running.append(m_ConstantQWorkerThreads[i]);
+    }
+    for (int i = 0; i < m_DecimatorWorkerThreads.size(); ++i)
+    {
+        if (m_DecimatorWorkerThreads[i]->isRunning())
+            running.append(m_DecimatorWorkerThreads[i]);
+    }
+    if (m_StreamingWelchWorkerThread->isRunning())
+        running.append(m_StreamingWelchWorkerThread);
 
-    if (m_FFTWorkerThread->isRunning())
+    // Signal every worker before waiting for any of them, so they all wind down at the same
+    // time. The DFT, Goertzel, STFT, Welch (per channel as well), constant-Q and decimation workers poll the token, the FFT workers check their interruption request
+    // between FFT stages.
+    m_cancellationToken.cancel();
+    for (int i = 0; i < running.size(); ++i)
     {
-        m_FFTWorkerThread->requestInterruption();
-        m_FFTWorkerThread->wait();
+        running[i]->requestInterruption();
     }
 
-    for (int i = 0; i < Constants::NUM_DFT_WORKERS; ++i)
+    // Release the FFT workers waiting on each other, and the streaming worker waiting for samples
+    m_fourStepFFT->abort();
+    m_StreamingWelchWorkerThread->wake();
+
+    for (int i = 0; i < running.size(); ++i)
     {
-        if (m_DistributedDFTWorkerThreads[i]->isRunning())
-        {
-            m_DistributedDFTWorkerThreads[i]->requestInterruption();
-            m_DistributedDFTWorkerThreads[i]->wait();
-        }
+        running[i]->wait();
     }
 
-    for (int i = 0; i < Constants::NUM_FFT_WORKERS; ++i)
+    if (!running.isEmpty())
     {
-        if (m_DistributedFFTWorkerThreads[i]->isRunning())
-        {
-            m_DistributedFFTWorkerThreads[i]->requestInterruption();
-            m_DistributedFFTWorkerThreads[i]->wait();
-        }
+        const double elapsedSeconds = m_cancellationToken.secondsSinceCancel();
+        const double budgetSeconds = m_cancellationToken.latencyBudget().count() / 1000.0;
+        qDebug() << "FTController::terminateRunningThreads() Cancelled" << running.size() << "workers in"
+                 << elapsedSeconds * 1000.0 << "ms, slowest check" << m_cancellationToken.slowestAcknowledgement() * 1000.0
+                 << "ms, budget" << budgetSeconds * 1000.0 << "ms";
+        emit threadsCancelled(running.size(), elapsedSeconds);
     }
+
+    m_cancellationToken.reset();
 }
 
 void FTController::resetThreadData()
@@ -79,21 +261,84 @@ void FTController::resetThreadData()
         m_DistributedDFTWorkerThreads[i]->clearData();
     }
 
-    for (int i = 0; i < Constants::NUM_FFT_WORKERS; ++i)
+    for (int i = 0; i < m_DistributedFFTWorkerThreads.size(); ++i)
     {
         m_DistributedFFTWorkerThreads[i]->clearData();
     }
 
+    for (int i = 0; i < m_ZoomFFTWorkerThreads.size(); ++i)
+    {
+        m_ZoomFFTWorkerThreads[i]->clearData();
+    }
+
+    for (int i = 0; i < m_GoertzelWorkerThreads.size(); ++i)
+    {
+        m_GoertzelWorkerThreads[i]->clearData();
+    }
+
+    for (int i = 0; i < m_STFTWorkerThreads.size(); ++i)
+    {
+        m_STFTWorkerThreads[i]->clearData();
+    }
+    m_spectrogram.reset();
+
+    for (int i = 0; i < m_WelchWorkerThreads.size(); ++i)
+    {
+        m_WelchWorkerThreads[i]->clearData();
+    }
+    for (int i = 0; i < m_ChannelWelchWorkerThreads.size(); ++i)
+    {
+        m_ChannelWelchWorkerThreads[i]->clearData();
+        m_ChannelWelchWorkerThreads[i]->setChannels(nullptr);
+    }
+    for (int i = 0; i < m_ConstantQWorkerThreads.size(); ++i)
+    {
+        m_ConstantQWorkerThreads[i]->clearData();
+    }
+    for (int i = 0; i < m_DecimatorWorkerThreads.size(); ++i)
+    {
+        m_DecimatorWorkerThreads[i]->clearData();
+    }
+    m_decimatedSamples.reset();
+    m_decimatedStart = nullptr;
+    m_decimated = false;
+    m_StreamingWelchWorkerThread->clearData();
+    m_streamBacklog.clear();
+    m_streamBacklogStart = 0;
+    m_streamFinishing = false;
+    m_LiveSpectrumWorkerThread->clearData();
+
+    // Results of cancelled workers must not count towards the next run
+    m_numWorkersFinished = 0;
+    DistributedDFTWorkerThread::setMaxSum(0.0);
+    DistributedFFTWorkerThread::setMaxSum(0.0);
+
     // Clear data buffer
     m_dataBuffer->close();
     m_dataBuffer->setData(nullptr);
     m_dataBuffer->open(QIODevice::ReadWrite);
+    m_sampleStore.reset();
+    m_convertedSamples.reset();
+    m_sourceData.clear();
+
+    m_decimatedBuffer->close();
+    m_decimatedBuffer->setData(nullptr);
+    m_decimatedBuffer->open(QIODevice::ReadWrite);
+    setInputBuffer(m_dataBuffer);
 }
 
 void FTController::clear()
 {
     terminateRunningThreads();
     resetThreadData();
+
+    // The next file likely has other sizes, the workers hold on to the plans they still use
+    FFTPlan::clearCache();
+}
+
+void FTController::setCancelLatencyBudget(const int milliseconds)
+{
+    m_cancellationToken.setLatencyBudget(std::chrono::milliseconds(milliseconds));
 }
 
 QBuffer* FTController::getDataBuffer()
@@ -101,6 +346,29 @@ QBuffer* FTController::getDataBuffer()
     return m_dataBuffer;
 }
 
+void FTController::setSampleStore(std::shared_ptr<const SampleStore> store, const QAudioFormat format)
+{
+    m_format = format;
+    m_sampleStore = store;
+    m_convertedSamples.reset();
+    m_sourceData.clear();
+
+    // A QByteArray holds at most INT_MAX bytes, the transforms of longer recordings only see
+    // the whole frames that fit in it
+    size_t size = store->size();
+    if (size > static_cast<size_t>(INT_MAX))
+    {
+        qDebug() << "FTController::setSampleStore() Samples too long for a single transform, only the first" << INT_MAX << "bytes are analyzed";
+        const size_t frameBytes = static_cast<size_t>(std::max(1, format.bytesPerFrame()));
+        size = static_cast<size_t>(INT_MAX) / frameBytes * frameBytes;
+    }
+
+    // Read only, a write would detach the view into a copy
+    m_dataBuffer->close();
+    m_dataBuffer->setData(QByteArray::fromRawData(store->data(), static_cast<int>(size)));
+    m_dataBuffer->open(QIODevice::ReadOnly);
+}
+
 void FTController::setAudioFormat(QAudioFormat format)
 {
     m_format = format;
@@ -110,10 +378,19 @@ void FTController::startDFTInAThread(const QAudioFormat format)
 {
     m_timeStart = std::chrono::high_resolution_clock::now();
 
+    if (convertFirst(format, [this](const QAudioFormat convertedFormat) { startDFTInAThread(convertedFormat); }))
+        return;
+
+    if (decimateFirst(format, [this](const QAudioFormat decimatedFormat) { startDFTInAThread(decimatedFormat); }))
+        return;
+
     // Reset data buffer to position 0
-    m_dataBuffer->seek(0);
+    m_inputBuffer->seek(0);
+
+    prepareBinDFT(format);
 
     m_DFTWorkerThread->setAudioFormat(format);
+    m_DFTWorkerThread->setBinDFT(m_binDFT);
     m_DFTWorkerThread->start();
 }
 
@@ -121,22 +398,53 @@ void FTController::startDistributedDFT(const QAudioFormat format)
 {
     m_timeStart = std::chrono::high_resolution_clock::now();
 
+    if (convertFirst(format, [this](const QAudioFormat convertedFormat) { startDistributedDFT(convertedFormat); }))
+        return;
+
+    if (decimateFirst(format, [this](const QAudioFormat decimatedFormat) { startDistributedDFT(decimatedFormat); }))
+        return;
+
     // Reset data buffer to position 0
-    m_dataBuffer->seek(0);
+    m_inputBuffer->seek(0);
+
+    prepareBinDFT(format);
 
     for (int i = 0; i < Constants::NUM_DFT_WORKERS; ++i)
     {
         m_DistributedDFTWorkerThreads[i]->setAudioFormat(format);
+        m_DistributedDFTWorkerThreads[i]->setBinDFT(m_binDFT);
         m_DistributedDFTWorkerThreads[i]->start();
     }
 }
 
+void FTController::prepareBinDFT(const QAudioFormat format)
+{
+    // The phasor steps only depend on the sample rate, so keep them between runs
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+    if (!m_binDFT || m_binDFT->sampleRate() != samplesPerSec)
+    {
+        std::vector<double> frequencies;
+        frequencies.reserve(Constants::MAX_FREQUENCY - Constants::MIN_FREQUENCY + 1);
+        for (int k = Constants::MIN_FREQUENCY; k <= Constants::MAX_FREQUENCY; ++k)
+        {
+            frequencies.push_back(k);
+        }
+        m_binDFT = std::make_shared<const BinDFT>(samplesPerSec, frequencies);
+    }
+}
+
 void FTController::startFFTInAThread(const QAudioFormat format)
 {
     m_timeStart = std::chrono::high_resolution_clock::now();
 
+    if (convertFirst(format, [this](const QAudioFormat convertedFormat) { startFFTInAThread(convertedFormat); }))
+        return;
+
+    if (decimateFirst(format, [this](const QAudioFormat decimatedFormat) { startFFTInAThread(decimatedFormat); }))
+        return;
+
     // Reset data buffer to position 0
-    m_dataBuffer->seek(0);
+    m_inputBuffer->seek(0);
 
     m_FFTWorkerThread->setAudioFormat(format);
     m_FFTWorkerThread->start();
@@ -146,89 +454,988 @@ void FTController::startDistributedFFT(const QAudioFormat format)
 {
     m_timeStart = std::chrono::high_resolution_clock::now();
 
+    if (convertFirst(format, [this](const QAudioFormat convertedFormat) { startDistributedFFT(convertedFormat); }))
+        return;
+
+    if (decimateFirst(format, [this](const QAudioFormat decimatedFormat) { startDistributedFFT(decimatedFormat); }))
+        return;
+
     // Reset data buffer to position 0
-    m_dataBuffer->seek(0);
+    m_inputBuffer->seek(0);
 
-    for (int i = 0; i < Constants::NUM_FFT_WORKERS; ++i)
+    m_fourStepFFT->reset();
+
+    for (int i = 0; i < m_DistributedFFTWorkerThreads.size(); ++i)
     {
         m_DistributedFFTWorkerThreads[i]->setAudioFormat(format);
         m_DistributedFFTWorkerThreads[i]->start();
     }
 }
 
-void FTController::handleResults(const QVector<QPointF> points)
+void FTController::startZoomFFT(const QAudioFormat format, const double resolution)
 {
-    m_timeEnd = std::chrono::high_resolution_clock::now();
+    m_timeStart = std::chrono::high_resolution_clock::now();
 
-    /* Getting number of seconds as a double. */
-    std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
-    //qDebug() << "FTController Total Elapsed Time (s): " << elapsedSeconds.count();
+    if (convertFirst(format, [this, resolution](const QAudioFormat convertedFormat) { startZoomFFT(convertedFormat, resolution); }))
+        return;
 
-    emit spectrumDataReady(points, elapsedSeconds.count());
+    if (decimateFirst(format, [this, resolution](const QAudioFormat decimatedFormat) { startZoomFFT(decimatedFormat, resolution); }))
+        return;
+
+    // Reset data buffer to position 0
+    m_inputBuffer->seek(0);
+
+    // The chirp tables only depend on the band and sample rate, so keep them between runs
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+    const size_t numBins = static_cast<size_t>((Constants::MAX_FREQUENCY - Constants::MIN_FREQUENCY) / resolution) + 1;
+    if (!m_zoomFFT || m_zoomFFT->sampleRate() != samplesPerSec || m_zoomFFT->resolution() != resolution)
+    {
+        m_zoomFFT = std::make_shared<const ZoomFFT>(samplesPerSec, Constants::MIN_FREQUENCY, resolution, numBins);
+    }
 
+    for (int i = 0; i < m_ZoomFFTWorkerThreads.size(); ++i)
+    {
+        m_ZoomFFTWorkerThreads[i]->setAudioFormat(format);
+        m_ZoomFFTWorkerThreads[i]->setZoomFFT(m_zoomFFT);
+        m_ZoomFFTWorkerThreads[i]->start();
+    }
 }
 
-void FTController::handleDistributedDFTResults(const QVector<QPointF> points, const int workerID)
+void FTController::startGoertzel(const QAudioFormat format, const QVector<double> frequencies)
 {
-    Q_UNUSED(workerID);
+    m_timeStart = std::chrono::high_resolution_clock::now();
 
-    for (int i = 0; i < points.size(); ++i)
+    if (convertFirst(format, [this, frequencies](const QAudioFormat convertedFormat) { startGoertzel(convertedFormat, frequencies); }))
+        return;
+
+    // Reset data buffer to position 0
+    m_dataBuffer->seek(0);
+
+    // Exception handling, should never get inside catch.
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+    try {
+        m_goertzel = std::make_shared<const GoertzelFilterBank>(samplesPerSec, std::vector<double>(frequencies.begin(), frequencies.end()));
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "No target frequencies, aborting FTController::startGoertzel()";
+        return;
+    }
+    m_goertzelNumSamples = m_dataBuffer->bytesAvailable() / (format.sampleSize() / 8);
+
+    for (int i = 0; i < m_GoertzelWorkerThreads.size(); ++i)
     {
-        int index = points[i].x() - Constants::MIN_FREQUENCY;
-        m_combinedPoints[index] = points[i];
+        m_GoertzelWorkerThreads[i]->setAudioFormat(format);
+        m_GoertzelWorkerThreads[i]->setFilterBank(m_goertzel);
+        m_GoertzelWorkerThreads[i]->start();
     }
+}
 
-    m_numWorkersFinished++;
+void FTController::startSTFT(const QAudioFormat format, const int frameSize, const int hopSize, const STFT::Window window)
+{
+    m_timeStart = std::chrono::high_resolution_clock::now();
 
-    if (m_numWorkersFinished == Constants::NUM_DFT_WORKERS)
-    {
-        // Normalize y values
-        for (int i = 0; i < m_combinedPoints.size(); ++i)
+    if (convertFirst(format, [this, frameSize, hopSize, window](const QAudioFormat convertedFormat) { startSTFT(convertedFormat, frameSize, hopSize, window); }))
+        return;
+
+    // Reset data buffer to position 0
+    m_dataBuffer->seek(0);
+
+    // The window and plan only depend on the settings, so keep them between runs
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+    try {
+        if (!m_stft || m_stft->sampleRate() != samplesPerSec || m_stft->frameSize() != static_cast<size_t>(frameSize)
+            || m_stft->hopSize() != static_cast<size_t>(hopSize) || m_stft->window() != window)
         {
-            m_combinedPoints[i].setY(m_combinedPoints[i].y() / DistributedDFTWorkerThread::getMaxSum());
+            m_stft = std::make_shared<const STFT>(samplesPerSec, frameSize, hopSize, window);
         }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid frame or hop size, aborting FTController::startSTFT()";
+        return;
+    }
 
-        m_numWorkersFinished = 0;
-        DistributedDFTWorkerThread::setMaxSum(0.0);
+    const qint64 numSamples = m_dataBuffer->bytesAvailable() / (format.sampleSize() / 8);
+    m_spectrogram = m_stft->createSpectrogram(numSamples);
+    m_stftNextFrame = 0;
 
-        m_timeEnd = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < m_STFTWorkerThreads.size(); ++i)
+    {
+        m_STFTWorkerThreads[i]->setAudioFormat(format);
+        m_STFTWorkerThreads[i]->setSTFT(m_stft, m_spectrogram, &m_stftNextFrame);
+        m_STFTWorkerThreads[i]->start();
+    }
+}
 
-        /* Getting number of seconds as a double. */
-        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
-        //qDebug() << "FTController::startDistributedDFT() Total Elapsed Time (s): " << elapsedSeconds.count();
-        emit spectrumDataReady(m_combinedPoints, elapsedSeconds.count());
+void FTController::startWelch(const QAudioFormat format, const STFT::Window window)
+{
+    m_timeStart = std::chrono::high_resolution_clock::now();
+
+    if (convertFirst(format, [this, window](const QAudioFormat convertedFormat) { startWelch(convertedFormat, window); }))
+        return;
+
+    if (decimateFirst(format, [this, window](const QAudioFormat decimatedFormat) { startWelch(decimatedFormat, window); }))
+        return;
+
+    // Reset data buffer to position 0
+    m_inputBuffer->seek(0);
+
+    if (!prepareWelchPSD(format, window))
+    {
+        qDebug() << "Invalid sample rate, aborting FTController::startWelch()";
+        return;
+    }
+
+    const qint64 numSamples = m_inputBuffer->bytesAvailable() / (format.sampleSize() / 8);
+    m_welchNumSegments = m_welch->numSegments(numSamples);
+
+    for (int i = 0; i < m_WelchWorkerThreads.size(); ++i)
+    {
+        m_WelchWorkerThreads[i]->setAudioFormat(format);
+        m_WelchWorkerThreads[i]->setWelchPSD(m_welch);
+        m_WelchWorkerThreads[i]->start();
     }
 }
 
-void FTController::handleDistributedFFTResults(const QVector<QPointF> points, const int workerID)
+void FTController::startChannelSpectra(const QAudioFormat format, const ChannelMode mode, const STFT::Window window)
 {
-    for (int i = 0; i < points.size(); ++i)
+    m_timeStart = std::chrono::high_resolution_clock::now();
+
+    std::shared_ptr<const SampleConverter> converter;
+
+    // Exception handling, should never get inside catch.
+    try {
+        converter = std::make_shared<const SampleConverter>(format);
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Unsupported sample format, aborting FTController::startChannelSpectra()";
+        return;
+    }
+
+    if (mode == ChannelMode::MidSide && converter->channelCount() != 2)
     {
-        int index = points[i].x() - Constants::MIN_FREQUENCY;
-        m_combinedPoints[index] = points[i];
+        qDebug() << "Mid/side needs a stereo input, aborting FTController::startChannelSpectra()";
+        return;
     }
 
-    //qDebug() << "FTController::handleDistributedFFTResults() worker " << workerID << " finished. Received " << points.size() << " points";
+    // Every channel is analyzed as mono 16 bit samples at the rate of the file
+    if (!prepareWelchPSD(SampleConverter::shortFormat(format), window))
+    {
+        qDebug() << "Invalid sample rate, aborting FTController::startChannelSpectra()";
+        return;
+    }
 
-    m_numWorkersFinished++;
+    const QByteArray source = sourceData();
+    const size_t numFrames = converter->numFrames(static_cast<size_t>(source.size()));
+    if (numFrames == 0)
+        return;
 
-    if (m_numWorkersFinished == Constants::NUM_FFT_WORKERS)
+    // The channels are converted once, all workers read them
+    std::shared_ptr<std::vector<std::vector<short>>> channels = std::make_shared<std::vector<std::vector<short>>>();
+    m_channelNames.clear();
+    if (mode == ChannelMode::MidSide)
     {
-        // Normalize y values
-        for (int i = 0; i < m_combinedPoints.size(); ++i)
+        channels->resize(2, std::vector<short>(numFrames));
+        converter->toMidSide(source.constData(), numFrames, (*channels)[0].data(), (*channels)[1].data());
+        m_channelNames << "Mid" << "Side";
+    }
+    else
+    {
+        const int numChannels = converter->channelCount();
+        channels->resize(numChannels, std::vector<short>(numFrames));
+        std::vector<short*> outputs(numChannels);
+        for (int c = 0; c < numChannels; ++c)
         {
-            m_combinedPoints[i].setX(i + Constants::MIN_FREQUENCY);
-            m_combinedPoints[i].setY(m_combinedPoints[i].y() / DistributedFFTWorkerThread::getMaxSum());
+            outputs[c] = (*channels)[c].data();
+            m_channelNames << (numChannels == 2 ? QString(c == 0 ? "Left" : "Right") : QString("Channel %1").arg(c + 1));
         }
+        converter->deinterleave(source.constData(), numFrames, outputs.data());
+    }
+    m_channelNumSegments = m_welch->numSegments(numFrames);
 
-        m_numWorkersFinished = 0;
-        DistributedFFTWorkerThread::setMaxSum(0.0);
+    for (int i = 0; i < m_ChannelWelchWorkerThreads.size(); ++i)
+    {
+        m_ChannelWelchWorkerThreads[i]->setWelchPSD(m_welch);
+        m_ChannelWelchWorkerThreads[i]->setChannels(channels);
+        m_ChannelWelchWorkerThreads[i]->start();
+    }
+}
 
-        m_timeEnd = std::chrono::high_resolution_clock::now();
+void FTController::startConstantQ(const QAudioFormat format, const int binsPerOctave)
+{
+    m_timeStart = std::chrono::high_resolution_clock::now();
 
-        /* Getting number of seconds as a double. */
-        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
-        //qDebug() << "FTController::startDistributedFFT() Total Elapsed Time (s): " << elapsedSeconds.count();
-        emit spectrumDataReady(m_combinedPoints, elapsedSeconds.count());
+    if (convertFirst(format, [this, binsPerOctave](const QAudioFormat convertedFormat) { startConstantQ(convertedFormat, binsPerOctave); }))
+        return;
+
+    if (decimateFirst(format, [this, binsPerOctave](const QAudioFormat decimatedFormat) { startConstantQ(decimatedFormat, binsPerOctave); }))
+        return;
+
+    // Reset data buffer to position 0
+    m_inputBuffer->seek(0);
+
+    // The spectral kernel only depends on the band, sample rate and resolution, so keep it between runs
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+
+    // Exception handling, should never get inside catch.
+    try {
+        if (!m_constantQ || m_constantQ->sampleRate() != samplesPerSec || m_constantQ->binsPerOctave() != binsPerOctave)
+        {
+            m_constantQ = std::make_shared<const ConstantQ>(samplesPerSec, Constants::MIN_FREQUENCY, Constants::MAX_FREQUENCY, binsPerOctave);
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid band or resolution, aborting FTController::startConstantQ()";
+        return;
+    }
+
+    for (int i = 0; i < m_ConstantQWorkerThreads.size(); ++i)
+    {
+        m_ConstantQWorkerThreads[i]->setAudioFormat(format);
+        m_ConstantQWorkerThreads[i]->setConstantQ(m_constantQ);
+        m_ConstantQWorkerThreads[i]->start();
+    }
+}
+
+void FTController::setDecimation(const bool enabled)
+{
+    m_decimation = enabled;
+}
+
+bool FTController::isDecimation() const
+{
+    return m_decimation;
+}
+
+bool FTController::decimateFirst(const QAudioFormat format, std::function<void(const QAudioFormat)> start)
+{
+    // Called again by handleDecimationResults(), the decimated samples are ready
+    if (m_decimated)
+    {
+        m_decimated = false;
+        setInputBuffer(m_decimatedBuffer);
+        return false;
+    }
+
+    setInputBuffer(m_dataBuffer);
+    if (!m_decimation)
+        return false;
+
+    // The filters only depend on the sample rate, so keep them between runs
+    // Exception handling, should never get inside catch.
+    try {
+        if (!m_decimator || m_decimator->inputRate() != format.sampleRate())
+        {
+            m_decimator = std::make_shared<const Decimator>(format.sampleRate(), Constants::MAX_FREQUENCY);
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Sample rate too low for the band, FTController::decimateFirst() keeps the full rate";
+        return false;
+    }
+
+    if (m_decimator->factor() == 1)
+        return false;
+
+    // Reset data buffer to position 0
+    m_dataBuffer->seek(0);
+
+    const qint64 numSamples = m_dataBuffer->bytesAvailable() / (format.sampleSize() / 8);
+    m_decimatedSamples = std::make_shared<std::vector<short>>(m_decimator->numOutputs(numSamples));
+    m_decimatedFormat = format;
+    m_decimatedFormat.setSampleRate(m_decimator->outputRate());
+    m_decimatedStart = start;
+
+    for (int i = 0; i < m_DecimatorWorkerThreads.size(); ++i)
+    {
+        m_DecimatorWorkerThreads[i]->setAudioFormat(format);
+        m_DecimatorWorkerThreads[i]->setDecimator(m_decimator, m_decimatedSamples);
+        m_DecimatorWorkerThreads[i]->start();
+    }
+
+    return true;
+}
+
+bool FTController::convertFirst(const QAudioFormat format, std::function<void(const QAudioFormat)> start)
+{
+    std::shared_ptr<const SampleConverter> converter;
+
+    // Exception handling, should never get inside catch.
+    try {
+        converter = std::make_shared<const SampleConverter>(format);
     }
+    catch (std::invalid_argument e) {
+        qDebug() << "Unsupported sample format, FTController::convertFirst() reads the samples as they are";
+        return false;
+    }
+
+    if (converter->isNative())
+        return false;
+
+    // The samples of a previous run may already be converted
+    if (!m_convertedSamples || m_convertedFrom != format)
+    {
+        // A view sharing the samples, kept for the conversions of later runs
+        m_sourceData = sourceData();
+
+        const size_t numFrames = converter->numFrames(static_cast<size_t>(m_sourceData.size()));
+        std::shared_ptr<std::vector<short>> samples = std::make_shared<std::vector<short>>(numFrames);
+        converter->toShort(m_sourceData.constData(), numFrames, SampleConverter::MIX, samples->data());
+
+        // Read only, a write would detach the view into a copy
+        m_dataBuffer->close();
+        m_dataBuffer->setData(QByteArray::fromRawData(reinterpret_cast<const char*>(samples->data()), static_cast<int>(numFrames * sizeof(short))));
+        m_dataBuffer->open(QIODevice::ReadOnly);
+        m_convertedSamples = samples;
+        m_convertedFrom = format;
+    }
+
+    // The transform restarts its clock, the elapsed time must include the conversion
+    const std::chrono::high_resolution_clock::time_point timeStart = m_timeStart;
+    start(SampleConverter::shortFormat(format));
+    m_timeStart = timeStart;
+
+    return true;
+}
+
+QByteArray FTController::sourceData() const
+{
+    return m_convertedSamples ? m_sourceData : m_dataBuffer->buffer();
+}
+
+void FTController::setInputBuffer(QBuffer* buffer)
+{
+    m_inputBuffer = buffer;
+
+    m_DFTWorkerThread->setDataBuffer(buffer);
+    m_FFTWorkerThread->setDataBuffer(buffer);
+    for (int i = 0; i < Constants::NUM_DFT_WORKERS; ++i)
+    {
+        m_DistributedDFTWorkerThreads[i]->setDataBuffer(buffer);
+    }
+    for (int i = 0; i < m_DistributedFFTWorkerThreads.size(); ++i)
+    {
+        m_DistributedFFTWorkerThreads[i]->setDataBuffer(buffer);
+    }
+    for (int i = 0; i < m_ZoomFFTWorkerThreads.size(); ++i)
+    {
+        m_ZoomFFTWorkerThreads[i]->setDataBuffer(buffer);
+    }
+    for (int i = 0; i < m_WelchWorkerThreads.size(); ++i)
+    {
+        m_WelchWorkerThreads[i]->setDataBuffer(buffer);
+    }
+    for (int i = 0; i < m_ConstantQWorkerThreads.size(); ++i)
+    {
+        m_ConstantQWorkerThreads[i]->setDataBuffer(buffer);
+    }
+}
+
+void FTController::startStream(const QAudioFormat format, const STFT::Window window)
+{
+    m_timeStart = std::chrono::high_resolution_clock::now();
+
+    // Exception handling, should never get inside catch.
+    try {
+        m_streamConverter = std::make_shared<const SampleConverter>(format);
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Unsupported sample format, aborting FTController::startStream()";
+        return;
+    }
+
+    // The chunks are converted to mono 16 bit samples as they arrive
+    if (!prepareWelchPSD(SampleConverter::shortFormat(format), window))
+    {
+        qDebug() << "Invalid sample rate, aborting FTController::startStream()";
+        return;
+    }
+
+    // A stream that was never finished is still waiting for samples. Only the transform
+    // workers are stopped, the live spectrum of the playback goes on.
+    if (m_StreamingWelchWorkerThread->isRunning())
+    {
+        terminateRunningThreads();
+    }
+
+    m_StreamingWelchWorkerThread->clearData();
+    m_streamBacklog.clear();
+    m_streamBacklogStart = 0;
+    m_streamFinishing = false;
+    m_StreamingWelchWorkerThread->setWelchPSD(m_welch);
+    m_StreamingWelchWorkerThread->start();
+}
+
+void FTController::appendStreamData(const char* data, const qint64 length)
+{
+    if (!m_StreamingWelchWorkerThread->isRunning())
+        return;
+
+    const size_t numFrames = m_streamConverter->numFrames(static_cast<size_t>(length));
+    const short* samples = (const short*)data;
+    if (!m_streamConverter->isNative())
+    {
+        m_streamSamples.resize(numFrames);
+        m_streamConverter->toShort(data, numFrames, SampleConverter::MIX, m_streamSamples.data());
+        samples = m_streamSamples.data();
+    }
+
+    // Samples still waiting go first, the new ones queue up behind them
+    size_t appended = 0;
+    if (m_streamBacklogStart == m_streamBacklog.size())
+    {
+        appended = m_StreamingWelchWorkerThread->appendSamples(samples, numFrames);
+    }
+    m_streamBacklog.insert(m_streamBacklog.end(), samples + appended, samples + numFrames);
+}
+
+void FTController::finishStream()
+{
+    // The end of the stream can only be told once the worker has all the samples
+    if (m_streamBacklogStart < m_streamBacklog.size())
+    {
+        m_streamFinishing = true;
+        return;
+    }
+
+    m_StreamingWelchWorkerThread->endOfStream();
+}
+
+void FTController::startLiveSpectrum(const QAudioFormat format, const int frameSize, const LiveMethod method)
+{
+    // A worker that was asked to stop may still be finishing its last frame
+    stopLiveSpectrum();
+    m_LiveSpectrumWorkerThread->wait();
+
+    // Exception handling, should never get inside catch.
+    try {
+        m_liveConverter = std::make_shared<const SampleConverter>(format);
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Unsupported sample format, aborting FTController::startLiveSpectrum()";
+        return;
+    }
+
+    // The playback is converted to mono 16 bit samples as it is pushed
+    const QAudioFormat liveFormat = SampleConverter::shortFormat(format);
+    const double samplesPerSec = liveFormat.bytesForDuration(1e6) / (liveFormat.sampleSize() / 8);
+
+    // Exception handling, should never get inside catch.
+    try {
+        if (!m_liveSTFT || m_liveSTFT->sampleRate() != samplesPerSec || m_liveSTFT->frameSize() != static_cast<size_t>(frameSize))
+        {
+            m_liveSTFT = std::make_shared<const STFT>(samplesPerSec, frameSize, frameSize, STFT::Window::Hann);
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid frame size, aborting FTController::startLiveSpectrum()";
+        return;
+    }
+
+    // The sliding DFT holds the state of the stream, so it is never shared between runs
+    std::shared_ptr<SlidingDFT> slidingDFT;
+    if (method == LiveMethod::SlidingDFT)
+    {
+        slidingDFT = std::make_shared<SlidingDFT>(samplesPerSec, frameSize, Constants::MIN_FREQUENCY, Constants::MAX_FREQUENCY);
+    }
+
+    m_LiveSpectrumWorkerThread->setSlidingDFT(slidingDFT);
+    m_LiveSpectrumWorkerThread->clearData();
+    m_LiveSpectrumWorkerThread->setSTFT(m_liveSTFT);
+    m_LiveSpectrumWorkerThread->start();
+}
+
+void FTController::stopLiveSpectrum()
+{
+    m_LiveSpectrumWorkerThread->requestInterruption();
+}
+
+void FTController::pushPlaybackData(const char* data, const qint64 length, const double outputDelaySeconds)
+{
+    if (!m_LiveSpectrumWorkerThread->isRunning())
+        return;
+
+    const size_t numFrames = m_liveConverter->numFrames(static_cast<size_t>(length));
+    if (m_liveConverter->isNative())
+    {
+        m_LiveSpectrumWorkerThread->pushSamples((const short*)data, numFrames, outputDelaySeconds);
+        return;
+    }
+
+    m_liveSamples.resize(numFrames);
+    m_liveConverter->toShort(data, numFrames, SampleConverter::MIX, m_liveSamples.data());
+    m_LiveSpectrumWorkerThread->pushSamples(m_liveSamples.data(), numFrames, outputDelaySeconds);
+}
+
+bool FTController::prepareWelchPSD(const QAudioFormat format, const STFT::Window window)
+{
+    // One second segments give 1 Hz bins, half of a segment of overlap
+    const double samplesPerSec = format.bytesForDuration(1e6) / (format.sampleSize() / 8);
+    const size_t segmentSize = static_cast<size_t>(samplesPerSec + 0.5);
+    const size_t hopSize = std::max<size_t>(1, segmentSize / 2);
+
+    // Exception handling, should never get inside catch.
+    try {
+        if (!m_welch || m_welch->sampleRate() != samplesPerSec || m_welch->window() != window)
+        {
+            m_welch = std::make_shared<const WelchPSD>(samplesPerSec, segmentSize, hopSize, window);
+        }
+    }
+    catch (std::invalid_argument e) {
+        return false;
+    }
+
+    return true;
+}
+
+void FTController::handleResults(const QVector<QPointF> points)
+{
+    m_timeEnd = std::chrono::high_resolution_clock::now();
+
+    /* Getting number of seconds as a double. */
+    std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+    //qDebug() << "FTController Total Elapsed Time (s): " << elapsedSeconds.count();
+
+    emit spectrumDataReady(points, elapsedSeconds.count());
+
+}
+
+void FTController::handleDistributedDFTResults(const QVector<QPointF> points, const int workerID)
+{
+    Q_UNUSED(workerID);
+
+    for (int i = 0; i < points.size(); ++i)
+    {
+        int index = points[i].x() - Constants::MIN_FREQUENCY;
+        m_combinedPoints[index] = points[i];
+    }
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == Constants::NUM_DFT_WORKERS)
+    {
+        // Normalize y values
+        for (int i = 0; i < m_combinedPoints.size(); ++i)
+        {
+            m_combinedPoints[i].setY(m_combinedPoints[i].y() / DistributedDFTWorkerThread::getMaxSum());
+        }
+
+        m_numWorkersFinished = 0;
+        DistributedDFTWorkerThread::setMaxSum(0.0);
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startDistributedDFT() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(m_combinedPoints, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleDistributedFFTResults(const QVector<QPointF> points, const int workerID)
+{
+    // Each worker owns a disjoint range of frequencies, so the merge order does not matter
+    for (int i = 0; i < points.size(); ++i)
+    {
+        int index = points[i].x() - Constants::MIN_FREQUENCY;
+        m_combinedPoints[index] = points[i];
+    }
+
+    //qDebug() << "FTController::handleDistributedFFTResults() worker " << workerID << " finished. Received " << points.size() << " points";
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_DistributedFFTWorkerThreads.size())
+    {
+        // Normalize y values
+        for (int i = 0; i < m_combinedPoints.size(); ++i)
+        {
+            m_combinedPoints[i].setX(i + Constants::MIN_FREQUENCY);
+            m_combinedPoints[i].setY(m_combinedPoints[i].y() / DistributedFFTWorkerThread::getMaxSum());
+        }
+
+        m_numWorkersFinished = 0;
+        DistributedFFTWorkerThread::setMaxSum(0.0);
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startDistributedFFT() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(m_combinedPoints, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleZoomFFTResults(const QVector<double> real, const QVector<double> imag, const int workerID)
+{
+    m_zoomPartialReal[workerID] = real;
+    m_zoomPartialImag[workerID] = imag;
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_ZoomFFTWorkerThreads.size())
+    {
+        // Add up the partial spectra in worker order, so the result does not depend on
+        // which worker finished first
+        const int numBins = static_cast<int>(m_zoomFFT->numBins());
+        std::vector<double> spectrumReal(numBins, 0.0);
+        std::vector<double> spectrumImag(numBins, 0.0);
+        for (int w = 0; w < m_zoomPartialReal.size(); ++w)
+        {
+            for (int k = 0; k < numBins; ++k)
+            {
+                spectrumReal[k] += m_zoomPartialReal[w][k];
+                spectrumImag[k] += m_zoomPartialImag[w][k];
+            }
+        }
+
+        // Normalize by the largest amplitude in the band
+        std::vector<double> amplitude(numBins);
+        const double maxSum = FFTKernels::magnitude(spectrumReal.data(), spectrumImag.data(), amplitude.data(), numBins);
+        if (maxSum > 0.0)
+        {
+            FFTKernels::scale(amplitude.data(), 1.0 / maxSum, numBins);
+        }
+
+        QVector<QPointF> points;
+        points.reserve(numBins);
+        for (int k = 0; k < numBins; ++k)
+        {
+            points.append(QPointF(m_zoomFFT->frequency(k), amplitude[k]));
+        }
+
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startZoomFFT() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(points, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleGoertzelResults(const QVector<double> real, const QVector<double> imag, const int workerID)
+{
+    m_goertzelPartialReal[workerID] = real;
+    m_goertzelPartialImag[workerID] = imag;
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_GoertzelWorkerThreads.size())
+    {
+        // Add up the partial sums in worker order, so the result does not depend on
+        // which worker finished first
+        const int numBins = static_cast<int>(m_goertzel->numBins());
+        std::vector<double> spectrumReal(numBins, 0.0);
+        std::vector<double> spectrumImag(numBins, 0.0);
+        for (int w = 0; w < m_goertzelPartialReal.size(); ++w)
+        {
+            for (int k = 0; k < numBins; ++k)
+            {
+                spectrumReal[k] += m_goertzelPartialReal[w][k];
+                spectrumImag[k] += m_goertzelPartialImag[w][k];
+            }
+        }
+
+        // Scale so that a full scale sine wave at a target frequency reads 1, whatever the
+        // other targets are: |X| of amplitude A over n samples is A * n / 2
+        std::vector<double> amplitude(numBins);
+        FFTKernels::magnitude(spectrumReal.data(), spectrumImag.data(), amplitude.data(), numBins);
+        if (m_goertzelNumSamples > 0)
+        {
+            FFTKernels::scale(amplitude.data(), 2.0 / (32767.0 * m_goertzelNumSamples), numBins);
+        }
+
+        QVector<QPointF> points;
+        points.reserve(numBins);
+        for (int k = 0; k < numBins; ++k)
+        {
+            points.append(QPointF(m_goertzel->frequency(k), amplitude[k]));
+        }
+
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startGoertzel() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(points, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleSTFTResults(const int workerID)
+{
+    Q_UNUSED(workerID);
+
+    m_numWorkersFinished++;
+
+    // Every frame has been written into the matrix once all the workers are done
+    if (m_numWorkersFinished == m_STFTWorkerThreads.size())
+    {
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startSTFT() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrogramReady(m_spectrogram, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleWelchResults(const QVector<double> power, const int workerID)
+{
+    m_welchPartialPower[workerID] = power;
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_WelchWorkerThreads.size())
+    {
+        // Add up the partial sums in worker order, so the result does not depend on
+        // which worker finished first
+        const size_t numBins = m_welch->numBins();
+        std::vector<double> psd(numBins, 0.0);
+        for (int w = 0; w < m_welchPartialPower.size(); ++w)
+        {
+            // Workers without a segment report an empty sum
+            if (static_cast<size_t>(m_welchPartialPower[w].size()) != numBins)
+                continue;
+
+            for (size_t k = 0; k < numBins; ++k)
+            {
+                psd[k] += m_welchPartialPower[w][static_cast<int>(k)];
+            }
+        }
+        const QVector<QPointF> points = welchSpectrumPoints(psd, m_welchNumSegments);
+
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startWelch() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(points, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleChannelWelchResults(const QVector<double> power, const int workerID)
+{
+    m_channelPartialPower[workerID] = power;
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_ChannelWelchWorkerThreads.size())
+    {
+        // Add up the partial sums of each channel in worker order, so the result does not
+        // depend on which worker finished first
+        const size_t numBins = m_welch->numBins();
+        const size_t numChannels = static_cast<size_t>(m_channelNames.size());
+        QVector<QVector<QPointF>> spectra;
+        double maxDensity = 0.0;
+        for (size_t c = 0; c < numChannels; ++c)
+        {
+            std::vector<double> psd(numBins, 0.0);
+            for (int w = 0; w < m_channelPartialPower.size(); ++w)
+            {
+                // Cancelled workers report an empty sum
+                if (static_cast<size_t>(m_channelPartialPower[w].size()) != numChannels * numBins)
+                    continue;
+
+                for (size_t k = 0; k < numBins; ++k)
+                {
+                    psd[k] += m_channelPartialPower[w][static_cast<int>(c * numBins + k)];
+                }
+            }
+
+            spectra.append(welchSpectrumPoints(psd, m_channelNumSegments, false));
+            for (int i = 0; i < spectra.last().size(); ++i)
+            {
+                maxDensity = std::max(maxDensity, spectra.last()[i].y());
+            }
+        }
+
+        // A common scale keeps the levels of the channels comparable
+        if (maxDensity > 0.0)
+        {
+            for (int c = 0; c < spectra.size(); ++c)
+            {
+                for (int i = 0; i < spectra[c].size(); ++i)
+                {
+                    spectra[c][i].setY(spectra[c][i].y() / maxDensity);
+                }
+            }
+        }
+
+        // The converted channels are only needed by the workers
+        for (int i = 0; i < m_ChannelWelchWorkerThreads.size(); ++i)
+        {
+            m_ChannelWelchWorkerThreads[i]->setChannels(nullptr);
+        }
+
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startChannelSpectra() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit channelSpectraReady(spectra, m_channelNames, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleConstantQResults(const QVector<double> amplitudeSums, const int workerID)
+{
+    m_constantQPartialSums[workerID] = amplitudeSums;
+
+    m_numWorkersFinished++;
+
+    if (m_numWorkersFinished == m_ConstantQWorkerThreads.size())
+    {
+        // Add up the partial sums in worker order, so the result does not depend on
+        // which worker finished first
+        const int numBins = static_cast<int>(m_constantQ->numBins());
+        std::vector<double> amplitude(numBins, 0.0);
+        for (int w = 0; w < m_constantQPartialSums.size(); ++w)
+        {
+            // Workers without a frame report an empty sum
+            if (m_constantQPartialSums[w].size() != numBins)
+                continue;
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                amplitude[k] += m_constantQPartialSums[w][k];
+            }
+        }
+
+        // Normalize by the largest amplitude in the band, averaging over the frames cancels out
+        double maxSum = 0.0;
+        for (int k = 0; k < numBins; ++k)
+        {
+            maxSum = std::max(maxSum, amplitude[k]);
+        }
+
+        QVector<QPointF> points;
+        points.reserve(numBins);
+        for (int k = 0; k < numBins; ++k)
+        {
+            points.append(QPointF(m_constantQ->frequency(k), maxSum > 0.0 ? amplitude[k] / maxSum : 0.0));
+        }
+
+        m_numWorkersFinished = 0;
+
+        m_timeEnd = std::chrono::high_resolution_clock::now();
+
+        /* Getting number of seconds as a double. */
+        std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+        //qDebug() << "FTController::startConstantQ() Total Elapsed Time (s): " << elapsedSeconds.count();
+        emit spectrumDataReady(points, elapsedSeconds.count());
+    }
+}
+
+void FTController::handleDecimationResults(const int workerID)
+{
+    Q_UNUSED(workerID);
+
+    // A run cancelled by clear() has nothing left to start
+    if (!m_decimatedStart)
+        return;
+
+    m_numWorkersFinished++;
+
+    // Every decimated sample has been written once all the workers are done
+    if (m_numWorkersFinished == m_DecimatorWorkerThreads.size())
+    {
+        m_numWorkersFinished = 0;
+
+        m_decimatedBuffer->close();
+        m_decimatedBuffer->setData((const char*)m_decimatedSamples->data(), static_cast<int>(m_decimatedSamples->size() * sizeof(short)));
+        m_decimatedBuffer->open(QIODevice::ReadWrite);
+        m_decimatedSamples.reset();
+
+        std::function<void(const QAudioFormat)> start;
+        start.swap(m_decimatedStart);
+
+        // The transform restarts its clock, the elapsed time must include the decimation
+        const std::chrono::high_resolution_clock::time_point timeStart = m_timeStart;
+        m_decimated = true;
+        start(m_decimatedFormat);
+        m_timeStart = timeStart;
+    }
+}
+
+void FTController::handleStreamingResults(const QVector<double> power, const qint64 numSegments, const bool isFinal)
+{
+    Q_UNUSED(isFinal);
+
+    std::vector<double> psd(power.begin(), power.end());
+    const QVector<QPointF> points = welchSpectrumPoints(psd, static_cast<size_t>(numSegments));
+
+    m_timeEnd = std::chrono::high_resolution_clock::now();
+
+    /* Getting number of seconds as a double. */
+    std::chrono::duration<double> elapsedSeconds = m_timeEnd - m_timeStart;
+    //qDebug() << "FTController::startStream()" << numSegments << "segments, final:" << isFinal << "Elapsed Time (s): " << elapsedSeconds.count();
+    emit spectrumDataReady(points, elapsedSeconds.count());
+}
+
+void FTController::handleStreamSpace()
+{
+    if (m_streamBacklogStart < m_streamBacklog.size())
+    {
+        m_streamBacklogStart += m_StreamingWelchWorkerThread->appendSamples(m_streamBacklog.data() + m_streamBacklogStart,
+                                                                            m_streamBacklog.size() - m_streamBacklogStart);
+    }
+
+    // Drop the appended samples once they are the larger part, each sample is then moved at most once
+    if (m_streamBacklogStart == m_streamBacklog.size())
+    {
+        m_streamBacklog.clear();
+        m_streamBacklogStart = 0;
+    }
+    else if (m_streamBacklogStart > m_streamBacklog.size() / 2)
+    {
+        m_streamBacklog.erase(m_streamBacklog.begin(), m_streamBacklog.begin() + m_streamBacklogStart);
+        m_streamBacklogStart = 0;
+    }
+
+    if (m_streamFinishing && m_streamBacklog.empty())
+    {
+        m_streamFinishing = false;
+        m_StreamingWelchWorkerThread->endOfStream();
+    }
+}
+
+void FTController::handleLiveResults(const QVector<QPointF> points, const double latencySeconds)
+{
+    emit liveSpectrumReady(points, latencySeconds);
+}
+
+QVector<QPointF> FTController::welchSpectrumPoints(std::vector<double>& psd, const size_t numSegments, const bool normalize) const
+{
+    m_welch->finish(psd, numSegments);
+
+    // Keep the displayed band and normalize it by its largest density
+    QVector<QPointF> points;
+    double maxSum = 0.0;
+    for (size_t k = 0; k < psd.size(); ++k)
+    {
+        const double frequency = m_welch->frequency(k);
+        if (frequency < Constants::MIN_FREQUENCY - 0.5 || frequency > Constants::MAX_FREQUENCY + 0.5)
+            continue;
+
+        points.append(QPointF(frequency, psd[k]));
+        maxSum = std::max(maxSum, psd[k]);
+    }
+
+    if (normalize && maxSum > 0.0)
+    {
+        for (int i = 0; i < points.size(); ++i)
+        {
+            points[i].setY(points[i].y() / maxSum);
+        }
+    }
+
+    return points;
 }
@@ -0,0 +1,312 @@
+#define _USE_MATH_DEFINES
+
+#include "FourStepFFT.h"
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QThread>
+
+// How often the twiddle recurrence of a column is reset to the exact value
+static const size_t TWIDDLE_RESYNC_INTERVAL = 64;
+
+// Number of neighbouring columns (rows) gathered and scattered together
+static const size_t TRANSPOSE_BLOCK = 8;
+
+FourStepFFT::FourStepFFT(int numWorkers)
+    : m_numWorkers(numWorkers)
+    , m_arrived(0)
+    , m_generation(0)
+    , m_aborted(false)
+    , m_size(0)
+    , m_complexSize(0)
+    , m_rows(0)
+    , m_columns(0)
+    , m_packed(false)
+    , m_singlePrecision(false)
+{
+
+}
+
+int FourStepFFT::numWorkers() const
+{
+    return m_numWorkers;
+}
+
+void FourStepFFT::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_arrived = 0;
+    m_aborted = false;
+}
+
+void FourStepFFT::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = true;
+    m_condition.wakeAll();
+}
+
+bool FourStepFFT::synchronize()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_aborted)
+        return false;
+
+    const unsigned int generation = m_generation;
+    if (++m_arrived == m_numWorkers)
+    {
+        m_arrived = 0;
+        m_generation++;
+        m_condition.wakeAll();
+        return true;
+    }
+
+    // Wake up regularly so an interruption of this worker is noticed even while others wait
+    QThread* thread = QThread::currentThread();
+    while (generation == m_generation && !m_aborted)
+    {
+        m_condition.wait(&m_mutex, 10);
+        if (thread->isInterruptionRequested())
+        {
+            m_aborted = true;
+            m_condition.wakeAll();
+        }
+    }
+
+    return !m_aborted;
+}
+
+void FourStepFFT::workerRange(int workerID, size_t count, size_t& first, size_t& last) const
+{
+    first = (workerID * count) / m_numWorkers;
+    last = ((workerID + 1) * count) / m_numWorkers;
+}
+
+void FourStepFFT::prepare(size_t n)
+{
+    m_size = n;
+    m_packed = n % 2 == 0;
+    m_complexSize = m_packed ? n / 2 : n;
+
+    // Largest divisor of M not above sqrt(M). Prime lengths end up as a single column,
+    // which is still correct but leaves all the work to worker 0.
+    m_columns = 1;
+    for (size_t d = 1; d * d <= m_complexSize; d++)
+    {
+        if (m_complexSize % d == 0)
+            m_columns = d;
+    }
+    m_rows = m_complexSize / m_columns;
+
+    m_columnPlan = FFTPlan::forSize(m_rows);
+    m_rowPlan = FFTPlan::forSize(m_columns);
+    m_realPlan = m_packed ? FFTPlan::forSize(n) : nullptr;
+
+    // Only keep the buffers of the precision in use
+    m_singlePrecision = FFTPlan::precision() == FFTPlan::Precision::Single;
+    if (m_singlePrecision)
+    {
+        m_singleBuffers.resize(m_complexSize);
+        m_doubleBuffers.release();
+    }
+    else
+    {
+        m_doubleBuffers.resize(m_complexSize);
+        m_singleBuffers.release();
+    }
+}
+
+template <typename T>
+void FourStepFFT::Buffers<T>::resize(size_t count)
+{
+    matrixReal.resize(count);
+    matrixImag.resize(count);
+    spectrumReal.resize(count);
+    spectrumImag.resize(count);
+}
+
+template <typename T>
+void FourStepFFT::Buffers<T>::release()
+{
+    std::vector<T>().swap(matrixReal);
+    std::vector<T>().swap(matrixImag);
+    std::vector<T>().swap(spectrumReal);
+    std::vector<T>().swap(spectrumImag);
+}
+
+template <typename T>
+bool FourStepFFT::transformColumns(int workerID, const short* samples, Buffers<T>& buffers)
+{
+    size_t first, last;
+    workerRange(workerID, m_columns, first, last);
+
+    std::vector<std::vector<T>> real(TRANSPOSE_BLOCK, std::vector<T>(m_rows));
+    std::vector<std::vector<T>> imag(TRANSPOSE_BLOCK, std::vector<T>(m_rows));
+    for (size_t block = first; block < last; block += TRANSPOSE_BLOCK)
+    {
+        const size_t count = std::min(TRANSPOSE_BLOCK, last - block);
+
+        // Gather several neighbouring columns at once so every cache line of samples read is
+        // used fully, packing even samples as the real part and odd samples as the imaginary part
+        for (size_t j2 = 0; j2 < m_rows; j2++)
+        {
+            const size_t index = block + m_columns * j2;
+            for (size_t b = 0; b < count; b++)
+            {
+                real[b][j2] = m_packed ? samples[2 * (index + b)] : samples[index + b];
+                imag[b][j2] = m_packed ? samples[2 * (index + b) + 1] : 0;
+            }
+        }
+
+        for (size_t b = 0; b < count; b++)
+        {
+            const size_t j1 = block + b;
+            if (!m_columnPlan->transform(real[b], imag[b]))
+                return false;
+
+            // Multiply by exp(-2*pi*i*j1*k2/M), stepping the twiddle by a fixed rotation and
+            // resetting it to the exact value regularly to keep the error from accumulating
+            const double step = 2 * M_PI * j1 / m_complexSize;
+            const double stepCos = std::cos(step);
+            const double stepSin = std::sin(step);
+            double twCos = 1.0;
+            double twSin = 0.0;
+
+            const T* inReal = real[b].data();
+            const T* inImag = imag[b].data();
+            T* outReal = &buffers.matrixReal[j1 * m_rows];
+            T* outImag = &buffers.matrixImag[j1 * m_rows];
+            for (size_t k2 = 0; k2 < m_rows; k2++)
+            {
+                if (k2 % TWIDDLE_RESYNC_INTERVAL == 0)
+                {
+                    const double angle = 2 * M_PI * ((j1 * k2) % m_complexSize) / m_complexSize;
+                    twCos = std::cos(angle);
+                    twSin = std::sin(angle);
+                }
+
+                outReal[k2] = static_cast<T>(inReal[k2] * twCos + inImag[k2] * twSin);
+                outImag[k2] = static_cast<T>(inImag[k2] * twCos - inReal[k2] * twSin);
+
+                const double nextCos = twCos * stepCos - twSin * stepSin;
+                twSin = twSin * stepCos + twCos * stepSin;
+                twCos = nextCos;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+bool FourStepFFT::transformRows(int workerID, Buffers<T>& buffers)
+{
+    size_t first, last;
+    workerRange(workerID, m_rows, first, last);
+
+    std::vector<std::vector<T>> real(TRANSPOSE_BLOCK, std::vector<T>(m_columns));
+    std::vector<std::vector<T>> imag(TRANSPOSE_BLOCK, std::vector<T>(m_columns));
+    for (size_t block = first; block < last; block += TRANSPOSE_BLOCK)
+    {
+        const size_t count = std::min(TRANSPOSE_BLOCK, last - block);
+
+        for (size_t j1 = 0; j1 < m_columns; j1++)
+        {
+            const size_t index = j1 * m_rows + block;
+            for (size_t b = 0; b < count; b++)
+            {
+                real[b][j1] = buffers.matrixReal[index + b];
+                imag[b][j1] = buffers.matrixImag[index + b];
+            }
+        }
+
+        for (size_t b = 0; b < count; b++)
+        {
+            if (!m_rowPlan->transform(real[b], imag[b]))
+                return false;
+        }
+
+        // Row k2 holds the bins k2 + n2 * k1 of the complex transform
+        for (size_t k1 = 0; k1 < m_columns; k1++)
+        {
+            const size_t index = block + m_rows * k1;
+            for (size_t b = 0; b < count; b++)
+            {
+                buffers.spectrumReal[index + b] = real[b][k1];
+                buffers.spectrumImag[index + b] = imag[b][k1];
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+void FourStepFFT::untangle(int workerID, Buffers<T>& buffers, size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude)
+{
+    size_t last;
+    workerRange(workerID, m_size / 2 + 1, firstBin, last);
+
+    std::vector<T> real(last - firstBin);
+    std::vector<T> imag(last - firstBin);
+    if (m_packed)
+    {
+        m_realPlan->untangleReal(buffers.spectrumReal.data(), buffers.spectrumImag.data(), firstBin, last,
+                                 real.data(), imag.data());
+    }
+    else
+    {
+        std::copy(buffers.spectrumReal.begin() + firstBin, buffers.spectrumReal.begin() + last, real.begin());
+        std::copy(buffers.spectrumImag.begin() + firstBin, buffers.spectrumImag.begin() + last, imag.begin());
+    }
+
+    // Magnitudes are computed in place and always handed out as doubles
+    maxMagnitude = FFTKernels::magnitude(real.data(), imag.data(), real.data(), real.size());
+    magnitudes.assign(real.begin(), real.end());
+}
+
+template <typename T>
+bool FourStepFFT::runSteps(int workerID, const short* samples, Buffers<T>& buffers,
+                           size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude)
+{
+    if (!transformColumns(workerID, samples, buffers))
+    {
+        abort();
+        return false;
+    }
+
+    if (!synchronize())
+        return false;
+
+    if (!transformRows(workerID, buffers))
+    {
+        abort();
+        return false;
+    }
+
+    if (!synchronize())
+        return false;
+
+    untangle(workerID, buffers, firstBin, magnitudes, maxMagnitude);
+    return true;
+}
+
+bool FourStepFFT::run(int workerID, const short* samples, size_t n,
+                      size_t& firstBin, std::vector<double>& magnitudes, double& maxMagnitude)
+{
+    magnitudes.clear();
+    maxMagnitude = 0.0;
+
+    if (workerID == 0)
+        prepare(n);
+
+    if (!synchronize())
+        return false;
+
+    if (m_singlePrecision)
+        return runSteps(workerID, samples, m_singleBuffers, firstBin, magnitudes, maxMagnitude);
+
+    return runSteps(workerID, samples, m_doubleBuffers, firstBin, magnitudes, maxMagnitude);
+}
@@ -0,0 +1,94 @@
+#define _USE_MATH_DEFINES
+
+#include "GoertzelFilterBank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+GoertzelFilterBank::GoertzelFilterBank(double sampleRate, const std::vector<double>& frequencies)
+    : m_sampleRate(sampleRate)
+    , m_frequencies(frequencies)
+{
+    if (sampleRate <= 0.0 || frequencies.empty())
+    {
+        throw std::invalid_argument("GoertzelFilterBank::GoertzelFilterBank() Invalid sample rate or frequencies");
+    }
+
+    m_coefficients.resize(m_frequencies.size());
+    m_cos.resize(m_frequencies.size());
+    m_sin.resize(m_frequencies.size());
+    for (size_t k = 0; k < m_frequencies.size(); k++)
+    {
+        const double w = angle(k, 1);
+        m_cos[k] = std::cos(w);
+        m_sin[k] = std::sin(w);
+        m_coefficients[k] = 2.0 * m_cos[k];
+    }
+}
+
+double GoertzelFilterBank::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t GoertzelFilterBank::numBins() const
+{
+    return m_frequencies.size();
+}
+
+double GoertzelFilterBank::frequency(size_t k) const
+{
+    return m_frequencies[k];
+}
+
+double GoertzelFilterBank::angle(size_t k, size_t n) const
+{
+    const double cycles = m_frequencies[k] * static_cast<double>(n) / m_sampleRate;
+    return 2 * M_PI * (cycles - std::floor(cycles));
+}
+
+void GoertzelFilterBank::accumulate(const short* samples, size_t first, size_t last,
+                                    std::vector<double>& real, std::vector<double>& imag) const
+{
+    const size_t numBins = m_frequencies.size();
+    if (real.size() != numBins || imag.size() != numBins)
+    {
+        throw std::invalid_argument("GoertzelFilterBank::accumulate() Size mismatch for output vectors");
+    }
+
+    std::vector<double> s1(numBins);
+    std::vector<double> s2(numBins);
+
+    for (size_t blockStart = first; blockStart < last; blockStart += BLOCK_SIZE)
+    {
+        const size_t blockEnd = std::min(last, blockStart + BLOCK_SIZE);
+        std::fill(s1.begin(), s1.end(), 0.0);
+        std::fill(s2.begin(), s2.end(), 0.0);
+
+        // s[n] = x[n] + 2cos(w) * s[n - 1] - s[n - 2], the bins are independent chains
+        for (size_t n = blockStart; n < blockEnd; n++)
+        {
+            const double x = samples[n];
+            for (size_t k = 0; k < numBins; k++)
+            {
+                const double s0 = x + m_coefficients[k] * s1[k] - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+
+        // The DFT of the block is exp(-i*w*(L - 1)) * (s[L - 1] - exp(-i*w) * s[L - 2]). Shifting
+        // it to its position in the signal makes the phase exp(-i*w*(blockEnd - 1)).
+        for (size_t k = 0; k < numBins; k++)
+        {
+            const double yRe = s1[k] - m_cos[k] * s2[k];
+            const double yIm = m_sin[k] * s2[k];
+            const double a = angle(k, blockEnd - 1);
+            const double c = std::cos(a);
+            const double s = std::sin(a);
+            real[k] += yRe * c + yIm * s;
+            imag[k] += yIm * c - yRe * s;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#include "GoertzelWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GoertzelWorkerThread::GoertzelWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+GoertzelWorkerThread::~GoertzelWorkerThread()
+{
+
+}
+
+int GoertzelWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void GoertzelWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void GoertzelWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void GoertzelWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void GoertzelWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void GoertzelWorkerThread::setFilterBank(std::shared_ptr<const GoertzelFilterBank> filterBank)
+{
+    m_filterBank = filterBank;
+}
+
+void GoertzelWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void GoertzelWorkerThread::clearData()
+{
+    m_real.clear();
+    m_imag.clear();
+}
+
+void GoertzelWorkerThread::run()
+{
+    clearData();
+
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_filterBank)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    // range calculation for current worker
+    const size_t sampleStart = (m_workerID * static_cast<size_t>(N)) / m_numWorkers;
+    const size_t sampleEnd = ((m_workerID + 1) * static_cast<size_t>(N)) / m_numWorkers;
+
+    std::vector<double> real(m_filterBank->numBins(), 0.0);
+    std::vector<double> imag(m_filterBank->numBins(), 0.0);
+
+    // Cancellation is only checked between blocks of samples, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, GoertzelFilterBank::BLOCK_SIZE);
+
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t first = sampleStart; first < sampleEnd; )
+        {
+            const size_t last = first + std::min(sampleEnd - first, checkpoint.blockSize());
+            m_filterBank->accumulate(data_short, first, last, real, imag);
+            first = last;
+
+            if (checkpoint.reached())
+            {
+                clearData();
+                return;
+            }
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vectors, aborting GoertzelWorkerThread::run()";
+        return;
+    }
+
+    m_real.resize(static_cast<int>(real.size()));
+    m_imag.resize(static_cast<int>(imag.size()));
+    std::copy(real.begin(), real.end(), m_real.begin());
+    std::copy(imag.begin(), imag.end(), m_imag.begin());
+
+    emit goertzelResultReady(m_real, m_imag, m_workerID);
+}
@@ -0,0 +1,147 @@
+#include "LiveSpectrumWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+LiveSpectrumWorkerThread::LiveSpectrumWorkerThread()
+    : m_ring(4 * Constants::LIVE_SPECTRUM_FRAME_SIZE)
+    , m_lastPushTime(0)
+    , m_outputDelay(0.0)
+{
+    qRegisterMetaType<QVector<QPointF>>("QVector<QPointF>");
+}
+
+LiveSpectrumWorkerThread::~LiveSpectrumWorkerThread()
+{
+
+}
+
+void LiveSpectrumWorkerThread::setSTFT(std::shared_ptr<const STFT> stft)
+{
+    m_stft = stft;
+}
+
+void LiveSpectrumWorkerThread::setSlidingDFT(std::shared_ptr<SlidingDFT> slidingDFT)
+{
+    m_slidingDFT = slidingDFT;
+}
+
+void LiveSpectrumWorkerThread::pushSamples(const short* samples, size_t count, double outputDelaySeconds)
+{
+    m_ring.write(samples, count);
+    m_outputDelay.store(outputDelaySeconds, std::memory_order_relaxed);
+    m_lastPushTime.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void LiveSpectrumWorkerThread::clearData()
+{
+    m_ring.clear();
+    if (m_slidingDFT)
+    {
+        m_slidingDFT->clear();
+    }
+}
+
+void LiveSpectrumWorkerThread::run()
+{
+    if (!m_stft && !m_slidingDFT)
+    {
+        return;
+    }
+
+    const size_t frameSize = m_slidingDFT ? m_slidingDFT->windowSize() : m_stft->frameSize();
+    const double sampleRate = m_slidingDFT ? m_slidingDFT->sampleRate() : m_stft->sampleRate();
+    std::vector<short> frame(frameSize, 0);
+    std::vector<short> incoming(frameSize);
+    std::shared_ptr<Spectrogram> spectrum;
+    if (!m_slidingDFT)
+    {
+        spectrum = m_stft->createSpectrogram(frameSize);
+    }
+
+    const auto interval = std::chrono::milliseconds(Constants::LIVE_SPECTRUM_INTERVAL_MS);
+    auto nextFrame = Clock::now();
+
+    while (!isInterruptionRequested())
+    {
+        // Keep a steady rate, but never try to catch up on missed frames
+        nextFrame = std::max(nextFrame + interval, Clock::now());
+        QThread::msleep(static_cast<unsigned long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - Clock::now()).count()));
+
+        // Anything older than one frame would only add latency
+        m_ring.discard(frameSize);
+        const size_t count = m_ring.read(incoming.data(), frameSize);
+        if (count == 0)
+            continue;
+
+        QVector<QPointF> points;
+        if (m_slidingDFT)
+        {
+            m_slidingDFT->update(incoming.data(), count);
+            points = slidingDFTPoints();
+        }
+        else
+        {
+            // Slide the frame by the new samples
+            std::copy(frame.begin() + count, frame.end(), frame.begin());
+            std::copy(incoming.begin(), incoming.begin() + count, frame.end() - count);
+
+            // Exception handling, should never get inside catch.
+            try {
+                points = stftPoints(frame, *spectrum);
+            }
+            catch (std::invalid_argument e) {
+                qDebug() << "Invalid spectrum, aborting LiveSpectrumWorkerThread::run()";
+                return;
+            }
+        }
+
+        if (points.isEmpty())
+            continue;
+
+        // Age of the newest sample, plus what the output device had queued before it and half a
+        // frame for the center of the window
+        const Clock::duration sincePush = Clock::now().time_since_epoch()
+            - Clock::duration(m_lastPushTime.load(std::memory_order_relaxed));
+        const double latencySeconds = std::chrono::duration<double>(sincePush).count()
+            + m_outputDelay.load(std::memory_order_relaxed) + 0.5 * frameSize / sampleRate;
+
+        emit liveResultReady(points, latencySeconds);
+    }
+}
+
+QVector<QPointF> LiveSpectrumWorkerThread::stftPoints(const std::vector<short>& frame, Spectrogram& spectrum)
+{
+    QVector<QPointF> points;
+    if (!m_stft->transformFrames(frame.data(), frame.size(), 0, 1, spectrum))
+        return points;
+
+    const float* magnitudes = spectrum.frame(0);
+    for (size_t k = 0; k < spectrum.numBins(); ++k)
+    {
+        const double frequency = spectrum.frequency(k);
+        if (frequency >= Constants::MIN_FREQUENCY && frequency <= Constants::MAX_FREQUENCY)
+        {
+            points.append(QPointF(frequency, magnitudes[k]));
+        }
+    }
+
+    return points;
+}
+
+QVector<QPointF> LiveSpectrumWorkerThread::slidingDFTPoints()
+{
+    std::vector<double> amplitudes(m_slidingDFT->numBins());
+    m_slidingDFT->magnitudes(amplitudes.data());
+
+    QVector<QPointF> points;
+    points.reserve(static_cast<int>(amplitudes.size()));
+    for (size_t i = 0; i < amplitudes.size(); ++i)
+    {
+        points.append(QPointF(m_slidingDFT->frequency(i), amplitudes[i]));
+    }
+
+    return points;
+}
@@ -0,0 +1,223 @@
+#define _USE_MATH_DEFINES
+
+#include "STFT.h"
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+Spectrogram::Spectrogram(double sampleRate, size_t frameSize, size_t hopSize, size_t numFrames)
+    : m_sampleRate(sampleRate)
+    , m_frameSize(frameSize)
+    , m_hopSize(hopSize)
+    , m_numFrames(numFrames)
+    , m_numBins(frameSize / 2 + 1)
+    , m_magnitudes(numFrames * (frameSize / 2 + 1), 0.0f)
+{
+
+}
+
+double Spectrogram::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t Spectrogram::frameSize() const
+{
+    return m_frameSize;
+}
+
+size_t Spectrogram::hopSize() const
+{
+    return m_hopSize;
+}
+
+size_t Spectrogram::numFrames() const
+{
+    return m_numFrames;
+}
+
+size_t Spectrogram::numBins() const
+{
+    return m_numBins;
+}
+
+double Spectrogram::frequency(size_t k) const
+{
+    return k * m_sampleRate / m_frameSize;
+}
+
+double Spectrogram::time(size_t f) const
+{
+    return (f * m_hopSize + 0.5 * m_frameSize) / m_sampleRate;
+}
+
+const float* Spectrogram::frame(size_t f) const
+{
+    return m_magnitudes.data() + f * m_numBins;
+}
+
+float* Spectrogram::frame(size_t f)
+{
+    return m_magnitudes.data() + f * m_numBins;
+}
+
+const std::vector<float>& Spectrogram::magnitudes() const
+{
+    return m_magnitudes;
+}
+
+STFT::STFT(double sampleRate, size_t frameSize, size_t hopSize, Window window)
+    : m_sampleRate(sampleRate)
+    , m_frameSize(frameSize)
+    , m_hopSize(hopSize)
+    , m_window(window)
+    , m_scale(0.0)
+{
+    if (sampleRate <= 0.0 || frameSize < 2 || hopSize == 0)
+    {
+        throw std::invalid_argument("STFT::STFT() Invalid frame or hop size");
+    }
+
+    m_plan = FFTPlan::forSize(frameSize);
+
+    m_windowTable = createWindow(window, frameSize);
+    double sum = 0.0;
+    for (size_t i = 0; i < frameSize; i++)
+    {
+        sum += m_windowTable[i];
+    }
+
+    m_scale = 2.0 / (32767.0 * sum);
+}
+
+double STFT::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t STFT::frameSize() const
+{
+    return m_frameSize;
+}
+
+size_t STFT::hopSize() const
+{
+    return m_hopSize;
+}
+
+STFT::Window STFT::window() const
+{
+    return m_window;
+}
+
+size_t STFT::numFrames(size_t n) const
+{
+    if (n <= m_frameSize)
+        return n > 0 ? 1 : 0;
+
+    return 1 + (n - m_frameSize + m_hopSize - 1) / m_hopSize;
+}
+
+std::shared_ptr<Spectrogram> STFT::createSpectrogram(size_t n) const
+{
+    return std::make_shared<Spectrogram>(m_sampleRate, m_frameSize, m_hopSize, numFrames(n));
+}
+
+bool STFT::transformFrames(const short* samples, size_t n, size_t firstFrame, size_t lastFrame,
+                           Spectrogram& spectrogram) const
+{
+    if (spectrogram.frameSize() != m_frameSize || lastFrame > spectrogram.numFrames())
+    {
+        throw std::invalid_argument("STFT::transformFrames() Spectrogram does not match the transform");
+    }
+
+    // The frames are windowed into a block and transformed together, in buffers each thread
+    // keeps for its next call
+    const size_t numBins = spectrogram.numBins();
+    const size_t maxBatch = FFTPlan::MAX_BATCH_FRAMES;
+    const size_t blockSize = std::min(maxBatch, lastFrame - firstFrame);
+    thread_local std::vector<double> frames;
+    thread_local std::vector<double> real;
+    thread_local std::vector<double> imag;
+    if (frames.size() < blockSize * m_frameSize)
+        frames.resize(blockSize * m_frameSize);
+    if (real.size() < blockSize * numBins)
+    {
+        real.resize(blockSize * numBins);
+        imag.resize(blockSize * numBins);
+    }
+
+    for (size_t blockStart = firstFrame; blockStart < lastFrame; blockStart += FFTPlan::MAX_BATCH_FRAMES)
+    {
+        const size_t blockEnd = std::min(lastFrame, blockStart + FFTPlan::MAX_BATCH_FRAMES);
+        for (size_t f = blockStart; f < blockEnd; f++)
+        {
+            const size_t start = f * m_hopSize;
+            const size_t count = start < n ? std::min(m_frameSize, n - start) : 0;
+
+            double* frame = frames.data() + (f - blockStart) * m_frameSize;
+            for (size_t i = 0; i < count; i++)
+            {
+                frame[i] = samples[start + i] * m_windowTable[i];
+            }
+            std::fill(frame + count, frame + m_frameSize, 0.0);
+        }
+
+        if (!m_plan->transformRealBatch(frames.data(), blockEnd - blockStart, m_frameSize, real.data(), imag.data(), numBins))
+            return false;
+
+        for (size_t f = blockStart; f < blockEnd; f++)
+        {
+            double* bins = real.data() + (f - blockStart) * numBins;
+            FFTKernels::magnitude(bins, imag.data() + (f - blockStart) * numBins, bins, numBins);
+            FFTKernels::scale(bins, m_scale, numBins);
+            std::copy(bins, bins + numBins, spectrogram.frame(f));
+        }
+    }
+
+    return true;
+}
+
+std::vector<double> STFT::createWindow(Window window, size_t size)
+{
+    // Periodic windows, so overlapping frames add up evenly
+    std::vector<double> table(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        const double a = 2 * M_PI * i / size;
+        switch (window)
+        {
+        case Window::Hann:
+            table[i] = 0.5 - 0.5 * std::cos(a);
+            break;
+        case Window::Hamming:
+            table[i] = 0.54 - 0.46 * std::cos(a);
+            break;
+        case Window::Blackman:
+            table[i] = 0.42 - 0.5 * std::cos(a) + 0.08 * std::cos(2 * a);
+            break;
+        default:
+            table[i] = 1.0;
+            break;
+        }
+    }
+
+    return table;
+}
+
+const char* STFT::windowName(Window window)
+{
+    switch (window)
+    {
+    case Window::Hann:
+        return "Hann";
+    case Window::Hamming:
+        return "Hamming";
+    case Window::Blackman:
+        return "Blackman";
+    default:
+        return "Rectangular";
+    }
+}
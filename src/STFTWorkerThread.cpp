@@ -0,0 +1,101 @@
+#include "STFTWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+STFTWorkerThread::STFTWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
+    , m_nextFrame(nullptr)
+    , m_workerID(0)
+{
+
+}
+
+STFTWorkerThread::~STFTWorkerThread()
+{
+
+}
+
+int STFTWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void STFTWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void STFTWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void STFTWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void STFTWorkerThread::setSTFT(std::shared_ptr<const STFT> stft, std::shared_ptr<Spectrogram> spectrogram,
+                               std::atomic<size_t>* nextFrame)
+{
+    m_stft = stft;
+    m_spectrogram = spectrogram;
+    m_nextFrame = nextFrame;
+}
+
+void STFTWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void STFTWorkerThread::clearData()
+{
+    // The frames already written belong to the shared spectrogram, only drop our references
+    m_spectrogram.reset();
+}
+
+void STFTWorkerThread::run()
+{
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_stft || !m_spectrogram || m_nextFrame == nullptr)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    const size_t numFrames = m_spectrogram->numFrames();
+
+    // The batch size follows the checkpoint, so a batch takes a fraction of the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, 1);
+
+    // Exception handling, should never get inside catch.
+    try {
+        while (true)
+        {
+            const size_t batch = checkpoint.blockSize();
+            const size_t first = m_nextFrame->fetch_add(batch);
+            if (first >= numFrames)
+                break;
+
+            const size_t last = std::min(numFrames, first + batch);
+            if (!m_stft->transformFrames(data_short, N, first, last, *m_spectrogram) || checkpoint.reached())
+            {
+                clearData();
+                return;
+            }
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid spectrogram, aborting STFTWorkerThread::run()";
+        return;
+    }
+
+    emit stftFramesDone(m_workerID);
+}
@@ -0,0 +1,178 @@
+#include "SampleConverter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+SampleConverter::SampleConverter(const QAudioFormat& format)
+    : SampleConverter(FFTKernels::SampleEncoding::Int16, format.channelCount())
+{
+    if (format.sampleSize() > 8 && format.byteOrder() != QAudioFormat::LittleEndian)
+    {
+        throw std::invalid_argument("SampleConverter::SampleConverter() Big endian samples are not supported");
+    }
+
+    if (format.sampleType() == QAudioFormat::UnSignedInt && format.sampleSize() == 8)
+        m_encoding = FFTKernels::SampleEncoding::UInt8;
+    else if (format.sampleType() == QAudioFormat::SignedInt && format.sampleSize() == 8)
+        m_encoding = FFTKernels::SampleEncoding::Int8;
+    else if (format.sampleType() == QAudioFormat::SignedInt && format.sampleSize() == 16)
+        m_encoding = FFTKernels::SampleEncoding::Int16;
+    else if (format.sampleType() == QAudioFormat::SignedInt && format.sampleSize() == 32)
+        m_encoding = FFTKernels::SampleEncoding::Int32;
+    else if (format.sampleType() == QAudioFormat::Float && format.sampleSize() == 32)
+        m_encoding = FFTKernels::SampleEncoding::Float32;
+    else
+        throw std::invalid_argument("SampleConverter::SampleConverter() Unsupported sample format");
+
+    m_bytesPerSample = format.sampleSize() / 8;
+}
+
+SampleConverter::SampleConverter(FFTKernels::SampleEncoding encoding, int channelCount)
+    : m_encoding(encoding)
+    , m_channelCount(channelCount)
+    , m_bytesPerSample(0)
+    , m_blockFrames(0)
+{
+    if (channelCount < 1 || static_cast<size_t>(channelCount) > BLOCK_SAMPLES)
+    {
+        throw std::invalid_argument("SampleConverter::SampleConverter() Invalid channel count");
+    }
+
+    switch (encoding)
+    {
+    case FFTKernels::SampleEncoding::UInt8:
+    case FFTKernels::SampleEncoding::Int8:
+        m_bytesPerSample = 1;
+        break;
+    case FFTKernels::SampleEncoding::Int16:
+        m_bytesPerSample = 2;
+        break;
+    default:
+        m_bytesPerSample = 4;
+        break;
+    }
+
+    m_blockFrames = BLOCK_SAMPLES / channelCount;
+}
+
+FFTKernels::SampleEncoding SampleConverter::encoding() const
+{
+    return m_encoding;
+}
+
+int SampleConverter::channelCount() const
+{
+    return m_channelCount;
+}
+
+int SampleConverter::bytesPerFrame() const
+{
+    return m_bytesPerSample * m_channelCount;
+}
+
+size_t SampleConverter::numFrames(size_t bytes) const
+{
+    return bytes / bytesPerFrame();
+}
+
+bool SampleConverter::isNative() const
+{
+    return m_encoding == FFTKernels::SampleEncoding::Int16 && m_channelCount == 1;
+}
+
+void SampleConverter::convertBlock(const char* data, size_t numFrames, int channel, float* output) const
+{
+    if (m_channelCount == 1)
+    {
+        FFTKernels::decodeSamples(data, m_encoding, numFrames, output);
+        return;
+    }
+
+    alignas(64) float decoded[BLOCK_SAMPLES];
+    FFTKernels::decodeSamples(data, m_encoding, numFrames * m_channelCount, decoded);
+    FFTKernels::mixChannels(decoded, m_channelCount, numFrames, channel, output);
+}
+
+void SampleConverter::toFloat(const char* data, size_t numFrames, int channel, float* output) const
+{
+    for (size_t f = 0; f < numFrames; f += m_blockFrames)
+    {
+        const size_t count = std::min(m_blockFrames, numFrames - f);
+        convertBlock(data + f * bytesPerFrame(), count, channel, output + f);
+    }
+}
+
+void SampleConverter::toShort(const char* data, size_t numFrames, int channel, short* output) const
+{
+    if (isNative())
+    {
+        std::memcpy(output, data, numFrames * sizeof(short));
+        return;
+    }
+
+    alignas(64) float mixed[BLOCK_SAMPLES];
+    for (size_t f = 0; f < numFrames; f += m_blockFrames)
+    {
+        const size_t count = std::min(m_blockFrames, numFrames - f);
+        convertBlock(data + f * bytesPerFrame(), count, channel, mixed);
+        FFTKernels::floatToShort(mixed, count, output + f);
+    }
+}
+
+void SampleConverter::deinterleave(const char* data, size_t numFrames, short* const* outputs) const
+{
+    alignas(64) float decoded[BLOCK_SAMPLES];
+    alignas(64) float channel[BLOCK_SAMPLES];
+    for (size_t f = 0; f < numFrames; f += m_blockFrames)
+    {
+        const size_t count = std::min(m_blockFrames, numFrames - f);
+        FFTKernels::decodeSamples(data + f * bytesPerFrame(), m_encoding, count * m_channelCount, decoded);
+        for (int c = 0; c < m_channelCount; c++)
+        {
+            FFTKernels::mixChannels(decoded, m_channelCount, count, c, channel);
+            FFTKernels::floatToShort(channel, count, outputs[c] + f);
+        }
+    }
+}
+
+void SampleConverter::toMidSide(const char* data, size_t numFrames, short* mid, short* side) const
+{
+    if (m_channelCount != 2)
+    {
+        throw std::invalid_argument("SampleConverter::toMidSide() Mid/side needs a stereo input");
+    }
+
+    alignas(64) float decoded[BLOCK_SAMPLES];
+    alignas(64) float left[BLOCK_SAMPLES / 2];
+    alignas(64) float right[BLOCK_SAMPLES / 2];
+    for (size_t f = 0; f < numFrames; f += m_blockFrames)
+    {
+        const size_t count = std::min(m_blockFrames, numFrames - f);
+        FFTKernels::decodeSamples(data + f * bytesPerFrame(), m_encoding, count * 2, decoded);
+        FFTKernels::mixChannels(decoded, 2, count, 0, left);
+        FFTKernels::mixChannels(decoded, 2, count, 1, right);
+
+        // Simple enough for the compiler to vectorize, left and right become mid and side in place
+        for (size_t i = 0; i < count; i++)
+        {
+            const float l = left[i];
+            const float r = right[i];
+            left[i] = (l + r) * 0.5f;
+            right[i] = (l - r) * 0.5f;
+        }
+        FFTKernels::floatToShort(left, count, mid + f);
+        FFTKernels::floatToShort(right, count, side + f);
+    }
+}
+
+QAudioFormat SampleConverter::shortFormat(const QAudioFormat& format)
+{
+    QAudioFormat result = format;
+    result.setChannelCount(1);
+    result.setSampleSize(16);
+    result.setSampleType(QAudioFormat::SignedInt);
+    result.setByteOrder(QAudioFormat::LittleEndian);
+
+    return result;
+}
@@ -0,0 +1,78 @@
+#include "SampleRingBuffer.h"
+
+#include <algorithm>
+
+SampleRingBuffer::SampleRingBuffer(size_t capacity)
+    : m_writePosition(0)
+    , m_readPosition(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    m_samples.resize(size);
+    m_mask = size - 1;
+}
+
+size_t SampleRingBuffer::capacity() const
+{
+    return m_samples.size();
+}
+
+size_t SampleRingBuffer::available() const
+{
+    return m_writePosition.load(std::memory_order_acquire) - m_readPosition.load(std::memory_order_relaxed);
+}
+
+size_t SampleRingBuffer::write(const short* samples, size_t count)
+{
+    const size_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+    const size_t readPosition = m_readPosition.load(std::memory_order_acquire);
+    count = std::min(count, m_samples.size() - (writePosition - readPosition));
+
+    // At most two contiguous pieces, before and after the end of the storage
+    const size_t start = writePosition & m_mask;
+    const size_t first = std::min(count, m_samples.size() - start);
+    std::copy(samples, samples + first, m_samples.begin() + start);
+    std::copy(samples + first, samples + count, m_samples.begin());
+
+    // Publish the samples only once they are written
+    m_writePosition.store(writePosition + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRingBuffer::read(short* samples, size_t count)
+{
+    const size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+    const size_t writePosition = m_writePosition.load(std::memory_order_acquire);
+    count = std::min(count, writePosition - readPosition);
+
+    const size_t start = readPosition & m_mask;
+    const size_t first = std::min(count, m_samples.size() - start);
+    std::copy(m_samples.begin() + start, m_samples.begin() + start + first, samples);
+    std::copy(m_samples.begin(), m_samples.begin() + (count - first), samples + first);
+
+    // Hand the space back to the producer only once the samples are copied
+    m_readPosition.store(readPosition + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRingBuffer::discard(size_t keep)
+{
+    const size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+    const size_t writePosition = m_writePosition.load(std::memory_order_acquire);
+    const size_t count = writePosition - readPosition;
+    if (count <= keep)
+        return 0;
+
+    m_readPosition.store(readPosition + (count - keep), std::memory_order_release);
+    return count - keep;
+}
+
+void SampleRingBuffer::clear()
+{
+    m_writePosition.store(0);
+    m_readPosition.store(0);
+}
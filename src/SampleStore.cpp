@@ -0,0 +1,279 @@
+#include "SampleStore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstring>
+
+SampleStore::SampleStore()
+    : m_size(0)
+    , m_reserved(0)
+    , m_sealed(false)
+    , m_memoryBudget(0)
+    , m_memoryBytes(0)
+    , m_numSpilled(0)
+    , m_spilledBytes(0)
+    , m_external(nullptr)
+{
+
+}
+
+SampleStore::~SampleStore()
+{
+    // The mapped chunks go before the file they map
+    m_chunks.clear();
+    m_spillFile.reset();
+}
+
+std::shared_ptr<SampleStore> SampleStore::wrap(const char* data, size_t size, std::shared_ptr<const void> owner)
+{
+    std::shared_ptr<SampleStore> store = std::make_shared<SampleStore>();
+    store->m_external = data;
+    store->m_owner = std::move(owner);
+    store->m_size = size;
+    store->m_sealed = true;
+
+    return store;
+}
+
+void SampleStore::setMemoryBudget(size_t bytes)
+{
+    if (m_size == 0 && m_chunks.empty())
+    {
+        m_memoryBudget = bytes;
+    }
+}
+
+size_t SampleStore::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void SampleStore::reserve(size_t bytes)
+{
+    if (m_size == 0 && m_chunks.empty() && (m_memoryBudget == 0 || bytes <= m_memoryBudget))
+    {
+        m_reserved = bytes;
+    }
+}
+
+void SampleStore::append(const char* data, size_t length)
+{
+    if (m_sealed)
+        return;
+
+    while (length > 0)
+    {
+        if (m_chunks.empty() || m_chunks.back().size == m_chunks.back().capacity)
+        {
+            // The previous chunk is full, it can go to the temporary file if over budget
+            spillOverBudget();
+
+            // The first chunk takes the reserved size, the next ones CHUNK_BYTES
+            size_t minCapacity = CHUNK_BYTES;
+            if (m_chunks.empty())
+                minCapacity = m_reserved;
+
+            Chunk chunk;
+            chunk.capacity = std::max(minCapacity, length);
+            chunk.heap.reset(new char[chunk.capacity]);
+            chunk.data = chunk.heap.get();
+            chunk.size = 0;
+            m_chunks.push_back(std::move(chunk));
+            m_memoryBytes += m_chunks.back().capacity;
+        }
+
+        Chunk& last = m_chunks.back();
+        const size_t count = std::min(length, last.capacity - last.size);
+        std::memcpy(last.heap.get() + last.size, data, count);
+        last.size += count;
+        m_size += count;
+        data += count;
+        length -= count;
+    }
+}
+
+void SampleStore::spillOverBudget()
+{
+    if (m_memoryBudget == 0)
+        return;
+
+    // Only called when the last chunk is full, so any chunk can go. Room is left for the next one.
+    while (m_memoryBytes + CHUNK_BYTES > m_memoryBudget && m_numSpilled < m_chunks.size())
+    {
+        if (!writeChunk(m_numSpilled))
+            return;
+
+        Chunk& chunk = m_chunks[m_numSpilled];
+        uchar* mapped = m_spillFile->map(static_cast<qint64>(m_spilledBytes), static_cast<qint64>(chunk.size));
+        m_spilledBytes += chunk.size;
+        m_numSpilled++;
+        if (mapped == nullptr)
+        {
+            // Written but kept on the heap, it is joined with the file at seal()
+            qDebug() << "SampleStore::spillOverBudget() ERROR: Failed to map the temporary file: " << m_spillFile->errorString();
+            m_memoryBudget = 0;
+            return;
+        }
+
+        m_memoryBytes -= chunk.capacity;
+        chunk.data = reinterpret_cast<const char*>(mapped);
+        chunk.heap.reset();
+    }
+}
+
+bool SampleStore::writeChunk(size_t c)
+{
+    if (!m_spillFile)
+    {
+        m_spillFile.reset(new QTemporaryFile(QDir::tempPath() + "/SpectrographSamples-XXXXXX"));
+        if (!m_spillFile->open())
+        {
+            qDebug() << "SampleStore::writeChunk() ERROR: Failed to create a temporary file: " << m_spillFile->errorString();
+            m_spillFile.reset();
+            m_memoryBudget = 0;
+            return false;
+        }
+    }
+
+    // Chunks are written in order, the file holds the samples [0, m_spilledBytes)
+    const Chunk& chunk = m_chunks[c];
+    if (!m_spillFile->seek(static_cast<qint64>(m_spilledBytes))
+        || m_spillFile->write(chunk.data, static_cast<qint64>(chunk.size)) != static_cast<qint64>(chunk.size)
+        || !m_spillFile->flush())
+    {
+        qDebug() << "SampleStore::writeChunk() ERROR: Failed to write the temporary file: " << m_spillFile->errorString();
+        m_memoryBudget = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void SampleStore::seal()
+{
+    if (m_sealed)
+        return;
+
+    m_sealed = true;
+    if (m_chunks.size() <= 1)
+        return;
+
+    // With a budget too small for a second copy, the chunks are joined in the temporary file
+    if (m_spillFile || (m_memoryBudget > 0 && m_memoryBytes + m_size > m_memoryBudget))
+    {
+        if (joinInFile())
+            return;
+    }
+
+    // The reserved size was short, the chunks are joined once so the transforms see one block
+    Chunk joined;
+    joined.capacity = m_size;
+    joined.heap.reset(new char[m_size]);
+    joined.data = joined.heap.get();
+    joined.size = 0;
+    for (size_t c = 0; c < m_chunks.size(); c++)
+    {
+        std::memcpy(joined.heap.get() + joined.size, m_chunks[c].data, m_chunks[c].size);
+        joined.size += m_chunks[c].size;
+    }
+
+    m_chunks.clear();
+    m_chunks.push_back(std::move(joined));
+    m_memoryBytes = m_size;
+}
+
+bool SampleStore::joinInFile()
+{
+    // The file already holds the spilled chunks, the others are added after them
+    for (size_t c = m_numSpilled; c < m_chunks.size(); c++)
+    {
+        if (!writeChunk(c))
+            return false;
+        m_spilledBytes += m_chunks[c].size;
+        m_numSpilled++;
+    }
+
+    uchar* mapped = m_spillFile->map(0, static_cast<qint64>(m_size));
+    if (mapped == nullptr)
+    {
+        qDebug() << "SampleStore::joinInFile() ERROR: Failed to map the temporary file: " << m_spillFile->errorString();
+        return false;
+    }
+
+    for (size_t c = 0; c < m_chunks.size(); c++)
+    {
+        if (!m_chunks[c].heap)
+            m_spillFile->unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_chunks[c].data)));
+    }
+
+    Chunk joined;
+    joined.data = reinterpret_cast<const char*>(mapped);
+    joined.capacity = m_size;
+    joined.size = m_size;
+
+    m_chunks.clear();
+    m_chunks.push_back(std::move(joined));
+    m_memoryBytes = 0;
+
+    return true;
+}
+
+bool SampleStore::isSealed() const
+{
+    return m_sealed;
+}
+
+size_t SampleStore::size() const
+{
+    return m_size;
+}
+
+size_t SampleStore::memoryBytes() const
+{
+    return m_memoryBytes;
+}
+
+size_t SampleStore::read(size_t offset, char* destination, size_t length) const
+{
+    if (offset >= m_size)
+        return 0;
+
+    length = std::min(length, m_size - offset);
+    if (m_external != nullptr)
+    {
+        std::memcpy(destination, m_external + offset, length);
+        return length;
+    }
+
+    size_t copied = 0;
+    for (size_t c = 0; c < m_chunks.size() && copied < length; c++)
+    {
+        const Chunk& chunk = m_chunks[c];
+        if (offset >= chunk.size)
+        {
+            offset -= chunk.size;
+            continue;
+        }
+
+        const size_t count = std::min(length - copied, chunk.size - offset);
+        std::memcpy(destination + copied, chunk.data + offset, count);
+        copied += count;
+        offset = 0;
+    }
+
+    return copied;
+}
+
+const char* SampleStore::data() const
+{
+    if (m_external != nullptr)
+        return m_external;
+
+    if (!m_sealed || m_chunks.empty())
+        return nullptr;
+
+    return m_chunks.front().data;
+}
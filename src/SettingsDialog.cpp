@@ -1,5 +1,6 @@
 #include "SettingsDialog.h"
 #include "SpectrographUI.h"
+#include "Constants.h"
 #include <QCheckBox>
 #include <QComboBox>
 #include <QDialogButtonBox>
@@ -14,6 +15,13 @@ SettingsDialog::SettingsDialog(const QList<QAudioDeviceInfo>& availableOutputDev
                                QWidget* parent)
     : QDialog(parent)
     , m_outputDeviceComboBox(new QComboBox(this))
+    , m_transformComboBox(new QComboBox(this))
+    , m_liveSpectrumCheckBox(new QCheckBox(tr("Live spectrum of the playback"), this))
+    , m_decimationCheckBox(new QCheckBox(tr("Decimate to the displayed band before the transform"), this))
+    , m_streamingCheckBox(new QCheckBox(tr("Analyze while decoding (for files larger than the memory)"), this))
+    , m_memoryBudgetSpinBox(new QSpinBox(this))
+    , m_channelViewComboBox(new QComboBox(this))
+    , m_midSideCheckBox(new QCheckBox(tr("Mid and side instead of left and right (stereo)"), this))
 {
     QVBoxLayout* dialogLayout = new QVBoxLayout(this);
 
@@ -34,6 +42,49 @@ SettingsDialog::SettingsDialog(const QList<QAudioDeviceInfo>& availableOutputDev
     dialogLayout->addLayout(outputDeviceLayout.data());
     outputDeviceLayout.take(); // ownership transferred to dialogLayout
 
+    // The constant-Q spectrum is shown on a logarithmic frequency axis, the spectrogram as a heat map
+    m_transformComboBox->addItem(tr("Spectrum (FFT)"));
+    m_transformComboBox->addItem(tr("Constant-Q spectrum (logarithmic)"));
+    m_transformComboBox->addItem(tr("Spectrogram (STFT)"));
+
+    QScopedPointer<QHBoxLayout> transformLayout(new QHBoxLayout);
+    QLabel* transformLabel = new QLabel(tr("Transform"), this);
+    transformLayout->addWidget(transformLabel);
+    transformLayout->addWidget(m_transformComboBox);
+    dialogLayout->addLayout(transformLayout.data());
+    transformLayout.take(); // ownership transferred to dialogLayout
+
+    dialogLayout->addWidget(m_liveSpectrumCheckBox);
+    dialogLayout->addWidget(m_decimationCheckBox);
+    dialogLayout->addWidget(m_streamingCheckBox);
+
+    // Decoded samples beyond the budget are spilled to a temporary file
+    m_memoryBudgetSpinBox->setRange(0, 1024 * 1024);
+    m_memoryBudgetSpinBox->setSingleStep(128);
+    m_memoryBudgetSpinBox->setSuffix(tr(" MB"));
+    m_memoryBudgetSpinBox->setSpecialValueText(tr("No limit"));
+    m_memoryBudgetSpinBox->setValue(Constants::SAMPLE_MEMORY_BUDGET_MB);
+
+    QScopedPointer<QHBoxLayout> memoryBudgetLayout(new QHBoxLayout);
+    QLabel* memoryBudgetLabel = new QLabel(tr("Memory for decoded samples"), this);
+    memoryBudgetLayout->addWidget(memoryBudgetLabel);
+    memoryBudgetLayout->addWidget(m_memoryBudgetSpinBox);
+    dialogLayout->addLayout(memoryBudgetLayout.data());
+    memoryBudgetLayout.take(); // ownership transferred to dialogLayout
+
+    // Files with several channels can be analyzed per channel
+    m_channelViewComboBox->addItem(tr("Mixed to mono"));
+    m_channelViewComboBox->addItem(tr("Per channel, overlaid"));
+    m_channelViewComboBox->addItem(tr("Per channel, stacked"));
+
+    QScopedPointer<QHBoxLayout> channelViewLayout(new QHBoxLayout);
+    QLabel* channelViewLabel = new QLabel(tr("Channels"), this);
+    channelViewLayout->addWidget(channelViewLabel);
+    channelViewLayout->addWidget(m_channelViewComboBox);
+    dialogLayout->addLayout(channelViewLayout.data());
+    channelViewLayout.take(); // ownership transferred to dialogLayout
+    dialogLayout->addWidget(m_midSideCheckBox);
+
     // Connect
     connect(m_outputDeviceComboBox, QOverload<int>::of(&QComboBox::activated),
         this, &SettingsDialog::outputDeviceChanged);
@@ -57,6 +108,76 @@ SettingsDialog::~SettingsDialog()
 
 }
 
+bool SettingsDialog::liveSpectrum() const
+{
+    return m_liveSpectrumCheckBox->isChecked();
+}
+
+void SettingsDialog::setLiveSpectrum(bool live)
+{
+    m_liveSpectrumCheckBox->setChecked(live);
+}
+
+bool SettingsDialog::decimation() const
+{
+    return m_decimationCheckBox->isChecked();
+}
+
+void SettingsDialog::setDecimation(bool decimation)
+{
+    m_decimationCheckBox->setChecked(decimation);
+}
+
+bool SettingsDialog::streaming() const
+{
+    return m_streamingCheckBox->isChecked();
+}
+
+void SettingsDialog::setStreaming(bool streaming)
+{
+    m_streamingCheckBox->setChecked(streaming);
+}
+
+int SettingsDialog::memoryBudget() const
+{
+    return m_memoryBudgetSpinBox->value();
+}
+
+void SettingsDialog::setMemoryBudget(int megabytes)
+{
+    m_memoryBudgetSpinBox->setValue(megabytes);
+}
+
+int SettingsDialog::transform() const
+{
+    return m_transformComboBox->currentIndex();
+}
+
+void SettingsDialog::setTransform(int transform)
+{
+    m_transformComboBox->setCurrentIndex(transform);
+}
+
+int SettingsDialog::channelView() const
+{
+    return m_channelViewComboBox->currentIndex();
+}
+
+void SettingsDialog::setChannelView(int view)
+{
+    m_channelViewComboBox->setCurrentIndex(view);
+}
+
+bool SettingsDialog::midSide() const
+{
+    return m_midSideCheckBox->isChecked();
+}
+
+void SettingsDialog::setMidSide(bool midSide)
+{
+    m_midSideCheckBox->setChecked(midSide);
+}
+
 void SettingsDialog::outputDeviceChanged(int index)
 {
     m_outputDevice = m_outputDeviceComboBox->itemData(index).value<QAudioDeviceInfo>();
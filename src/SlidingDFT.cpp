@@ -0,0 +1,188 @@
+#define _USE_MATH_DEFINES
+
+#include "SlidingDFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+SlidingDFT::SlidingDFT(double sampleRate, size_t windowSize, double minFrequency, double maxFrequency,
+                       size_t resetInterval)
+    : m_sampleRate(sampleRate)
+    , m_windowSize(windowSize)
+    , m_resetInterval(resetInterval > 0 ? resetInterval : RESET_WINDOWS * windowSize)
+    , m_history(windowSize, 0)
+    , m_position(0)
+    , m_samplesSinceReset(0)
+{
+    if (sampleRate <= 0.0 || windowSize < 4 || minFrequency > maxFrequency)
+    {
+        throw std::invalid_argument("SlidingDFT::SlidingDFT() Invalid window size or band");
+    }
+
+    // The band, plus one bin on each side for the window, must stay between DC and Nyquist
+    const double binWidth = sampleRate / windowSize;
+    const size_t first = static_cast<size_t>(std::max(1.0, std::ceil(minFrequency / binWidth)));
+    const size_t last = static_cast<size_t>(std::min(windowSize / 2.0 - 1.0, std::floor(maxFrequency / binWidth)));
+    if (last < first)
+    {
+        throw std::invalid_argument("SlidingDFT::SlidingDFT() No bin in the band");
+    }
+    m_firstBin = first - 1;
+    m_numBins = last - first + 1;
+
+    m_cos.resize(windowSize);
+    m_sin.resize(windowSize);
+    for (size_t q = 0; q < windowSize; q++)
+    {
+        m_cos[q] = std::cos(2 * M_PI * q / windowSize);
+        m_sin[q] = std::sin(2 * M_PI * q / windowSize);
+    }
+
+    m_real.assign(m_numBins + 2, 0.0);
+    m_imag.assign(m_numBins + 2, 0.0);
+}
+
+double SlidingDFT::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t SlidingDFT::windowSize() const
+{
+    return m_windowSize;
+}
+
+size_t SlidingDFT::resetInterval() const
+{
+    return m_resetInterval;
+}
+
+size_t SlidingDFT::numBins() const
+{
+    return m_numBins;
+}
+
+double SlidingDFT::frequency(size_t i) const
+{
+    return (m_firstBin + 1 + i) * m_sampleRate / m_windowSize;
+}
+
+void SlidingDFT::update(const short* samples, size_t count)
+{
+    const size_t N = m_windowSize;
+
+    // A whole window of new samples replaces every sum, recomputing is as cheap as sliding
+    if (count >= N)
+    {
+        const size_t skip = count - N;
+        m_position = (m_position + skip) % N;
+        for (size_t i = 0; i < N; i++)
+        {
+            m_history[(m_position + i) % N] = samples[skip + i];
+        }
+        reset();
+        return;
+    }
+
+    while (count > 0)
+    {
+        // Blocks that do not wrap around the history, so the twiddle index grows linearly
+        const size_t blockSize = std::min(count, N - m_position);
+        m_differences.resize(blockSize);
+        for (size_t s = 0; s < blockSize; s++)
+        {
+            m_differences[s] = static_cast<double>(samples[s]) - m_history[m_position + s];
+            m_history[m_position + s] = samples[s];
+        }
+
+        for (size_t i = 0; i < m_real.size(); i++)
+        {
+            const size_t k = m_firstBin + i;
+            size_t q = (k * m_position) % N;
+            double real = m_real[i];
+            double imag = m_imag[i];
+            for (size_t s = 0; s < blockSize; s++)
+            {
+                real += m_differences[s] * m_cos[q];
+                imag -= m_differences[s] * m_sin[q];
+                q += k;
+                if (q >= N)
+                    q -= N;
+            }
+            m_real[i] = real;
+            m_imag[i] = imag;
+        }
+
+        m_position = (m_position + blockSize) % N;
+        m_samplesSinceReset += blockSize;
+        samples += blockSize;
+        count -= blockSize;
+    }
+
+    if (m_samplesSinceReset >= m_resetInterval)
+    {
+        reset();
+    }
+}
+
+void SlidingDFT::reset()
+{
+    const size_t N = m_windowSize;
+
+    // Sample n sits at n mod N in the history and its twiddle only depends on n mod N
+    for (size_t i = 0; i < m_real.size(); i++)
+    {
+        const size_t k = m_firstBin + i;
+        size_t q = 0;
+        double real = 0.0;
+        double imag = 0.0;
+        for (size_t p = 0; p < N; p++)
+        {
+            real += m_history[p] * m_cos[q];
+            imag -= m_history[p] * m_sin[q];
+            q += k;
+            if (q >= N)
+                q -= N;
+        }
+        m_real[i] = real;
+        m_imag[i] = imag;
+    }
+
+    m_samplesSinceReset = 0;
+}
+
+void SlidingDFT::clear()
+{
+    std::fill(m_history.begin(), m_history.end(), 0);
+    std::fill(m_real.begin(), m_real.end(), 0.0);
+    std::fill(m_imag.begin(), m_imag.end(), 0.0);
+    m_position = 0;
+    m_samplesSinceReset = 0;
+}
+
+void SlidingDFT::magnitudes(double* amplitudes) const
+{
+    const size_t N = m_windowSize;
+    const size_t count = m_real.size();
+
+    // The window starts at the oldest sample, at m_position in the history:
+    // X[k] = A[k] * exp(2*pi*i*k*m_position/N)
+    std::vector<double> real(count);
+    std::vector<double> imag(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t q = ((m_firstBin + i) * m_position) % N;
+        real[i] = m_real[i] * m_cos[q] - m_imag[i] * m_sin[q];
+        imag[i] = m_real[i] * m_sin[q] + m_imag[i] * m_cos[q];
+    }
+
+    // Hann window: X[k] / 2 - (X[k - 1] + X[k + 1]) / 4, its sum being N / 2
+    const double scale = 2.0 / (32767.0 * N / 2.0);
+    for (size_t i = 0; i < m_numBins; i++)
+    {
+        const double windowedReal = 0.5 * real[i + 1] - 0.25 * (real[i] + real[i + 2]);
+        const double windowedImag = 0.5 * imag[i + 1] - 0.25 * (imag[i] + imag[i + 2]);
+        amplitudes[i] = std::sqrt(windowedReal * windowedReal + windowedImag * windowedImag) * scale;
+    }
+}
@@ -1,5 +1,31 @@
 #include "Spectrograph.h"
 
+#include <QtGui/QBrush>
+#include <QtGui/QTransform>
+
+#include <algorithm>
+#include <cmath>
+
+// Columns of the spectrogram image, the frames of longer files are grouped
+static const int SPECTROGRAM_MAX_COLUMNS = 2048;
+
+// Magnitudes more than this below the loudest one are drawn black
+static const double SPECTROGRAM_DYNAMIC_RANGE_DB = 80.0;
+
+// Black, blue, red, yellow and white for a level from 0 to 1
+static QRgb heatColor(double level)
+{
+    static const int NUM_STOPS = 5;
+    static const int STOPS[NUM_STOPS][3] = { {0, 0, 0}, {40, 0, 160}, {220, 30, 40}, {255, 210, 0}, {255, 255, 255} };
+
+    const double position = std::min(std::max(level, 0.0), 1.0) * (NUM_STOPS - 1);
+    const int i = std::min(static_cast<int>(position), NUM_STOPS - 2);
+    const double t = position - i;
+    return qRgb(static_cast<int>(STOPS[i][0] + t * (STOPS[i + 1][0] - STOPS[i][0])),
+                static_cast<int>(STOPS[i][1] + t * (STOPS[i + 1][1] - STOPS[i][1])),
+                static_cast<int>(STOPS[i][2] + t * (STOPS[i + 1][2] - STOPS[i][2])));
+}
+
 Spectrograph::Spectrograph(QString title, QObject* parent) 
 	: QObject(parent)
 	, m_spectrumChart(new QChart)
@@ -7,7 +33,15 @@ Spectrograph::Spectrograph(QString title, QObject* parent)
     , m_spectrumChartView(new QChartView(m_spectrumChart))
     , m_axisX(new QValueAxis)
     , m_axisY(new QValueAxis)
+    , m_logAxisX(new QLogValueAxis)
     , m_FTController(new FTController)
+    , m_streaming(false)
+    , m_live(false)
+    , m_transform(Transform::FFT)
+    , m_title(title)
+    , m_livePlotting(false)
+    , m_channelView(ChannelView::Mixed)
+    , m_midSide(false)
 {
     m_spectrumChartView->resize(800, 600);
     m_spectrumChartView->setMinimumSize(380, 300);
@@ -22,10 +56,19 @@ Spectrograph::Spectrograph(QString title, QObject* parent)
     m_spectrumSeries->attachAxis(m_axisX);
     m_spectrumChart->addAxis(m_axisY, Qt::AlignLeft);
     m_spectrumSeries->attachAxis(m_axisY);
+    m_logAxisX->setBase(2.0);
+    m_logAxisX->setRange(Constants::MIN_FREQUENCY, Constants::MAX_FREQUENCY);
+    m_logAxisX->setLabelFormat("%g");
+    m_logAxisX->setTitleText("Frequency (Hz)");
+    m_logAxisX->setMinorTickCount(3);
     m_spectrumChart->legend()->hide();
     m_spectrumChart->setTitle(title);
 
     connect(m_FTController, &FTController::spectrumDataReady, this, &Spectrograph::plotSpectrumData);
+    connect(m_FTController, &FTController::liveSpectrumReady, this, &Spectrograph::plotLiveSpectrum);
+    connect(m_FTController, &FTController::channelSpectraReady, this, &Spectrograph::plotChannelSpectra);
+    connect(m_FTController, &FTController::spectrogramReady, this, &Spectrograph::plotSpectrogram);
+    connect(m_spectrumChart, &QChart::plotAreaChanged, this, &Spectrograph::updateSpectrogramBackground);
 }
 
 QChartView* Spectrograph::getChartView()
@@ -53,11 +96,51 @@ QValueAxis* Spectrograph::getAxisY()
     return m_axisY;
 }
 
+QLogValueAxis* Spectrograph::getLogAxisX()
+{
+    return m_logAxisX;
+}
+
+void Spectrograph::setLogFrequencyAxis(bool log)
+{
+    QAbstractAxis* current = log ? static_cast<QAbstractAxis*>(m_axisX) : m_logAxisX;
+    QAbstractAxis* next = log ? static_cast<QAbstractAxis*>(m_logAxisX) : m_axisX;
+    if (!m_spectrumChart->axes(Qt::Horizontal).contains(current))
+        return;
+
+    // The chart owns its axes, take the current one back before swapping
+    m_spectrumSeries->detachAxis(current);
+    for (int c = 0; c < m_channelSeries.size(); ++c)
+    {
+        m_channelSeries[c]->detachAxis(current);
+    }
+    m_spectrumChart->removeAxis(current);
+    m_spectrumChart->addAxis(next, Qt::AlignBottom);
+    m_spectrumSeries->attachAxis(next);
+    for (int c = 0; c < m_channelSeries.size(); ++c)
+    {
+        m_channelSeries[c]->attachAxis(next);
+    }
+}
+
+QAbstractAxis* Spectrograph::frequencyAxis()
+{
+    if (m_spectrumChart->axes(Qt::Horizontal).contains(m_logAxisX))
+        return m_logAxisX;
+
+    return m_axisX;
+}
+
 QBuffer* Spectrograph::getDataBuffer()
 {
     return m_FTController->getDataBuffer();
 }
 
+void Spectrograph::setSampleStore(std::shared_ptr<const SampleStore> store, const QAudioFormat format)
+{
+    m_FTController->setSampleStore(store, format);
+}
+
 void Spectrograph::cancelCalculation()
 {
     // Reset the audio data buffer
@@ -66,20 +149,314 @@ void Spectrograph::cancelCalculation()
 
 void Spectrograph::calculateSpectrum(const QAudioFormat format)
 {
-    // Uncomment one of the lines to test parallel/sequential DFT/FFT
-    //m_FTController->startDFTInAThread(format);
-    //m_FTController->startDistributedDFT(format);
-    //m_FTController->startFFTInAThread(format);
+    if (m_transform == Transform::ConstantQ)
+    {
+        m_FTController->startConstantQ(format);
+        return;
+    }
+
+    if (m_transform == Transform::Spectrogram)
+    {
+        m_FTController->startSTFT(format);
+        return;
+    }
+
+    // Files with several channels can be analyzed per channel, the channels sharing the workers
+    if (m_channelView != ChannelView::Mixed && format.channelCount() > 1)
+    {
+        const bool midSide = m_midSide && format.channelCount() == 2;
+        m_FTController->startChannelSpectra(format, midSide ? FTController::ChannelMode::MidSide : FTController::ChannelMode::Channels);
+        return;
+    }
+
     m_FTController->startDistributedFFT(format);
 }
 
+Spectrograph::Transform Spectrograph::transform()
+{
+    return m_transform;
+}
+
+void Spectrograph::setTransform(Transform transform)
+{
+    m_transform = transform;
+    if (m_transform != Transform::Spectrogram)
+    {
+        hideSpectrogram();
+    }
+    setLogFrequencyAxis(m_transform == Transform::ConstantQ);
+}
+
+Spectrograph::ChannelView Spectrograph::channelView()
+{
+    return m_channelView;
+}
+
+void Spectrograph::setChannelView(ChannelView view)
+{
+    m_channelView = view;
+}
+
+bool Spectrograph::isMidSide()
+{
+    return m_midSide;
+}
+
+void Spectrograph::setMidSide(bool midSide)
+{
+    m_midSide = midSide;
+}
+
+bool Spectrograph::isDecimation()
+{
+    return m_FTController->isDecimation();
+}
+
+void Spectrograph::setDecimation(bool decimation)
+{
+    m_FTController->setDecimation(decimation);
+}
+
+bool Spectrograph::isStreaming()
+{
+    return m_streaming;
+}
+
+void Spectrograph::setStreaming(bool streaming)
+{
+    m_streaming = streaming;
+}
+
+void Spectrograph::startStreamingSpectrum(const QAudioFormat format)
+{
+    m_FTController->startStream(format);
+}
+
+void Spectrograph::appendSpectrumData(const char* data, const qint64 length)
+{
+    m_FTController->appendStreamData(data, length);
+}
+
+void Spectrograph::finishStreamingSpectrum()
+{
+    m_FTController->finishStream();
+}
+
+bool Spectrograph::isLiveSpectrum()
+{
+    return m_live;
+}
+
+void Spectrograph::setLiveSpectrum(bool live)
+{
+    m_live = live;
+    if (!m_live)
+    {
+        stopLiveSpectrum();
+    }
+}
+
+void Spectrograph::startLiveSpectrum(const QAudioFormat format)
+{
+    showSpectrumSeries();
+    m_livePlotting = true;
+
+    // The band is fixed, so updating its bins with every sample is cheaper than an FFT per frame
+    m_FTController->startLiveSpectrum(format, Constants::LIVE_SPECTRUM_FRAME_SIZE, FTController::LiveMethod::SlidingDFT);
+}
+
+void Spectrograph::stopLiveSpectrum()
+{
+    m_FTController->stopLiveSpectrum();
+
+    // Frames still queued by the worker are dropped
+    m_livePlotting = false;
+    m_spectrumChart->setTitle(m_title);
+}
+
+void Spectrograph::pushPlaybackData(const char* data, const qint64 length, const double outputDelaySeconds)
+{
+    m_FTController->pushPlaybackData(data, length, outputDelaySeconds);
+}
+
 void Spectrograph::plotSpectrumData(const QVector<QPointF> points, const double elapsedSeconds)
 {
     Q_UNUSED(elapsedSeconds);
 
     qDebug() << "Spectrograph::plotSpectrumData() plotting " << points.size() << " points";
 
+    showSpectrumSeries();
+
     // Waiting to replace all the points on the graph at once is more efficient than constantly
     // appending the data points as it's being computed.
     m_spectrumSeries->replace(points);
 }
+
+void Spectrograph::plotLiveSpectrum(const QVector<QPointF> points, const double latencySeconds)
+{
+    if (!m_livePlotting)
+        return;
+
+    m_spectrumSeries->replace(points);
+    m_spectrumChart->setTitle(QString("%1 (live, latency %2 ms)").arg(m_title).arg(qRound(latencySeconds * 1000.0)));
+}
+
+void Spectrograph::plotChannelSpectra(const QVector<QVector<QPointF>> spectra, const QStringList names, const double elapsedSeconds)
+{
+    Q_UNUSED(elapsedSeconds);
+
+    qDebug() << "Spectrograph::plotChannelSpectra() plotting " << spectra.size() << " channels";
+
+    hideSpectrogram();
+
+    while (m_channelSeries.size() < spectra.size())
+    {
+        QLineSeries* series = new QLineSeries;
+        m_spectrumChart->addSeries(series);
+        series->attachAxis(frequencyAxis());
+        series->attachAxis(m_axisY);
+        m_channelSeries.append(series);
+    }
+
+    // Stacked, each channel gets a row of height 1, the first one at the top
+    const bool stacked = m_channelView == ChannelView::Stacked;
+    const int numChannels = spectra.size();
+    m_axisY->setRange(0, stacked ? numChannels : 1);
+
+    m_spectrumSeries->setVisible(false);
+    for (int c = 0; c < m_channelSeries.size(); ++c)
+    {
+        QLineSeries* series = m_channelSeries[c];
+        if (c >= numChannels)
+        {
+            series->setVisible(false);
+            continue;
+        }
+
+        QVector<QPointF> points = spectra[c];
+        if (stacked)
+        {
+            // A small gap keeps the peaks of a row off the baseline of the next one
+            const double offset = numChannels - 1 - c;
+            for (int i = 0; i < points.size(); ++i)
+            {
+                points[i].setY(offset + 0.9 * points[i].y());
+            }
+        }
+
+        series->setName(c < names.size() ? names[c] : QString());
+        series->replace(points);
+        series->setVisible(true);
+    }
+    m_spectrumChart->legend()->show();
+}
+
+void Spectrograph::plotSpectrogram(const std::shared_ptr<const Spectrogram> spectrogram, const double elapsedSeconds)
+{
+    Q_UNUSED(elapsedSeconds);
+
+    if (!spectrogram || spectrogram->numFrames() == 0 || spectrogram->numBins() == 0)
+        return;
+
+    qDebug() << "Spectrograph::plotSpectrogram() plotting " << spectrogram->numFrames() << " frames";
+
+    // Rows are the bins of the displayed band, the highest frequency at the top
+    const size_t numFrames = spectrogram->numFrames();
+    const size_t lastBinOfSpectrum = spectrogram->numBins() - 1;
+    const double binWidth = spectrogram->sampleRate() / spectrogram->frameSize();
+    const size_t firstBin = std::min(lastBinOfSpectrum, static_cast<size_t>(std::ceil(Constants::MIN_FREQUENCY / binWidth)));
+    const size_t lastBin = std::max(firstBin, std::min(lastBinOfSpectrum, static_cast<size_t>(std::floor(Constants::MAX_FREQUENCY / binWidth))));
+    const int height = static_cast<int>(lastBin - firstBin + 1);
+    const int width = static_cast<int>(std::min(numFrames, static_cast<size_t>(SPECTROGRAM_MAX_COLUMNS)));
+
+    // Each column shows the loudest of its frames, so short events stay visible once grouped
+    std::vector<float> columns(static_cast<size_t>(width) * height, 0.0f);
+    float maxMagnitude = 0.0f;
+    for (int c = 0; c < width; ++c)
+    {
+        float* column = columns.data() + static_cast<size_t>(c) * height;
+        const size_t frameEnd = (c + 1) * numFrames / width;
+        for (size_t f = c * numFrames / width; f < frameEnd; ++f)
+        {
+            const float* magnitudes = spectrogram->frame(f) + firstBin;
+            for (int k = 0; k < height; ++k)
+            {
+                column[k] = std::max(column[k], magnitudes[k]);
+            }
+        }
+
+        for (int k = 0; k < height; ++k)
+        {
+            maxMagnitude = std::max(maxMagnitude, column[k]);
+        }
+    }
+
+    // Decibels below the loudest magnitude, mapped to the colors
+    const double maxDecibels = maxMagnitude > 0.0f ? 20.0 * std::log10(maxMagnitude) : 0.0;
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        const int k = height - 1 - y;
+        for (int c = 0; c < width; ++c)
+        {
+            const float magnitude = columns[static_cast<size_t>(c) * height + k];
+            const double decibels = magnitude > 0.0f ? 20.0 * std::log10(magnitude) : maxDecibels - SPECTROGRAM_DYNAMIC_RANGE_DB;
+            line[c] = heatColor(1.0 + (decibels - maxDecibels) / SPECTROGRAM_DYNAMIC_RANGE_DB);
+        }
+    }
+
+    // The series give way to the image, drawn behind time and frequency axes
+    for (int c = 0; c < m_channelSeries.size(); ++c)
+    {
+        m_channelSeries[c]->setVisible(false);
+    }
+    m_spectrumSeries->setVisible(false);
+    m_spectrumChart->legend()->hide();
+    m_axisX->setRange(0.0, spectrogram->time(numFrames - 1) + spectrogram->hopSize() / spectrogram->sampleRate());
+    m_axisX->setTitleText("Time (s)");
+    m_axisY->setRange(spectrogram->frequency(firstBin), spectrogram->frequency(lastBin));
+    m_axisY->setTitleText("Frequency (Hz)");
+
+    m_spectrogramImage = image;
+    updateSpectrogramBackground(m_spectrumChart->plotArea());
+}
+
+void Spectrograph::updateSpectrogramBackground(const QRectF& plotArea)
+{
+    if (m_spectrogramImage.isNull())
+        return;
+
+    QBrush brush(m_spectrogramImage.scaled(plotArea.size().toSize(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+
+    // Textures are tiled from the origin of the scene, start this one at the corner of the plot area
+    brush.setTransform(QTransform::fromTranslate(plotArea.left(), plotArea.top()));
+    m_spectrumChart->setPlotAreaBackgroundBrush(brush);
+    m_spectrumChart->setPlotAreaBackgroundVisible(true);
+}
+
+void Spectrograph::hideSpectrogram()
+{
+    if (m_spectrogramImage.isNull())
+        return;
+
+    m_spectrogramImage = QImage();
+    m_spectrumChart->setPlotAreaBackgroundVisible(false);
+    m_axisX->setRange(Constants::MIN_FREQUENCY, Constants::MAX_FREQUENCY);
+    m_axisX->setTitleText("Frequency (Hz)");
+    m_axisY->setTitleText("Amplitude");
+}
+
+void Spectrograph::showSpectrumSeries()
+{
+    hideSpectrogram();
+
+    // Back from the per-channel spectra, if they were shown
+    for (int c = 0; c < m_channelSeries.size(); ++c)
+    {
+        m_channelSeries[c]->setVisible(false);
+    }
+    m_spectrumSeries->setVisible(true);
+    m_spectrumChart->legend()->hide();
+    m_axisY->setRange(0, 1);
+}
@@ -59,6 +59,7 @@ void SpectrographUI::createLayouts()
     }
     
     m_audioOutput = new QAudioOutput(desired_audio_format, this);
+    m_device->setAudioOutput(m_audioOutput);
     m_audioOutput->start(m_device);
 
     updateChartTitle();
@@ -187,9 +188,26 @@ void SpectrographUI::showFileDialog()
 
 void SpectrographUI::showSettingsDialog()
 {
+    // The dialog shows the settings in use, whatever was left in it when it was last cancelled
+    m_settingsDialog->setLiveSpectrum(m_spectrograph->isLiveSpectrum());
+    m_settingsDialog->setDecimation(m_spectrograph->isDecimation());
+    m_settingsDialog->setStreaming(m_spectrograph->isStreaming());
+    m_settingsDialog->setTransform(static_cast<int>(m_spectrograph->transform()));
+    m_settingsDialog->setChannelView(static_cast<int>(m_spectrograph->channelView()));
+    m_settingsDialog->setMidSide(m_spectrograph->isMidSide());
+    m_settingsDialog->setMemoryBudget(static_cast<int>(m_device->memoryBudget() / (1024 * 1024)));
+
     m_settingsDialog->exec();
     if (m_settingsDialog->result() == QDialog::Accepted) 
     {
+        m_spectrograph->setLiveSpectrum(m_settingsDialog->liveSpectrum());
+        m_spectrograph->setDecimation(m_settingsDialog->decimation());
+        m_spectrograph->setStreaming(m_settingsDialog->streaming());
+        m_spectrograph->setTransform(static_cast<Spectrograph::Transform>(m_settingsDialog->transform()));
+        m_spectrograph->setChannelView(static_cast<Spectrograph::ChannelView>(m_settingsDialog->channelView()));
+        m_spectrograph->setMidSide(m_settingsDialog->midSide());
+        m_device->setMemoryBudget(qint64(m_settingsDialog->memoryBudget()) * 1024 * 1024);
+
         if (!setAudioOutputDevice(m_settingsDialog->outputDevice()))
             return;
 
@@ -221,6 +239,7 @@ bool SpectrographUI::setAudioOutputDevice(const QAudioDeviceInfo& device)
         delete m_audioOutput;
 
         m_audioOutput = new QAudioOutput(m_deviceInfo, m_device->getFormat(), this);
+        m_device->setAudioOutput(m_audioOutput);
         m_audioOutput->start(m_device);
 
         if (m_device->getState() == AudioFileStream::State::Paused)
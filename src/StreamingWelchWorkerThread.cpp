@@ -0,0 +1,203 @@
+#include "StreamingWelchWorkerThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+StreamingWelchWorkerThread::StreamingWelchWorkerThread()
+    : m_cancellationToken(nullptr)
+    , m_ring(Constants::STREAM_BUFFER_SAMPLES)
+    , m_endOfStream(false)
+    , m_stopped(false)
+    , m_appendPending(false)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+StreamingWelchWorkerThread::~StreamingWelchWorkerThread()
+{
+
+}
+
+void StreamingWelchWorkerThread::setWelchPSD(std::shared_ptr<const WelchPSD> welch)
+{
+    m_welch = welch;
+}
+
+void StreamingWelchWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+size_t StreamingWelchWorkerThread::appendSamples(const short* samples, size_t count)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopped || isCancelled())
+        return count;
+
+    const size_t written = m_ring.write(samples, count);
+    m_samplesAvailable.wakeAll();
+
+    // The worker checks the flag under the same lock after each read, so the signal cannot be missed
+    if (written < count)
+        m_appendPending = true;
+
+    return written;
+}
+
+void StreamingWelchWorkerThread::endOfStream()
+{
+    QMutexLocker locker(&m_mutex);
+    m_endOfStream = true;
+    m_samplesAvailable.wakeAll();
+}
+
+void StreamingWelchWorkerThread::wake()
+{
+    QMutexLocker locker(&m_mutex);
+    m_samplesAvailable.wakeAll();
+}
+
+void StreamingWelchWorkerThread::clearData()
+{
+    QMutexLocker locker(&m_mutex);
+    m_ring.clear();
+    m_endOfStream = false;
+    m_stopped = false;
+    m_appendPending = false;
+    m_power.clear();
+}
+
+bool StreamingWelchWorkerThread::isCancelled() const
+{
+    return isInterruptionRequested() || (m_cancellationToken != nullptr && m_cancellationToken->isCancelled());
+}
+
+size_t StreamingWelchWorkerThread::readSamples(short* samples, size_t count)
+{
+    size_t total = 0;
+    while (true)
+    {
+        const size_t read = m_ring.read(samples + total, count - total);
+        total += read;
+
+        QMutexLocker locker(&m_mutex);
+        if (read > 0 && m_appendPending)
+        {
+            m_appendPending = false;
+            emit spaceAvailable();
+        }
+
+        if (total == count)
+            break;
+
+        while (!isCancelled() && !m_endOfStream && m_ring.available() == 0)
+        {
+            m_samplesAvailable.wait(&m_mutex);
+        }
+
+        // The decoder writes everything before ending the stream, an empty ring then stays empty
+        if (isCancelled() || (m_endOfStream && m_ring.available() == 0))
+            break;
+    }
+
+    return total;
+}
+
+void StreamingWelchWorkerThread::stopReceiving()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stopped = true;
+    if (m_appendPending)
+    {
+        m_appendPending = false;
+        emit spaceAvailable();
+    }
+}
+
+void StreamingWelchWorkerThread::run()
+{
+    if (!m_welch)
+    {
+        stopReceiving();
+        return;
+    }
+
+    const size_t segmentSize = m_welch->segmentSize();
+    const size_t hopSize = m_welch->hopSize();
+    std::vector<short> segment(segmentSize);
+    std::vector<double> power(m_welch->numBins(), 0.0);
+    qint64 numSegments = 0;
+
+    const auto updateInterval = std::chrono::milliseconds(Constants::STREAM_UPDATE_INTERVAL_MS);
+    auto lastUpdate = std::chrono::steady_clock::now();
+
+    // Exception handling, should never get inside catch.
+    try {
+        // Samples of the current segment already read, the overlap with the previous one
+        size_t filled = 0;
+        while (true)
+        {
+            const size_t count = filled + readSamples(segment.data() + filled, segmentSize - filled);
+            if (isCancelled())
+                break;
+
+            // Only whole segments count, unless the stream is shorter than one segment
+            if (count < segmentSize && (count == 0 || numSegments > 0))
+                break;
+
+            if (!m_welch->accumulate(segment.data(), count, 0, 1, power))
+                break;
+            numSegments++;
+
+            // The first segment is published at once, the next ones at most once per interval
+            const auto now = std::chrono::steady_clock::now();
+            if (numSegments == 1 || now - lastUpdate >= updateInterval)
+            {
+                lastUpdate = now;
+                m_power.resize(static_cast<int>(power.size()));
+                std::copy(power.begin(), power.end(), m_power.begin());
+                emit streamingResultReady(m_power, numSegments, false);
+            }
+
+            if (count < segmentSize)
+                break;
+
+            // The next segment starts one hop later: keep the overlap, or skip the gap
+            if (hopSize < segmentSize)
+            {
+                std::copy(segment.begin() + hopSize, segment.end(), segment.begin());
+                filled = segmentSize - hopSize;
+            }
+            else
+            {
+                for (size_t gap = hopSize - segmentSize; gap > 0; )
+                {
+                    const size_t skipped = readSamples(segment.data(), std::min(gap, segmentSize));
+                    if (skipped == 0)
+                        break;
+                    gap -= skipped;
+                }
+                filled = 0;
+            }
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vector, aborting StreamingWelchWorkerThread::run()";
+        stopReceiving();
+        return;
+    }
+
+    stopReceiving();
+
+    if (isCancelled())
+    {
+        if (m_cancellationToken != nullptr)
+            m_cancellationToken->acknowledge();
+        return;
+    }
+
+    m_power.resize(static_cast<int>(power.size()));
+    std::copy(power.begin(), power.end(), m_power.begin());
+    emit streamingResultReady(m_power, numSegments, true);
+}
@@ -0,0 +1,179 @@
+#include "WavFile.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+// Format tags of the "fmt " chunk
+static const quint16 WAVE_FORMAT_PCM = 0x0001;
+static const quint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static const quint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+WavFile::WavFile()
+    : m_data(nullptr)
+    , m_size(0)
+{
+
+}
+
+WavFile::~WavFile()
+{
+    close();
+}
+
+bool WavFile::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "WavFile::open() ERROR: Failed to open " << filePath;
+        return false;
+    }
+
+    qint64 dataOffset = 0;
+    qint64 dataSize = 0;
+    if (!readHeader(dataOffset, dataSize))
+    {
+        close();
+        return false;
+    }
+
+    if (dataSize > 0)
+    {
+        m_data = m_file.map(dataOffset, dataSize);
+        if (m_data == nullptr)
+        {
+            qDebug() << "WavFile::open() ERROR: Failed to map " << filePath << ": " << m_file.errorString();
+            close();
+            return false;
+        }
+    }
+    m_size = dataSize;
+
+    return true;
+}
+
+void WavFile::close()
+{
+    if (m_data != nullptr)
+    {
+        m_file.unmap(m_data);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_format = QAudioFormat();
+
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+}
+
+QAudioFormat WavFile::format() const
+{
+    return m_format;
+}
+
+const char* WavFile::data() const
+{
+    return reinterpret_cast<const char*>(m_data);
+}
+
+qint64 WavFile::size() const
+{
+    return m_size;
+}
+
+bool WavFile::readHeader(qint64& dataOffset, qint64& dataSize)
+{
+    const QByteArray riff = m_file.read(12);
+    if (riff.size() != 12 || !riff.startsWith("RIFF") || riff.mid(8, 4) != "WAVE")
+    {
+        qDebug() << "WavFile::readHeader() Not a RIFF/WAVE file: " << m_file.fileName();
+        return false;
+    }
+
+    // Chunks are an id, a little endian size and the contents, padded to an even size
+    bool hasFormat = false;
+    qint64 position = 12;
+    while (position + 8 <= m_file.size())
+    {
+        m_file.seek(position);
+        const QByteArray header = m_file.read(8);
+        if (header.size() != 8)
+            break;
+
+        const qint64 chunkSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(header.constData() + 4));
+        const qint64 chunkStart = position + 8;
+
+        if (header.startsWith("fmt "))
+        {
+            if (!readFormat(m_file.read(qMin<qint64>(chunkSize, 64))))
+                return false;
+            hasFormat = true;
+        }
+        else if (header.startsWith("data"))
+        {
+            if (!hasFormat)
+            {
+                qDebug() << "WavFile::readHeader() ERROR: data chunk before fmt chunk in " << m_file.fileName();
+                return false;
+            }
+
+            // A truncated file (or a recorder that never patched the size) ends where the file ends
+            dataOffset = chunkStart;
+            dataSize = qMin(chunkSize, m_file.size() - chunkStart);
+            dataSize -= dataSize % m_format.bytesPerFrame();
+            return true;
+        }
+
+        position = chunkStart + chunkSize + (chunkSize & 1);
+    }
+
+    qDebug() << "WavFile::readHeader() ERROR: No data chunk in " << m_file.fileName();
+    return false;
+}
+
+bool WavFile::readFormat(const QByteArray& chunk)
+{
+    if (chunk.size() < 16)
+        return false;
+
+    const uchar* fmt = reinterpret_cast<const uchar*>(chunk.constData());
+    quint16 formatTag = qFromLittleEndian<quint16>(fmt);
+    const quint16 channels = qFromLittleEndian<quint16>(fmt + 2);
+    const quint32 sampleRate = qFromLittleEndian<quint32>(fmt + 4);
+    const quint16 bitsPerSample = qFromLittleEndian<quint16>(fmt + 14);
+
+    // The sub-format GUID of WAVE_FORMAT_EXTENSIBLE starts with the actual format tag
+    if (formatTag == WAVE_FORMAT_EXTENSIBLE)
+    {
+        if (chunk.size() < 40)
+            return false;
+        formatTag = qFromLittleEndian<quint16>(fmt + 24);
+    }
+
+    QAudioFormat::SampleType sampleType = QAudioFormat::Unknown;
+    if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 8)
+        sampleType = QAudioFormat::UnSignedInt;
+    else if (formatTag == WAVE_FORMAT_PCM && (bitsPerSample == 16 || bitsPerSample == 32))
+        sampleType = QAudioFormat::SignedInt;
+    else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32)
+        sampleType = QAudioFormat::Float;
+
+    if (sampleType == QAudioFormat::Unknown || channels == 0 || sampleRate == 0)
+    {
+        qDebug() << "WavFile::readFormat() Unsupported format " << formatTag << " with " << bitsPerSample << " bits in " << m_file.fileName();
+        return false;
+    }
+
+    m_format.setCodec("audio/pcm");
+    m_format.setByteOrder(QAudioFormat::LittleEndian);
+    m_format.setSampleType(sampleType);
+    m_format.setSampleSize(bitsPerSample);
+    m_format.setChannelCount(channels);
+    m_format.setSampleRate(static_cast<int>(sampleRate));
+
+    return true;
+}
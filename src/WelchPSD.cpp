@@ -0,0 +1,140 @@
+#include "WelchPSD.h"
+#include "FFTKernels.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+WelchPSD::WelchPSD(double sampleRate, size_t segmentSize, size_t hopSize, STFT::Window window)
+    : m_sampleRate(sampleRate)
+    , m_segmentSize(segmentSize)
+    , m_hopSize(hopSize)
+    , m_window(window)
+    , m_windowPower(0.0)
+{
+    if (sampleRate <= 0.0 || segmentSize < 2 || hopSize == 0)
+    {
+        throw std::invalid_argument("WelchPSD::WelchPSD() Invalid segment or hop size");
+    }
+
+    m_plan = FFTPlan::forSize(segmentSize);
+
+    m_windowTable = STFT::createWindow(window, segmentSize);
+    for (size_t i = 0; i < segmentSize; i++)
+    {
+        m_windowPower += m_windowTable[i] * m_windowTable[i];
+    }
+}
+
+double WelchPSD::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+size_t WelchPSD::segmentSize() const
+{
+    return m_segmentSize;
+}
+
+size_t WelchPSD::hopSize() const
+{
+    return m_hopSize;
+}
+
+STFT::Window WelchPSD::window() const
+{
+    return m_window;
+}
+
+size_t WelchPSD::numBins() const
+{
+    return m_segmentSize / 2 + 1;
+}
+
+double WelchPSD::frequency(size_t k) const
+{
+    return k * m_sampleRate / m_segmentSize;
+}
+
+size_t WelchPSD::numSegments(size_t n) const
+{
+    if (n <= m_segmentSize)
+        return n > 0 ? 1 : 0;
+
+    return 1 + (n - m_segmentSize) / m_hopSize;
+}
+
+bool WelchPSD::accumulate(const short* samples, size_t n, size_t firstSegment, size_t lastSegment,
+                          std::vector<double>& power) const
+{
+    const size_t bins = numBins();
+    if (power.size() != bins)
+    {
+        throw std::invalid_argument("WelchPSD::accumulate() Size mismatch for output vector");
+    }
+
+    // The segments are windowed into a block and transformed together. The periodograms are
+    // still added in segment order, so the sum does not depend on the block size.
+    // The streaming worker calls this for every few segments, so each thread keeps its buffers.
+    const size_t maxBatch = FFTPlan::MAX_BATCH_FRAMES;
+    const size_t blockSize = std::min(maxBatch, lastSegment - firstSegment);
+    thread_local std::vector<double> segments;
+    thread_local std::vector<double> real;
+    thread_local std::vector<double> imag;
+    thread_local std::vector<double> magnitudes;
+    if (segments.size() < blockSize * m_segmentSize)
+        segments.resize(blockSize * m_segmentSize);
+    if (real.size() < blockSize * bins)
+    {
+        real.resize(blockSize * bins);
+        imag.resize(blockSize * bins);
+    }
+    if (magnitudes.size() < bins)
+        magnitudes.resize(bins);
+
+    for (size_t blockStart = firstSegment; blockStart < lastSegment; blockStart += FFTPlan::MAX_BATCH_FRAMES)
+    {
+        const size_t blockEnd = std::min(lastSegment, blockStart + FFTPlan::MAX_BATCH_FRAMES);
+        for (size_t s = blockStart; s < blockEnd; s++)
+        {
+            const size_t start = s * m_hopSize;
+            const size_t count = start < n ? std::min(m_segmentSize, n - start) : 0;
+
+            double* segment = segments.data() + (s - blockStart) * m_segmentSize;
+            for (size_t i = 0; i < count; i++)
+            {
+                segment[i] = samples[start + i] * m_windowTable[i];
+            }
+            std::fill(segment + count, segment + m_segmentSize, 0.0);
+        }
+
+        if (!m_plan->transformRealBatch(segments.data(), blockEnd - blockStart, m_segmentSize, real.data(), imag.data(), bins))
+            return false;
+
+        for (size_t s = blockStart; s < blockEnd; s++)
+        {
+            FFTKernels::magnitude(real.data() + (s - blockStart) * bins, imag.data() + (s - blockStart) * bins, magnitudes.data(), bins);
+            for (size_t k = 0; k < bins; k++)
+            {
+                power[k] += magnitudes[k] * magnitudes[k];
+            }
+        }
+    }
+
+    return true;
+}
+
+void WelchPSD::finish(std::vector<double>& power, size_t numSegments) const
+{
+    if (numSegments == 0 || power.empty())
+        return;
+
+    // Average, then scale to full scale^2 / Hz. Every bin but DC and Nyquist also stands for
+    // its negative frequency, so it counts twice in the one-sided density.
+    const double scale = 1.0 / (32767.0 * 32767.0 * m_sampleRate * m_windowPower * numSegments);
+    FFTKernels::scale(power.data(), 2.0 * scale, power.size());
+    power.front() *= 0.5;
+    if (m_segmentSize % 2 == 0)
+    {
+        power.back() *= 0.5;
+    }
+}
@@ -0,0 +1,109 @@
+#include "WelchWorkerThread.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+WelchWorkerThread::WelchWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_cancellationToken(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+WelchWorkerThread::~WelchWorkerThread()
+{
+
+}
+
+int WelchWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void WelchWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void WelchWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void WelchWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void WelchWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void WelchWorkerThread::setWelchPSD(std::shared_ptr<const WelchPSD> welch)
+{
+    m_welch = welch;
+}
+
+void WelchWorkerThread::setCancellationToken(CancellationToken* token)
+{
+    m_cancellationToken = token;
+}
+
+void WelchWorkerThread::clearData()
+{
+    m_power.clear();
+}
+
+void WelchWorkerThread::run()
+{
+    clearData();
+
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_welch)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    // range of segments for current worker
+    const size_t numSegments = m_welch->numSegments(N);
+    const size_t segmentStart = (m_workerID * numSegments) / m_numWorkers;
+    const size_t segmentEnd = ((m_workerID + 1) * numSegments) / m_numWorkers;
+
+    std::vector<double> power(m_welch->numBins(), 0.0);
+
+    // Cancellation is only checked between batches of segments, sized to the latency budget
+    CancellationCheckpoint checkpoint(m_cancellationToken, this, 1);
+
+    // Exception handling, should never get inside catch.
+    try {
+        for (size_t first = segmentStart; first < segmentEnd; )
+        {
+            const size_t last = first + std::min(segmentEnd - first, checkpoint.blockSize());
+            if (!m_welch->accumulate(data_short, N, first, last, power) || checkpoint.reached())
+            {
+                clearData();
+                return;
+            }
+            first = last;
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vector, aborting WelchWorkerThread::run()";
+        return;
+    }
+
+    m_power.resize(static_cast<int>(power.size()));
+    std::copy(power.begin(), power.end(), m_power.begin());
+
+    emit welchResultReady(m_power, m_workerID);
+}
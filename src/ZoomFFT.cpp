@@ -0,0 +1,210 @@
+#define _USE_MATH_DEFINES
+
+#include "ZoomFFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Smallest convolution length, short bands still get reasonably long blocks
+static const size_t MIN_CONVOLUTION_SIZE = 1024;
+
+// How often the block shifts are recomputed exactly instead of rotated by one block
+static const size_t SHIFT_RESYNC_INTERVAL = 32;
+
+ZoomFFT::ZoomFFT(double sampleRate, double startFrequency, double resolution, size_t numBins)
+    : m_sampleRate(sampleRate)
+    , m_startFrequency(startFrequency)
+    , m_resolution(resolution)
+    , m_numBins(numBins)
+    , m_blockSize(0)
+{
+    if (sampleRate <= 0.0 || resolution <= 0.0 || numBins == 0)
+    {
+        throw std::invalid_argument("ZoomFFT::ZoomFFT() Invalid band");
+    }
+
+    // The convolution of a block of L samples with K outputs needs L + K - 1 points. Making it
+    // about 4 times the band keeps most of every FFT for samples.
+    const size_t m = FFTPlan::paddedSize(std::max(MIN_CONVOLUTION_SIZE, 4 * numBins));
+    m_blockSize = m - numBins + 1;
+    m_plan = FFTPlan::forSize(m);
+
+    m_chirpCos.resize(m_blockSize);
+    m_chirpSin.resize(m_blockSize);
+    for (size_t n = 0; n < m_blockSize; n++)
+    {
+        const double nn = static_cast<double>(n);
+        const double a = angle((m_startFrequency * nn + 0.5 * m_resolution * nn * nn) / m_sampleRate);
+        m_chirpCos[n] = std::cos(a);
+        m_chirpSin[n] = std::sin(a);
+    }
+
+    // Filter taps for the lags -(L - 1)..(K - 1), stored circularly
+    m_filterReal.assign(m, 0.0);
+    m_filterImag.assign(m, 0.0);
+    for (size_t lag = 0; lag < std::max(m_blockSize, m_numBins); lag++)
+    {
+        const double l = static_cast<double>(lag);
+        const double a = angle(0.5 * m_resolution * l * l / m_sampleRate);
+        if (lag < m_numBins)
+        {
+            m_filterReal[lag] = std::cos(a);
+            m_filterImag[lag] = std::sin(a);
+        }
+        if (lag > 0 && lag < m_blockSize)
+        {
+            m_filterReal[m - lag] = std::cos(a);
+            m_filterImag[m - lag] = std::sin(a);
+        }
+    }
+
+    m_outputCos.resize(m_numBins);
+    m_outputSin.resize(m_numBins);
+    m_stepCos.resize(m_numBins);
+    m_stepSin.resize(m_numBins);
+    for (size_t k = 0; k < m_numBins; k++)
+    {
+        const double kk = static_cast<double>(k);
+        const double a = angle(0.5 * m_resolution * kk * kk / m_sampleRate);
+        m_outputCos[k] = std::cos(a);
+        m_outputSin[k] = std::sin(a);
+
+        const double step = angle(frequency(k) * m_blockSize / m_sampleRate);
+        m_stepCos[k] = std::cos(step);
+        m_stepSin[k] = std::sin(step);
+    }
+
+    m_plan->transform(m_filterReal, m_filterImag);
+    for (size_t i = 0; i < m; i++)
+    {
+        m_filterReal[i] /= m;
+        m_filterImag[i] /= m;
+    }
+}
+
+double ZoomFFT::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+double ZoomFFT::startFrequency() const
+{
+    return m_startFrequency;
+}
+
+double ZoomFFT::resolution() const
+{
+    return m_resolution;
+}
+
+size_t ZoomFFT::numBins() const
+{
+    return m_numBins;
+}
+
+double ZoomFFT::frequency(size_t k) const
+{
+    return m_startFrequency + k * m_resolution;
+}
+
+size_t ZoomFFT::blockSize() const
+{
+    return m_blockSize;
+}
+
+size_t ZoomFFT::numBlocks(size_t n) const
+{
+    return (n + m_blockSize - 1) / m_blockSize;
+}
+
+void ZoomFFT::blockShift(size_t offset, std::vector<double>& shiftCos, std::vector<double>& shiftSin) const
+{
+    for (size_t k = 0; k < m_numBins; k++)
+    {
+        const double a = angle(frequency(k) * offset / m_sampleRate);
+        shiftCos[k] = std::cos(a);
+        shiftSin[k] = std::sin(a);
+    }
+}
+
+double ZoomFFT::angle(double cycles)
+{
+    return 2 * M_PI * (cycles - std::floor(cycles));
+}
+
+bool ZoomFFT::accumulate(const short* samples, size_t n, size_t firstBlock, size_t lastBlock,
+                         std::vector<double>& real, std::vector<double>& imag) const
+{
+    if (real.size() != m_numBins || imag.size() != m_numBins)
+    {
+        throw std::invalid_argument("ZoomFFT::accumulate() Size mismatch for output vectors");
+    }
+
+    const size_t m = m_plan->size();
+    std::vector<double> blockReal(m);
+    std::vector<double> blockImag(m);
+
+    std::vector<double> shiftCos(m_numBins);
+    std::vector<double> shiftSin(m_numBins);
+    blockShift(firstBlock * m_blockSize, shiftCos, shiftSin);
+
+    for (size_t block = firstBlock; block < lastBlock; block++)
+    {
+        const size_t offset = block * m_blockSize;
+        if (offset >= n)
+            break;
+        const size_t count = std::min(m_blockSize, n - offset);
+
+        // Chirp the samples (exp(-i*a) = cos(a) - i*sin(a)) and zero the rest
+        for (size_t i = 0; i < count; i++)
+        {
+            blockReal[i] = samples[offset + i] * m_chirpCos[i];
+            blockImag[i] = -samples[offset + i] * m_chirpSin[i];
+        }
+        std::fill(blockReal.begin() + count, blockReal.end(), 0.0);
+        std::fill(blockImag.begin() + count, blockImag.end(), 0.0);
+
+        if (!m_plan->transform(blockReal, blockImag))
+            return false;
+
+        // Multiply by the filter and take the inverse FFT as conj(FFT(conj(x)))
+        for (size_t i = 0; i < m; i++)
+        {
+            const double re = blockReal[i] * m_filterReal[i] - blockImag[i] * m_filterImag[i];
+            const double im = blockReal[i] * m_filterImag[i] + blockImag[i] * m_filterReal[i];
+            blockReal[i] = re;
+            blockImag[i] = -im;
+        }
+
+        if (!m_plan->transform(blockReal, blockImag))
+            return false;
+
+        // Undo the chirp on the outputs and shift the block to its position in the signal
+        for (size_t k = 0; k < m_numBins; k++)
+        {
+            // Output k of the convolution is (blockReal[k], -blockImag[k])
+            const double re = blockReal[k] * m_outputCos[k] - blockImag[k] * m_outputSin[k];
+            const double im = -blockImag[k] * m_outputCos[k] - blockReal[k] * m_outputSin[k];
+            real[k] += re * shiftCos[k] + im * shiftSin[k];
+            imag[k] += im * shiftCos[k] - re * shiftSin[k];
+        }
+
+        // Advance the shifts by one block, recomputing them exactly from time to time
+        // so rounding errors do not accumulate over long signals
+        if ((block - firstBlock + 1) % SHIFT_RESYNC_INTERVAL == 0)
+        {
+            blockShift(offset + m_blockSize, shiftCos, shiftSin);
+            continue;
+        }
+
+        for (size_t k = 0; k < m_numBins; k++)
+        {
+            const double c = shiftCos[k] * m_stepCos[k] - shiftSin[k] * m_stepSin[k];
+            shiftSin[k] = shiftSin[k] * m_stepCos[k] + shiftCos[k] * m_stepSin[k];
+            shiftCos[k] = c;
+        }
+    }
+
+    return true;
+}
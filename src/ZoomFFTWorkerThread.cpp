@@ -0,0 +1,103 @@
+#include "ZoomFFTWorkerThread.h"
+
+#include <algorithm>
+
+ZoomFFTWorkerThread::ZoomFFTWorkerThread()
+    : m_dataBuffer(nullptr)
+    , m_workerID(0)
+    , m_numWorkers(1)
+{
+    qRegisterMetaType<QVector<double>>("QVector<double>");
+}
+
+ZoomFFTWorkerThread::~ZoomFFTWorkerThread()
+{
+
+}
+
+int ZoomFFTWorkerThread::getWorkerID()
+{
+    return m_workerID;
+}
+
+void ZoomFFTWorkerThread::setAudioFormat(QAudioFormat format)
+{
+    m_format = format;
+}
+
+void ZoomFFTWorkerThread::setWorkerID(int workerID)
+{
+    m_workerID = workerID;
+}
+
+void ZoomFFTWorkerThread::setNumWorkers(int numWorkers)
+{
+    m_numWorkers = numWorkers;
+}
+
+void ZoomFFTWorkerThread::setDataBuffer(const QBuffer* dataBuffer)
+{
+    m_dataBuffer = dataBuffer;
+}
+
+void ZoomFFTWorkerThread::setZoomFFT(std::shared_ptr<const ZoomFFT> zoomFFT)
+{
+    m_zoomFFT = zoomFFT;
+}
+
+void ZoomFFTWorkerThread::clearData()
+{
+    m_real.clear();
+    m_imag.clear();
+}
+
+void ZoomFFTWorkerThread::run()
+{
+    clearData();
+
+    // Calculate number of samples
+    const ulong N = m_dataBuffer->bytesAvailable() / (m_format.sampleSize() / 8);
+
+    if (N == 0 || !m_zoomFFT)
+    {
+        return;
+    }
+
+    // Get raw data
+    const char* data = m_dataBuffer->buffer().constData();
+    short* data_short = (short*)data;
+
+    // range calculation for current worker, in whole blocks of the zoom transform
+    const size_t numBlocks = m_zoomFFT->numBlocks(N);
+    const size_t blockStart = (m_workerID * numBlocks) / m_numWorkers;
+    const size_t blockEnd = ((m_workerID + 1) * numBlocks) / m_numWorkers;
+
+    std::vector<double> real(m_zoomFFT->numBins(), 0.0);
+    std::vector<double> imag(m_zoomFFT->numBins(), 0.0);
+
+    // Exception handling, should never get inside catch.
+    try {
+        if (!m_zoomFFT->accumulate(data_short, N, blockStart, blockEnd, real, imag))
+        {
+            clearData();
+            return;
+        }
+    }
+    catch (std::invalid_argument e) {
+        qDebug() << "Invalid size of output vectors, aborting ZoomFFTWorkerThread::run()";
+        return;
+    }
+
+    if (isInterruptionRequested())
+    {
+        clearData();
+        return;
+    }
+
+    m_real.resize(static_cast<int>(real.size()));
+    m_imag.resize(static_cast<int>(imag.size()));
+    std::copy(real.begin(), real.end(), m_real.begin());
+    std::copy(imag.begin(), imag.end(), m_imag.begin());
+
+    emit zoomResultReady(m_real, m_imag, m_workerID);
+}
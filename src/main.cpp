@@ -1,9 +1,15 @@
 #include "SpectrographUI.h"
+#include "FFTPlan.h"
 #include <QtWidgets/QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // Run the FFT workers in single precision (see FFTPlan::Precision)
+    if (a.arguments().contains("--float32"))
+        FFTPlan::setPrecision(FFTPlan::Precision::Single);
+
     SpectrographUI w;
     w.show();
     return a.exec();